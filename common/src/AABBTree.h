@@ -28,9 +28,13 @@
 #include <vecmath/ray.h>
 #include <vecmath/intersection.h>
 
+#include <algorithm>
 #include <cassert>
 #include <iosfwd>
+#include <iterator>
+#include <queue>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace TrenchBroom {
@@ -114,6 +118,13 @@ namespace TrenchBroom {
              */
             virtual size_t height() const = 0;
 
+            /**
+             * Returns the number of leafs in the subtree rooted at this node.
+             *
+             * @return the number of leafs
+             */
+            virtual size_t leafCount() const = 0;
+
             /**
              * Inserts a new node into the subtree rooted at `this`.
              *
@@ -129,6 +140,15 @@ namespace TrenchBroom {
              * @param visitor the visitor to accept
              */
             virtual void accept(Visitor& visitor) const = 0;
+
+            /**
+             * Detaches all leafs of the subtree rooted at this node and appends them to the given vector. Every inner
+             * node of the subtree is deleted, except for this node, which must be deleted by the caller if it is an
+             * inner node. Afterwards, the leafs have no parent.
+             *
+             * @param leafs the vector to append the leafs to
+             */
+            virtual void releaseLeafs(std::vector<LeafNode*>& leafs) = 0;
         public:
             /**
              * Appends a textual representation of this node to the given output stream.
@@ -179,12 +199,14 @@ namespace TrenchBroom {
             Node* m_left;
             Node* m_right;
             size_t m_height;
+            size_t m_leafCount;
         public:
             InnerNode(Node* left, Node* right) :
                 Node(merge(left->bounds(), right->bounds())),
                 m_left(left),
                 m_right(right),
-                m_height(0) {
+                m_height(0),
+                m_leafCount(0) {
                 assert(m_left != nullptr);
                 assert(m_right != nullptr);
 
@@ -211,7 +233,7 @@ namespace TrenchBroom {
 
                 return this->m_parent->updateAndReturnRoot();
             }
-
+        public: // batch updates
             /**
              * One of our direct children is being swapped for a new node.
              *
@@ -229,6 +251,18 @@ namespace TrenchBroom {
 
                 return updateAndReturnRoot();
             }
+
+            /**
+             * Recomputes the bounds of this node from the bounds of its children without changing the structure of
+             * the tree. The children's bounds must be up to date.
+             *
+             * @return the bounds of this node before refitting
+             */
+            Box refit() {
+                const auto oldBounds = this->bounds();
+                updateBounds();
+                return oldBounds;
+            }
         public: // Node removal public
             /**
              * One of our direct children is being deleted. `this` will turn into a LeafNode.
@@ -264,6 +298,20 @@ namespace TrenchBroom {
                 return newTreeRoot;
             }
 
+        public:
+            /**
+             * Returns the left child of this node.
+             */
+            const Node* left() const {
+                return m_left;
+            }
+
+            /**
+             * Returns the right child of this node.
+             */
+            const Node* right() const {
+                return m_right;
+            }
         public: // Node overrides
             ~InnerNode() override {
                 delete m_left;
@@ -274,6 +322,23 @@ namespace TrenchBroom {
                 return m_height;
             }
 
+            size_t leafCount() const override {
+                return m_leafCount;
+            }
+
+            void releaseLeafs(std::vector<LeafNode*>& leafs) override {
+                for (Node* child : { m_left, m_right }) {
+                    child->releaseLeafs(leafs);
+                    if (child->height() > 1u) {
+                        // the child is an inner node without children now
+                        delete child;
+                    }
+                }
+
+                m_left = nullptr;
+                m_right = nullptr;
+            }
+
             std::pair<Node*, LeafNode*> insert(const Box& bounds, const U& data) override {
                 // Select the subtree which is increased the least by inserting a node with the given bounds.
                 // Then insert the node into that subtree and update our reference to it.
@@ -357,6 +422,7 @@ namespace TrenchBroom {
 
             void updateHeight() {
                 m_height = std::max(m_left->height(), m_right->height()) + 1;
+                m_leafCount = m_left->leafCount() + m_right->leafCount();
                 assert(m_height > 0);
             }
 
@@ -366,6 +432,7 @@ namespace TrenchBroom {
                     m_right->accept(visitor);
                 }
             }
+
         public:
             void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
                 for (size_t i = 0; i < level; ++i)
@@ -425,11 +492,24 @@ namespace TrenchBroom {
                 return m_data;
             }
 
+            /**
+             * Replaces the bounds of this leaf. The bounds of its ancestors must be refitted afterwards.
+             *
+             * @param bounds the new bounds
+             */
+            void updateBounds(const Box& bounds) {
+                this->setBounds(bounds);
+            }
+
         public: // Node overrides
             size_t height() const override {
                 return 1;
             }
 
+            size_t leafCount() const override {
+                return 1;
+            }
+
             /**
              * Returns a new inner node that has this leaf as its left child and a new leaf representing the given bounds
              * and data as its right child.
@@ -449,6 +529,11 @@ namespace TrenchBroom {
                 visitor.visit(this);
             }
 
+            void releaseLeafs(std::vector<LeafNode*>& leafs) override {
+                this->m_parent = nullptr;
+                leafs.push_back(this);
+            }
+
             void appendTo(std::ostream& str, const std::string& indent, const size_t level) const override {
                 for (size_t i = 0; i < level; ++i)
                     str << indent;
@@ -563,6 +648,170 @@ namespace TrenchBroom {
             }
             insert(newBounds, data);
         }
+
+        /**
+         * Updates the nodes with the given data with their new bounds.
+         *
+         * Instead of removing and reinserting every node, the bounds of the affected leafs are replaced and the bounds
+         * of their ancestors are refitted bottom up in one pass. Refitting keeps the structure of the tree, which is
+         * fine if the nodes moved coherently, e.g. if they were all translated by the same offset. Otherwise, the
+         * refitted bounds of some inner nodes grow too large for efficient queries. The largest subtrees whose volume
+         * grew by more than the given factor are then either rebuilt from their leafs, or their changed leafs are
+         * reinserted, depending on which is cheaper.
+         *
+         * @param objects the data of the nodes to update, a list of DataType
+         * @param getBounds a function from DataType -> Box to compute the new bounds of each node
+         * @param maxVolumeGrowth the factor by which the volume of an inner node may grow before its subtree is
+         * restructured
+         *
+         * @throws NodeTreeException if no node with some given data can be found in this tree, or if some new bounds
+         * contain NaN; the tree is not modified in this case
+         */
+        template <typename DataList, typename GetBounds>
+        void batchUpdate(const DataList& objects, GetBounds&& getBounds, const T maxVolumeGrowth = static_cast<T>(2.0)) {
+            std::vector<std::pair<LeafNode*, Box>> changedLeafs;
+            std::unordered_set<LeafNode*> uniqueLeafs;
+            for (const U& object : objects) {
+                const auto bounds = getBounds(object);
+                check(bounds);
+
+                auto it = m_leafForData.find(object);
+                if (it == m_leafForData.end()) {
+                    throw NodeTreeException("AABB node not found");
+                }
+                if (uniqueLeafs.insert(it->second).second) {
+                    changedLeafs.emplace_back(it->second, bounds);
+                }
+            }
+
+            // Collect the ancestors of the changed leafs, every ancestor only once. Since the height of a node is
+            // always greater than the heights of its children, refitting the ancestors in the order of increasing height
+            // refits every node after its children.
+            std::unordered_set<InnerNode*> visited;
+            std::vector<InnerNode*> ancestors;
+            for (const auto& [leaf, bounds] : changedLeafs) {
+                leaf->updateBounds(bounds);
+
+                auto* ancestor = leaf->m_parent;
+                while (ancestor != nullptr && visited.insert(ancestor).second) {
+                    ancestors.push_back(ancestor);
+                    ancestor = ancestor->m_parent;
+                }
+            }
+
+            std::sort(std::begin(ancestors), std::end(ancestors), [](const InnerNode* lhs, const InnerNode* rhs) {
+                return lhs->height() < rhs->height();
+            });
+
+            std::unordered_set<InnerNode*> degraded;
+            for (auto* ancestor : ancestors) {
+                const auto oldVolume = ancestor->refit().volume();
+                if (ancestor->bounds().volume() > maxVolumeGrowth * oldVolume) {
+                    degraded.insert(ancestor);
+                }
+            }
+
+            if (degraded.empty()) {
+                return;
+            }
+
+            // Find the topmost degraded ancestor of every changed leaf, if any. Their subtrees are disjoint.
+            std::unordered_map<InnerNode*, std::vector<LeafNode*>> changedLeafsPerSubtree;
+            std::vector<InnerNode*> degradedSubtrees;
+            for (const auto& changedLeaf : changedLeafs) {
+                auto* leaf = changedLeaf.first;
+                InnerNode* topmostDegraded = nullptr;
+                for (auto* ancestor = leaf->m_parent; ancestor != nullptr; ancestor = ancestor->m_parent) {
+                    if (degraded.count(ancestor) > 0u) {
+                        topmostDegraded = ancestor;
+                    }
+                }
+
+                if (topmostDegraded != nullptr) {
+                    auto& leafs = changedLeafsPerSubtree[topmostDegraded];
+                    if (leafs.empty()) {
+                        degradedSubtrees.push_back(topmostDegraded);
+                    }
+                    leafs.push_back(leaf);
+                }
+            }
+
+            for (auto* subtree : degradedSubtrees) {
+                const auto& leafs = changedLeafsPerSubtree[subtree];
+
+                // Rebuilding costs roughly as much as visiting every leaf, while reinserting costs roughly one descent
+                // per changed leaf.
+                if (subtree->leafCount() <= leafs.size() * subtree->height()) {
+                    rebuild(subtree);
+                } else {
+                    for (auto* leaf : leafs) {
+                        const auto bounds = leaf->bounds();
+                        const auto data = leaf->data();
+                        remove(data);
+                        insert(bounds, data);
+                    }
+                }
+            }
+        }
+    private:
+        /**
+         * Replaces the given subtree with a balanced subtree built from its leafs. The bounds of the subtree remain
+         * unchanged.
+         *
+         * @param subtree the root of the subtree to rebuild, will be deleted
+         */
+        void rebuild(InnerNode* subtree) {
+            std::vector<LeafNode*> leafs;
+            leafs.reserve(subtree->leafCount());
+            subtree->releaseLeafs(leafs);
+
+            Node* replacement = build(std::begin(leafs), std::end(leafs));
+            if (subtree->m_parent == nullptr) {
+                m_root = replacement;
+                m_root->m_parent = nullptr;
+            } else {
+                m_root = subtree->m_parent->replaceChild(subtree, replacement);
+            }
+
+            delete subtree;
+        }
+
+        /**
+         * Builds a subtree from the given leafs by recursively splitting them at the median of their centers along
+         * the axis where their centers are spread the most.
+         *
+         * @param begin the beginning of the range of leafs
+         * @param end the end of the range of leafs
+         * @return the root of the new subtree
+         */
+        template <typename I>
+        static Node* build(I begin, I end) {
+            assert(begin != end);
+            if (std::next(begin) == end) {
+                return *begin;
+            }
+
+            const auto firstCenter = (*begin)->bounds().center();
+            auto centerBounds = Box(firstCenter, firstCenter);
+            for (auto it = std::next(begin); it != end; ++it) {
+                centerBounds = vm::merge(centerBounds, (*it)->bounds().center());
+            }
+
+            const auto size = centerBounds.size();
+            size_t axis = 0u;
+            for (size_t i = 1u; i < S; ++i) {
+                if (size[i] > size[axis]) {
+                    axis = i;
+                }
+            }
+
+            const auto mid = std::next(begin, std::distance(begin, end) / 2);
+            std::nth_element(begin, mid, end, [&](const LeafNode* lhs, const LeafNode* rhs) {
+                return lhs->bounds().center()[axis] < rhs->bounds().center()[axis];
+            });
+
+            return new InnerNode(build(begin, mid), build(mid, end));
+        }
     private:
         void check(const Box& bounds) const {
             if (vm::is_nan(bounds.min) || vm::is_nan(bounds.max)) {
@@ -653,6 +902,51 @@ namespace TrenchBroom {
             }
         }
 
+        /**
+         * Calls the given function for every data item in this tree whose bounding box intersects with the given ray,
+         * in the order of the distances at which the ray enters the bounding boxes. The distance is 0 if a bounding box
+         * contains the ray origin. Stops as soon as the function returns false.
+         *
+         * @tparam F the function type, must be callable with a data item and its distance and return bool
+         * @param ray the ray to test
+         * @param f the function to call
+         */
+        template <typename F>
+        void findIntersectorsInOrder(const vm::ray<T,S>& ray, F&& f) const {
+            if (empty()) {
+                return;
+            }
+
+            // The bounds of a node contain the bounds of its children, so the ray cannot enter a child before its
+            // parent. Visiting the nodes in the order of their entry distances thus visits the leafs in order.
+            using Entry = std::pair<T, const Node*>;
+            const auto compare = [](const Entry& lhs, const Entry& rhs) { return lhs.first > rhs.first; };
+            std::priority_queue<Entry, std::vector<Entry>, decltype(compare)> queue(compare);
+
+            const auto enqueue = [&](const Node* node) {
+                const auto distance = node->bounds().contains(ray.origin) ? static_cast<T>(0.0) : vm::intersect_ray_bbox(ray, node->bounds());
+                if (!vm::is_nan(distance)) {
+                    queue.emplace(distance, node);
+                }
+            };
+
+            enqueue(m_root);
+            while (!queue.empty()) {
+                const auto [distance, node] = queue.top();
+                queue.pop();
+
+                if (node->height() == 1u) {
+                    if (!f(static_cast<const LeafNode*>(node)->data(), distance)) {
+                        return;
+                    }
+                } else {
+                    const auto* innerNode = static_cast<const InnerNode*>(node);
+                    enqueue(innerNode->left());
+                    enqueue(innerNode->right());
+                }
+            }
+        }
+
         /**
          * Finds every data item in this tree whose bounding box contains the given point and returns a list of those items.
          *
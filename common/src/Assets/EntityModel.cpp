@@ -19,17 +19,23 @@
 
 #include "EntityModel.h"
 
-#include "AABBTree.h"
+#include "Ensure.h"
+#include "Exceptions.h"
+#include "TriangleBVH.h"
 #include "Assets/TextureCollection.h"
 #include "Renderer/IndexRangeMap.h"
 #include "Renderer/PrimType.h"
+#include "Renderer/SharedVertexBuffer.h"
 #include "Renderer/TexturedIndexRangeMap.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
-#include <vecmath/intersection.h>
 
+#include <kdl/vector_utils.h>
+
+#include <algorithm>
+#include <mutex>
 #include <string>
 
 namespace TrenchBroom {
@@ -51,8 +57,7 @@ namespace TrenchBroom {
         EntityModelFrame(index),
         m_name(name),
         m_bounds(bounds),
-        m_pitchType(pitchType),
-        m_spacialTree(std::make_unique<SpacialTree>()) {}
+        m_pitchType(pitchType) {}
 
         EntityModelLoadedFrame::~EntityModelLoadedFrame() = default;
 
@@ -73,20 +78,22 @@ namespace TrenchBroom {
         }
 
         float EntityModelLoadedFrame::intersect(const vm::ray3f& ray) const {
-            auto closestDistance = vm::nan<float>();
-
-            const auto candidates = m_spacialTree->findIntersectors(ray);
-            for (const TriNum triNum : candidates) {
-                const vm::vec3f& p1 = m_tris[triNum * 3 + 0];
-                const vm::vec3f& p2 = m_tris[triNum * 3 + 1];
-                const vm::vec3f& p3 = m_tris[triNum * 3 + 2];
-                closestDistance = vm::safe_min(closestDistance, vm::intersect_ray_triangle(ray, p1, p2, p3));
+            const TriangleBVH* bvh = nullptr;
+            {
+                const auto lock = std::lock_guard<std::mutex>(m_bvhMutex);
+                if (m_bvh == nullptr) {
+                    m_bvh = std::make_unique<TriangleBVH>(m_tris);
+                }
+                bvh = m_bvh.get();
             }
 
-            return closestDistance;
+            // the hierarchy is not modified once it is built, so it can be traversed without holding the lock
+            return bvh->intersect(ray);
         }
 
         void EntityModelLoadedFrame::addToSpacialTree(const std::vector<EntityModelVertex>& vertices, const Renderer::PrimType primType, const size_t index, const size_t count) {
+            m_bvh.reset();
+
             switch (primType) {
                 case Renderer::PrimType::Points:
                 case Renderer::PrimType::Lines:
@@ -97,19 +104,12 @@ namespace TrenchBroom {
                     assert(count % 3 == 0);
                     m_tris.reserve(m_tris.size() + count);
                     for (size_t i = 0; i < count; i += 3) {
-                        vm::bbox3f::builder bounds;
                         const auto& p1 = Renderer::getVertexComponent<0>(vertices[index + i + 0]);
                         const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
                         const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 2]);
-                        bounds.add(p1);
-                        bounds.add(p2);
-                        bounds.add(p3);
-
-                        const size_t triIndex = m_tris.size() / 3u;
                         m_tris.push_back(p1);
                         m_tris.push_back(p2);
                         m_tris.push_back(p3);
-                        m_spacialTree->insert(bounds.bounds(), triIndex);
                     }
                     break;
                 }
@@ -120,18 +120,11 @@ namespace TrenchBroom {
 
                     const auto& p1 = Renderer::getVertexComponent<0>(vertices[index]);
                     for (size_t i = 1; i < count - 1; ++i) {
-                        vm::bbox3f::builder bounds;
                         const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i]);
                         const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
-                        bounds.add(p1);
-                        bounds.add(p2);
-                        bounds.add(p3);
-
-                        const size_t triIndex = m_tris.size() / 3u;
                         m_tris.push_back(p1);
                         m_tris.push_back(p2);
                         m_tris.push_back(p3);
-                        m_spacialTree->insert(bounds.bounds(), triIndex);
                     }
                     break;
                 }
@@ -141,15 +134,9 @@ namespace TrenchBroom {
                     assert(count > 2);
                     m_tris.reserve(m_tris.size() + (count - 2) * 3);
                     for (size_t i = 0; i < count-2; ++i) {
-                        vm::bbox3f::builder bounds;
                         const auto& p1 = Renderer::getVertexComponent<0>(vertices[index + i + 0]);
                         const auto& p2 = Renderer::getVertexComponent<0>(vertices[index + i + 1]);
                         const auto& p3 = Renderer::getVertexComponent<0>(vertices[index + i + 2]);
-                        bounds.add(p1);
-                        bounds.add(p2);
-                        bounds.add(p3);
-
-                        const size_t triIndex = m_tris.size() / 3u;
                         if (i % 2 == 0) {
                             m_tris.push_back(p1);
                             m_tris.push_back(p2);
@@ -159,7 +146,6 @@ namespace TrenchBroom {
                             m_tris.push_back(p3);
                             m_tris.push_back(p2);
                         }
-                        m_spacialTree->insert(bounds.bounds(), triIndex);
                     }
                     break;
                 }
@@ -213,6 +199,7 @@ namespace TrenchBroom {
         class EntityModelMesh {
         private:
             std::vector<EntityModelVertex> m_vertices;
+            Renderer::VertexArray m_vertexArray;
         protected:
             /**
              * Creates a new frame mesh that uses the given vertices.
@@ -227,12 +214,19 @@ namespace TrenchBroom {
             /**
              * Returns a renderer that renders this mesh with the given texture.
              *
+             * The first call moves the vertices into the given vertex buffer, and all renderers of this mesh share
+             * them.
+             *
              * @param skin the texture to use when rendering the mesh
+             * @param vertexBuffer the vertex buffer to store the vertices in
              * @return the renderer
              */
-            std::unique_ptr<Renderer::TexturedIndexRangeRenderer> buildRenderer(const Texture* skin) {
-                const auto vertexArray = Renderer::VertexArray::ref(m_vertices);
-                return doBuildRenderer(skin, vertexArray);
+            std::unique_ptr<Renderer::TexturedIndexRangeRenderer> buildRenderer(const Texture* skin, EntityModelVertexBuffer& vertexBuffer) {
+                if (!m_vertices.empty()) {
+                    m_vertexArray = vertexBuffer.insertVertices(m_vertices);
+                    kdl::vec_clear_to_zero(m_vertices);
+                }
+                return doBuildRenderer(skin, m_vertexArray);
             }
         private:
             /**
@@ -270,7 +264,8 @@ namespace TrenchBroom {
         }
         private:
             std::unique_ptr<Renderer::TexturedIndexRangeRenderer> doBuildRenderer(const Texture* skin, const Renderer::VertexArray& vertices) override {
-                const Renderer::TexturedIndexRangeMap texturedIndices(skin, m_indices);
+                // the vertices are stored in a buffer shared with other meshes, so the indices must be offset
+                const Renderer::TexturedIndexRangeMap texturedIndices(skin, m_indices.offset(vertices.baseVertex()));
                 return std::make_unique<Renderer::TexturedIndexRangeRenderer>(vertices, texturedIndices);
             }
         };
@@ -300,7 +295,7 @@ namespace TrenchBroom {
             }
         private:
             std::unique_ptr<Renderer::TexturedIndexRangeRenderer> doBuildRenderer(const Texture* /* skin */, const Renderer::VertexArray& vertices) override {
-                return std::make_unique<Renderer::TexturedIndexRangeRenderer>(vertices, m_indices);
+                return std::make_unique<Renderer::TexturedIndexRangeRenderer>(vertices, m_indices.offset(vertices.baseVertex()));
             }
         };
 
@@ -355,12 +350,12 @@ namespace TrenchBroom {
             return m_skins->textureByIndex(index);
         }
 
-        std::unique_ptr<Renderer::TexturedIndexRangeRenderer> EntityModelSurface::buildRenderer(size_t skinIndex, size_t frameIndex) {
+        std::unique_ptr<Renderer::TexturedIndexRangeRenderer> EntityModelSurface::buildRenderer(size_t skinIndex, size_t frameIndex, EntityModelVertexBuffer& vertexBuffer) {
             if (skinIndex >= skinCount() || frameIndex >= frameCount() || m_meshes[frameIndex] == nullptr) {
                 return nullptr;
             } else {
                 const auto* skin = this->skin(skinIndex);
-                return m_meshes[frameIndex]->buildRenderer(skin);
+                return m_meshes[frameIndex]->buildRenderer(skin, vertexBuffer);
             }
         }
 
@@ -371,10 +366,10 @@ namespace TrenchBroom {
         m_prepared(false),
         m_pitchType(pitchType) {}
 
-        std::unique_ptr<Renderer::TexturedRenderer> EntityModel::buildRenderer(const size_t skinIndex, const size_t frameIndex) const {
+        std::unique_ptr<Renderer::TexturedRenderer> EntityModel::buildRenderer(const size_t skinIndex, const size_t frameIndex, EntityModelVertexBuffer& vertexBuffer) const {
             std::vector<std::unique_ptr<Renderer::TexturedIndexRangeRenderer>> renderers;
             for (const auto& surface : m_surfaces) {
-                auto renderer = surface->buildRenderer(skinIndex, frameIndex);
+                auto renderer = surface->buildRenderer(skinIndex, frameIndex, vertexBuffer);
                 if (renderer != nullptr) {
                     renderers.push_back(std::move(renderer));
                 }
@@ -430,6 +425,24 @@ namespace TrenchBroom {
             return result;
         }
 
+        void EntityModel::setFrameLoader(EntityModelFrameLoader frameLoader) {
+            m_frameLoader = std::move(frameLoader);
+        }
+
+        bool EntityModel::hasFrameLoader() const {
+            return static_cast<bool>(m_frameLoader);
+        }
+
+        void EntityModel::loadFrame(const size_t frameIndex, Logger& logger) {
+            ensure(hasFrameLoader(), "model has no frame loader");
+            m_frameLoader(frameIndex, *this, logger);
+
+            // the frame loader may hold on to the model file
+            if (std::all_of(std::begin(m_frames), std::end(m_frames), [](const auto& frame) { return frame->loaded(); })) {
+                m_frameLoader = nullptr;
+            }
+        }
+
         EntityModelSurface& EntityModel::addSurface(const std::string& name) {
             m_surfaces.push_back(std::make_unique<EntityModelSurface>(name, frameCount()));
             return *m_surfaces.back();
@@ -25,12 +25,15 @@
 #include <vecmath/forward.h>
 #include <vecmath/bbox.h>
 
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
 namespace TrenchBroom {
-    template <typename T, size_t S, typename U> class AABBTree;
+    class Logger;
+    class TriangleBVH;
 
     namespace Renderer {
         enum class PrimType;
@@ -113,11 +116,11 @@ namespace TrenchBroom {
             vm::bbox3f m_bounds;
             PitchType m_pitchType;
 
-            // For hit testing
+            // For hit testing, the hierarchy is built on the first intersection test. Frames are picked on several
+            // threads at once, so building the hierarchy is guarded by a mutex.
             std::vector<vm::vec3f> m_tris;
-            using TriNum = size_t;
-            using SpacialTree = AABBTree<float, 3, TriNum>;
-            std::unique_ptr<SpacialTree> m_spacialTree;
+            mutable std::unique_ptr<TriangleBVH> m_bvh;
+            mutable std::mutex m_bvhMutex;
         public:
             /**
              * Creates a new frame with the given index, name and bounds.
@@ -137,7 +140,7 @@ namespace TrenchBroom {
             float intersect(const vm::ray3f& ray) const override;
 
             /**
-             * Adds the given primitives to the spacial tree for this frame.
+             * Adds the given primitives to the triangles used for hit testing this frame.
              *
              * @param vertices the vertices
              * @param primType the primitive type
@@ -255,9 +258,23 @@ namespace TrenchBroom {
              */
             const Texture* skin(size_t index) const;
 
-            std::unique_ptr<Renderer::TexturedIndexRangeRenderer> buildRenderer(size_t skinIndex, size_t frameIndex);
+            /**
+             * Creates a renderer for the given frame using the skin with the given index. The vertices of the frame's
+             * mesh are moved into the given vertex buffer when the first renderer for the frame is built.
+             *
+             * @param skinIndex the index of the skin to use
+             * @param frameIndex the index of the frame to render
+             * @param vertexBuffer the vertex buffer to store the vertices in
+             * @return the renderer, or null if the skin or the frame does not exist
+             */
+            std::unique_ptr<Renderer::TexturedIndexRangeRenderer> buildRenderer(size_t skinIndex, size_t frameIndex, EntityModelVertexBuffer& vertexBuffer);
         };
 
+        /**
+         * Loads the frame with the given index into the given model.
+         */
+        using EntityModelFrameLoader = std::function<void(size_t frameIndex, EntityModel& model, Logger& logger)>;
+
         /**
          * Manages all data necessary to render an entity model. Each model can have multiple frames, and
          * multiple surfaces. Each surface represents an independent mesh of primitives such as triangles, and
@@ -270,6 +287,7 @@ namespace TrenchBroom {
             std::vector<std::unique_ptr<EntityModelFrame>> m_frames;
             std::vector<std::unique_ptr<EntityModelSurface>> m_surfaces;
             PitchType m_pitchType;
+            EntityModelFrameLoader m_frameLoader;
         public:
             /**
              * Creates a new entity model with the given name.
@@ -281,11 +299,15 @@ namespace TrenchBroom {
             /**
              * Creates a renderer to render the given frame of the model using the skin with the given index.
              *
+             * The vertices are stored in the given vertex buffer, which is shared by all entity models so that they can
+             * be rendered without switching between buffers. All renderers of a model must use the same buffer.
+             *
              * @param skinIndex the index of the skin to use
              * @param frameIndex the index of the frame to render
+             * @param vertexBuffer the vertex buffer to store the vertices in
              * @return the renderer
              */
-            std::unique_ptr<Renderer::TexturedRenderer> buildRenderer(size_t skinIndex, size_t frameIndex) const;
+            std::unique_ptr<Renderer::TexturedRenderer> buildRenderer(size_t skinIndex, size_t frameIndex, EntityModelVertexBuffer& vertexBuffer) const;
 
             /**
              * Returns the bounds of the given frame of this model.
@@ -337,6 +359,30 @@ namespace TrenchBroom {
              */
             EntityModelLoadedFrame& loadFrame(size_t frameIndex, const std::string& name, const vm::bbox3f& bounds);
 
+            /**
+             * Sets the function that loads the frames of this model on demand. A frame loader can keep the model file
+             * and any data that is shared by all frames, so that loading a frame only reads that frame's data.
+             *
+             * @param frameLoader the frame loader
+             */
+            void setFrameLoader(EntityModelFrameLoader frameLoader);
+
+            /**
+             * Indicates whether this model has a frame loader.
+             *
+             * @return true if this model has a frame loader and false otherwise
+             */
+            bool hasFrameLoader() const;
+
+            /**
+             * Loads the frame with the given index using this model's frame loader. The frame loader is released once
+             * all frames of this model are loaded.
+             *
+             * @param frameIndex the index of the frame to load
+             * @param logger the logger to use
+             */
+            void loadFrame(size_t frameIndex, Logger& logger);
+
             /**
              * Adds a surface with the given name.
              *
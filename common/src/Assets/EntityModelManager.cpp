@@ -26,8 +26,14 @@
 #include "Assets/ModelDefinition.h"
 #include "IO/EntityModelLoader.h"
 #include "Model/EntityNode.h"
+#include "Renderer/SharedVertexBuffer.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 
+#include <kdl/parallel.h>
+
+#include <string>
+#include <vector>
+
 namespace TrenchBroom {
     namespace Assets {
         EntityModelManager::EntityModelManager(const int magFilter, const int minFilter, Logger& logger) :
@@ -35,7 +41,8 @@ namespace TrenchBroom {
         m_loader(nullptr),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_vertexBuffer(std::make_shared<EntityModelVertexBuffer>()) {}
 
         EntityModelManager::~EntityModelManager() {
             clear();
@@ -50,6 +57,9 @@ namespace TrenchBroom {
             m_unpreparedModels.clear();
             m_unpreparedRenderers.clear();
 
+            // the ranges of the old buffer were released together with the models
+            m_vertexBuffer = std::make_shared<EntityModelVertexBuffer>();
+
             // Remove logging because it might fail when the document is already destroyed.
         }
 
@@ -80,7 +90,7 @@ namespace TrenchBroom {
                 return nullptr;
             }
 
-            auto renderer = entityModel->buildRenderer(spec.skinIndex, spec.frameIndex);
+            auto renderer = entityModel->buildRenderer(spec.skinIndex, spec.frameIndex, *m_vertexBuffer);
             if (renderer != nullptr) {
                 const auto [pos, success] = m_renderers.insert({ spec, std::move(renderer) });
                 assert(success); unused(success);
@@ -104,12 +114,83 @@ namespace TrenchBroom {
                 return nullptr;
             } else {
                 if (!model->frame(spec.frameIndex)->loaded()) {
-                    loadFrame(spec, *model);
+                    loadFrame(spec, *model, m_logger);
                 }
                 return model->frame(spec.frameIndex);
             }
         }
 
+        void EntityModelManager::loadModels(const std::vector<ModelSpecification>& specs) const {
+            struct Task {
+                IO::Path path;
+                EntityModel* model;
+                std::unique_ptr<EntityModel> loadedModel;
+                std::vector<ModelSpecification> frameSpecs;
+                std::string error;
+                BufferingLogger logger;
+            };
+
+            // one task per model so that no model is accessed concurrently
+            auto tasks = std::vector<Task>();
+            auto taskIndices = std::map<IO::Path, size_t>();
+            for (const auto& spec : specs) {
+                if (spec.path.isEmpty() || m_modelMismatches.count(spec.path) > 0) {
+                    continue;
+                }
+
+                auto* model = static_cast<EntityModel*>(nullptr);
+                const auto modelIt = m_models.find(spec.path);
+                if (modelIt != std::end(m_models)) {
+                    model = modelIt->second.get();
+                    if (spec.frameIndex >= model->frameCount() || model->frame(spec.frameIndex)->loaded()) {
+                        continue;
+                    }
+                }
+
+                const auto [taskIt, inserted] = taskIndices.insert({ spec.path, tasks.size() });
+                if (inserted) {
+                    tasks.push_back(Task{spec.path, model, nullptr, {}, "", BufferingLogger()});
+                }
+                tasks[taskIt->second].frameSpecs.push_back(spec);
+            }
+
+            if (tasks.empty()) {
+                return;
+            }
+
+            kdl::parallel_for(tasks.size(), [&](const size_t i) {
+                auto& task = tasks[i];
+                if (task.model == nullptr) {
+                    try {
+                        task.loadedModel = loadModel(task.path, task.logger);
+                        task.model = task.loadedModel.get();
+                    } catch (const GameException& e) {
+                        task.error = e.what();
+                        return;
+                    }
+                }
+
+                for (const auto& spec : task.frameSpecs) {
+                    if (spec.frameIndex < task.model->frameCount() && !task.model->frame(spec.frameIndex)->loaded()) {
+                        loadFrame(spec, *task.model, task.logger);
+                    }
+                }
+            });
+
+            // add the models in the order of the given specifications so that the log is deterministic
+            for (auto& task : tasks) {
+                task.logger.flush(m_logger);
+                if (!task.error.empty()) {
+                    m_logger.error() << task.error;
+                    m_modelMismatches.insert(task.path);
+                } else if (task.loadedModel != nullptr) {
+                    m_unpreparedModels.push_back(task.loadedModel.get());
+                    m_models.insert({ task.path, std::move(task.loadedModel) });
+                    m_logger.debug() << "Loaded entity model " << task.path;
+                }
+            }
+        }
+
         EntityModel* EntityModelManager::model(const IO::Path& path) const {
             if (path.isEmpty()) {
                 return nullptr;
@@ -125,7 +206,7 @@ namespace TrenchBroom {
             }
 
             try {
-                const auto [pos, success] = m_models.insert({ path, loadModel(path) });
+                const auto [pos, success] = m_models.insert({ path, loadModel(path, m_logger) });
                 assert(success); unused(success);
 
                 auto* model = pos->second.get();
@@ -149,18 +230,18 @@ namespace TrenchBroom {
             }
         }
 
-        std::unique_ptr<EntityModel> EntityModelManager::loadModel(const IO::Path& path) const {
+        std::unique_ptr<EntityModel> EntityModelManager::loadModel(const IO::Path& path, Logger& logger) const {
             ensure(m_loader != nullptr, "loader is null");
-            return m_loader->initializeModel(path, m_logger);
+            return m_loader->initializeModel(path, logger);
         }
 
-        void EntityModelManager::loadFrame(const Assets::ModelSpecification& spec, Assets::EntityModel& model) const {
+        void EntityModelManager::loadFrame(const Assets::ModelSpecification& spec, Assets::EntityModel& model, Logger& logger) const {
             try {
                 ensure(m_loader != nullptr, "loader is null");
-                m_loader->loadFrame(spec.path, spec.frameIndex, model, m_logger);
+                m_loader->loadFrame(spec.path, spec.frameIndex, model, logger);
             } catch (const Exception& e) {
                 // FIXME: be specific about which exceptions to catch here
-                m_logger.error() << "Could not load entity model frame " << spec << ": " << e.what();
+                logger.error() << "Could not load entity model frame " << spec << ": " << e.what();
             }
         }
 
@@ -170,6 +251,14 @@ namespace TrenchBroom {
             prepareRenderers(vboManager);
         }
 
+        bool EntityModelManager::setupVertices() {
+            return m_vertexBuffer->setup();
+        }
+
+        void EntityModelManager::cleanupVertices() {
+            m_vertexBuffer->cleanup();
+        }
+
         void EntityModelManager::resetTextureMode() {
             if (m_resetTextureMode) {
                 for (const auto& entry : m_models) {
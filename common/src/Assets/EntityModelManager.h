@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_EntityModelManager
 #define TrenchBroom_EntityModelManager
 
+#include "Assets/EntityModel_Forward.h"
 #include "IO/Path.h"
 
 #include <kdl/vector_set.h>
@@ -71,6 +72,9 @@ namespace TrenchBroom {
             mutable RendererCache m_renderers;
             mutable RendererMismatches m_rendererMismatches;
 
+            // stores the vertices of all models
+            std::shared_ptr<EntityModelVertexBuffer> m_vertexBuffer;
+
             mutable ModelList m_unpreparedModels;
             mutable RendererList m_unpreparedRenderers;
         public:
@@ -84,13 +88,31 @@ namespace TrenchBroom {
             Renderer::TexturedRenderer* renderer(const ModelSpecification& spec) const;
 
             const EntityModelFrame* frame(const ModelSpecification& spec) const;
+
+            /**
+             * Loads the models and frames referenced by the given specifications that are not loaded yet. The models
+             * are parsed and their skins are decoded concurrently, so calling this before requesting the frames or
+             * renderers of many models one by one is much faster than loading each model on demand.
+             *
+             * Uploading the skins and building the renderers is left to prepare.
+             */
+            void loadModels(const std::vector<ModelSpecification>& specs) const;
         private:
             EntityModel* model(const IO::Path& path) const;
             EntityModel* safeGetModel(const IO::Path& path) const;
-            std::unique_ptr<EntityModel> loadModel(const IO::Path& path) const;
-            void loadFrame(const ModelSpecification& spec, EntityModel& model) const;
+            std::unique_ptr<EntityModel> loadModel(const IO::Path& path, Logger& logger) const;
+            void loadFrame(const ModelSpecification& spec, EntityModel& model, Logger& logger) const;
         public:
             void prepare(Renderer::VboManager& vboManager);
+
+            /**
+             * Binds the vertex buffer that stores the vertices of all models until cleanupVertices is called, so that
+             * the renderers of the models do not bind it whenever they are rendered.
+             *
+             * @return true if the vertex buffer was bound and false if no renderers were prepared yet
+             */
+            bool setupVertices();
+            void cleanupVertices();
         private:
             void resetTextureMode();
             void prepareModels();
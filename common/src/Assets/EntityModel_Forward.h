@@ -26,6 +26,9 @@ namespace TrenchBroom {
     namespace Renderer {
         class IndexRangeMap;
         class TexturedIndexRangeMap;
+
+        template <typename VertexSpec>
+        class SharedVertexBuffer;
     }
 
     namespace Assets {
@@ -36,6 +39,7 @@ namespace TrenchBroom {
         using EntityModelVertex = Renderer::GLVertexTypes::P3T2::Vertex;
         using EntityModelIndices = Renderer::IndexRangeMap;
         using EntityModelTexturedIndices = Renderer::TexturedIndexRangeMap;
+        using EntityModelVertexBuffer = Renderer::SharedVertexBuffer<Renderer::GLVertexTypes::P3T2>;
     }
 }
 
@@ -20,13 +20,31 @@
 #include "Texture.h"
 #include "Assets/TextureBuffer.h"
 #include "Assets/TextureCollection.h"
+#include "Assets/TextureCompression.h"
 #include "Renderer/GL.h"
 
-#include <algorithm> // for std::max
+#include <algorithm> // for std::max, std::copy_n
+#include <atomic>
 #include <cassert>
 
 namespace TrenchBroom {
     namespace Assets {
+        /**
+         * Returns the number of bytes of an image of the given size in the given format, which may be compressed.
+         */
+        static size_t imageSize(const size_t width, const size_t height, const GLenum format) {
+            return isCompressedFormat(format) ? compressedImageSize(width, height, format) : bytesPerPixelForFormat(format) * width * height;
+        }
+
+        static TextureBuffer copyImage(const TextureBuffer& buffer, const size_t width, const size_t height, const GLenum format) {
+            const auto size = imageSize(width, height, format);
+            assert(buffer.size() >= size);
+
+            auto result = TextureBuffer(size);
+            std::copy_n(buffer.data(), size, result.data());
+            return result;
+        }
+
         Texture::Texture(const std::string& name, const size_t width, const size_t height, const Color& averageColor, Buffer&& buffer, const GLenum format, const TextureType type) :
         m_name(name),
         m_width(width),
@@ -38,11 +56,19 @@ namespace TrenchBroom {
         m_type(type),
         m_culling(TextureCulling::CullDefault),
         m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA},
-        m_textureId(0) {
+        m_textureId(0),
+        m_minFilter(GL_NEAREST),
+        m_magFilter(GL_NEAREST),
+        m_uploadedMipLevels(0),
+        m_lastActivation(0),
+        m_thumbnailWidth(0),
+        m_thumbnailHeight(0),
+        m_thumbnailFormat(format) {
             assert(m_width > 0);
             assert(m_height > 0);
-            assert(buffer.size() >= m_width * m_height * bytesPerPixelForFormat(format));
+            assert(buffer.size() >= imageSize(m_width, m_height, format));
             m_buffers.push_back(std::move(buffer));
+            createThumbnail();
         }
 
         Texture::Texture(const std::string& name, const size_t width, const size_t height, const Color& averageColor, BufferList&& buffers, const GLenum format, const TextureType type) :
@@ -57,17 +83,23 @@ namespace TrenchBroom {
         m_culling(TextureCulling::CullDefault),
         m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA},
         m_textureId(0),
-        m_buffers(std::move(buffers)) {
+        m_buffers(std::move(buffers)),
+        m_minFilter(GL_NEAREST),
+        m_magFilter(GL_NEAREST),
+        m_uploadedMipLevels(0),
+        m_lastActivation(0),
+        m_thumbnailWidth(0),
+        m_thumbnailHeight(0),
+        m_thumbnailFormat(format) {
             assert(m_width > 0);
             assert(m_height > 0);
 
-            [[maybe_unused]] const auto bytesPerPixel = bytesPerPixelForFormat(format);
-
             for (size_t level = 0; level < m_buffers.size(); ++level) {
                 [[maybe_unused]] const auto mipSize = sizeAtMipLevel(m_width, m_height, level);
-                [[maybe_unused]] const auto numBytes = bytesPerPixel * mipSize.x() * mipSize.y();
-                assert(m_buffers[level].size() >= numBytes);
+                assert(m_buffers[level].size() >= imageSize(mipSize.x(), mipSize.y(), format));
             }
+
+            createThumbnail();
         }
 
         Texture::Texture(const std::string& name, const size_t width, const size_t height, const GLenum format, const TextureType type) :
@@ -81,7 +113,14 @@ namespace TrenchBroom {
         m_type(type),
         m_culling(TextureCulling::CullDefault),
         m_blendFunc{TextureBlendFunc::Enable::UseDefault, GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA},
-        m_textureId(0) {}
+        m_textureId(0),
+        m_minFilter(GL_NEAREST),
+        m_magFilter(GL_NEAREST),
+        m_uploadedMipLevels(0),
+        m_lastActivation(0),
+        m_thumbnailWidth(0),
+        m_thumbnailHeight(0),
+        m_thumbnailFormat(format) {}
 
         Texture::~Texture() = default;
 
@@ -149,6 +188,10 @@ namespace TrenchBroom {
             m_culling = culling;
         }
 
+        const TextureBlendFunc& Texture::blendFunc() const {
+            return m_blendFunc;
+        }
+
         void Texture::setBlendFunc(GLenum srcFactor, GLenum destFactor) {
             m_blendFunc.enable = TextureBlendFunc::Enable::UseFactors;
             m_blendFunc.srcFactor = srcFactor;
@@ -163,13 +206,24 @@ namespace TrenchBroom {
             return m_usageCount;
         }
 
+        // usage counts may change while brushes are created concurrently
+        static std::atomic<size_t> usageChanges(0);
+
         void Texture::incUsageCount() {
-            ++m_usageCount;
+            if (m_usageCount++ == 0) {
+                ++usageChanges;
+            }
         }
 
         void Texture::decUsageCount() {
             assert(m_usageCount > 0);
-            --m_usageCount;
+            if (--m_usageCount == 0) {
+                ++usageChanges;
+            }
+        }
+
+        size_t Texture::usageChangeCount() {
+            return usageChanges;
         }
 
         bool Texture::overridden() const {
@@ -180,15 +234,72 @@ namespace TrenchBroom {
             m_overridden = overridden;
         }
 
+        static size_t activations = 0;
+
         bool Texture::isPrepared() const {
-            return m_textureId != 0;
+            return m_uploadedMipLevels > 0;
         }
 
         void Texture::prepare(const GLuint textureId, const int minFilter, const int magFilter) {
             assert(textureId > 0);
             assert(m_textureId == 0);
 
-            if (!m_buffers.empty()) {
+            m_textureId = textureId;
+            m_minFilter = minFilter;
+            m_magFilter = magFilter;
+            upload();
+        }
+
+        void Texture::createThumbnail() {
+            if (m_buffers.empty()) {
+                return;
+            }
+
+            const auto fits = [](const vm::vec2s& size) { return std::max(size.x(), size.y()) <= ThumbnailSize; };
+
+            // the largest mip level that fits, or the smallest one if none fits
+            size_t level = 0u;
+            while (level + 1u < m_buffers.size() && !fits(sizeAtMipLevel(m_width, m_height, level))) {
+                ++level;
+            }
+
+            const auto levelSize = sizeAtMipLevel(m_width, m_height, level);
+            auto format = m_format;
+            auto buffers = TextureBufferList();
+            buffers.push_back(copyImage(m_buffers[level], levelSize.x(), levelSize.y(), format));
+
+            if (!fits(levelSize)) {
+                // if the level still doesn't fit, we scale it down further, which requires uncompressed pixels
+                if (isCompressedFormat(format)) {
+                    format = decompressTextureBuffers(buffers, levelSize.x(), levelSize.y(), format);
+                }
+
+                size_t extraLevels = 1u;
+                while (!fits(sizeAtMipLevel(levelSize.x(), levelSize.y(), extraLevels))) {
+                    ++extraLevels;
+                }
+
+                auto image = std::move(buffers.front());
+                setMipBufferSize(buffers, extraLevels + 1u, levelSize.x(), levelSize.y(), format);
+                buffers.front() = std::move(image);
+                generateMipLevels(buffers, levelSize.x(), levelSize.y(), format);
+            }
+
+            const auto size = sizeAtMipLevel(levelSize.x(), levelSize.y(), buffers.size() - 1u);
+            m_thumbnail = std::move(buffers.back());
+            m_thumbnailWidth = size.x();
+            m_thumbnailHeight = size.y();
+            m_thumbnailFormat = format;
+        }
+
+        void Texture::upload() {
+            if (m_textureId != 0 && !m_buffers.empty()) {
+                if (isCompressedFormat(m_format) && !isTextureCompressionSupported()) {
+                    // the readers compress without knowing the driver, which may not support the compressed formats
+                    m_format = decompressTextureBuffers(m_buffers, m_width, m_height, m_format);
+                }
+                const auto compressed = isCompressedFormat(m_format);
+
                 glAssert(glPixelStorei(GL_UNPACK_SWAP_BYTES, false));
                 glAssert(glPixelStorei(GL_UNPACK_LSB_FIRST, false));
                 glAssert(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
@@ -196,9 +307,9 @@ namespace TrenchBroom {
                 glAssert(glPixelStorei(GL_UNPACK_SKIP_ROWS, 0));
                 glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
 
-                glAssert(glBindTexture(GL_TEXTURE_2D, textureId));
-                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter));
-                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magFilter));
+                glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
+                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, m_minFilter));
+                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, m_magFilter));
                 glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT));
                 glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT));
 
@@ -221,18 +332,29 @@ namespace TrenchBroom {
                     const auto mipSize = sizeAtMipLevel(m_width, m_height, j);
 
                     const GLvoid* data = reinterpret_cast<const GLvoid*>(m_buffers[j].data());
-                    glAssert(glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(j), GL_RGBA,
-                                          static_cast<GLsizei>(mipSize.x()),
-                                          static_cast<GLsizei>(mipSize.y()),
-                                          0, m_format, GL_UNSIGNED_BYTE, data));
+                    if (compressed) {
+                        glAssert(glCompressedTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(j), m_format,
+                                                        static_cast<GLsizei>(mipSize.x()),
+                                                        static_cast<GLsizei>(mipSize.y()),
+                                                        0, static_cast<GLsizei>(m_buffers[j].size()), data));
+                    } else {
+                        glAssert(glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(j), GL_RGBA,
+                                              static_cast<GLsizei>(mipSize.x()),
+                                              static_cast<GLsizei>(mipSize.y()),
+                                              0, m_format, GL_UNSIGNED_BYTE, data));
+                    }
                 }
 
+                glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+
                 m_buffers.clear();
-                m_textureId = textureId;
+                m_uploadedMipLevels = mipmapsToUpload;
             }
         }
 
         void Texture::setMode(const int minFilter, const int magFilter) {
+            m_minFilter = minFilter;
+            m_magFilter = magFilter;
             if (isPrepared()) {
                 activate();
                 if (m_type == TextureType::Masked) {
@@ -247,8 +369,135 @@ namespace TrenchBroom {
             }
         }
 
+        void Texture::setDecoder(TextureDecoder decoder) {
+            m_decoder = std::move(decoder);
+        }
+
+        bool Texture::deferred() const {
+            return static_cast<bool>(m_decoder);
+        }
+
+        bool Texture::needsLoading() const {
+            return deferred() && !isPrepared() && m_buffers.empty();
+        }
+
+        Texture Texture::decode(Logger& logger) const {
+            assert(deferred());
+            return m_decoder(logger);
+        }
+
+        void Texture::load(Texture decoded) {
+            if (decoded.m_buffers.empty() || decoded.m_width != m_width || decoded.m_height != m_height) {
+                // don't try again, the result would be the same
+                m_decoder = nullptr;
+                return;
+            }
+
+            m_buffers = std::move(decoded.m_buffers);
+            m_averageColor = decoded.m_averageColor;
+            m_format = decoded.m_format;
+            m_type = decoded.m_type;
+
+            // the thumbnail was created when the pixel data was decoded
+            m_thumbnail = std::move(decoded.m_thumbnail);
+            m_thumbnailWidth = decoded.m_thumbnailWidth;
+            m_thumbnailHeight = decoded.m_thumbnailHeight;
+            m_thumbnailFormat = decoded.m_thumbnailFormat;
+            upload();
+        }
+
+        void Texture::evict() {
+            if (deferred() && isPrepared()) {
+                // The texture name is owned by the collection, so we release the storage by redefining every level
+                // with an empty image instead of deleting the texture.
+                const auto mipLevels = mipLevelCount();
+
+                glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
+                glAssert(glTexParameteri(GL_TEXTURE_2D, GL_GENERATE_MIPMAP, GL_FALSE));
+                for (size_t j = 0; j < mipLevels; ++j) {
+                    // m_format may be a compressed format, which is not a valid pixel format here
+                    glAssert(glTexImage2D(GL_TEXTURE_2D, static_cast<GLint>(j), GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+                }
+                glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+
+                m_uploadedMipLevels = 0;
+            }
+        }
+
+        size_t Texture::uploadedSize() const {
+            // uncompressed textures are always uploaded as GL_RGBA
+            static const size_t BytesPerPixel = 4u;
+
+            const auto compressed = isCompressedFormat(m_format);
+
+            size_t result = 0;
+            for (size_t j = 0; j < m_uploadedMipLevels; ++j) {
+                const auto mipSize = sizeAtMipLevel(m_width, m_height, j);
+                result += compressed ? compressedImageSize(mipSize.x(), mipSize.y(), m_format) : BytesPerPixel * mipSize.x() * mipSize.y();
+            }
+
+            const auto generatedMipmaps = m_uploadedMipLevels == 1u && m_type != TextureType::Masked;
+            if (generatedMipmaps) {
+                // the full mipmap chain takes about a third more memory than the base level
+                result += result / 3u;
+            }
+            return result;
+        }
+
+        size_t Texture::mipLevelCount() const {
+            const auto generatedMipmaps = m_uploadedMipLevels == 1u && m_type != TextureType::Masked;
+            return generatedMipmaps ? fullMipLevelCount(m_width, m_height) : m_uploadedMipLevels;
+        }
+
+        bool Texture::hasThumbnail() const {
+            return m_thumbnailWidth > 0u;
+        }
+
+        size_t Texture::thumbnailWidth() const {
+            return m_thumbnailWidth;
+        }
+
+        size_t Texture::thumbnailHeight() const {
+            return m_thumbnailHeight;
+        }
+
+        TextureBuffer Texture::readThumbnail() const {
+            assert(hasThumbnail());
+
+            if (isCompressedFormat(m_thumbnailFormat)) {
+                auto buffers = TextureBufferList();
+                buffers.push_back(copyImage(m_thumbnail, m_thumbnailWidth, m_thumbnailHeight, m_thumbnailFormat));
+                decompressTextureBuffers(buffers, m_thumbnailWidth, m_thumbnailHeight, m_thumbnailFormat);
+                return std::move(buffers.front());
+            }
+
+            const auto bytesPerPixel = bytesPerPixelForFormat(m_thumbnailFormat);
+            const auto swapRedAndBlue = m_thumbnailFormat == GL_BGR || m_thumbnailFormat == GL_BGRA;
+            const auto pixelCount = m_thumbnailWidth * m_thumbnailHeight;
+
+            auto result = TextureBuffer(4u * pixelCount);
+            for (size_t i = 0u; i < pixelCount; ++i) {
+                const auto* in = m_thumbnail.data() + i * bytesPerPixel;
+                      auto* out = result.data() + i * 4u;
+                out[0] = swapRedAndBlue ? in[2] : in[0];
+                out[1] = in[1];
+                out[2] = swapRedAndBlue ? in[0] : in[2];
+                out[3] = bytesPerPixel == 4u ? in[3] : 0xFF;
+            }
+            return result;
+        }
+
+        size_t Texture::lastActivation() const {
+            return m_lastActivation;
+        }
+
+        size_t Texture::activationCount() {
+            return activations;
+        }
+
         void Texture::activate() const {
             if (isPrepared()) {
+                m_lastActivation = ++activations;
                 glAssert(glBindTexture(GL_TEXTURE_2D, m_textureId));
 
                 switch (m_culling) {
@@ -27,14 +27,23 @@
 
 #include <vecmath/forward.h>
 
+#include <functional>
 #include <set>
 #include <string>
 #include <vector>
 
 namespace TrenchBroom {
+    class Logger;
+
     namespace Assets {
+        class Texture;
         class TextureCollection;
 
+        /**
+         * Decodes the pixel data of a texture that was loaded without it. Must be safe to call concurrently.
+         */
+        using TextureDecoder = std::function<Texture(Logger& logger)>;
+
         enum class TextureType {
             Opaque,
             /**
@@ -73,6 +82,11 @@ namespace TrenchBroom {
         };
 
         class Texture {
+        public:
+            /**
+             * The maximum width and height of the thumbnails of textures.
+             */
+            static constexpr size_t ThumbnailSize = 256;
         private:
             using Buffer = TextureBuffer;
             using BufferList = std::vector<Buffer>;
@@ -102,6 +116,19 @@ namespace TrenchBroom {
 
             mutable GLuint m_textureId;
             mutable BufferList m_buffers;
+
+            int m_minFilter;
+            int m_magFilter;
+            size_t m_uploadedMipLevels;
+
+            TextureDecoder m_decoder;
+            mutable size_t m_lastActivation;
+
+            // a scaled down copy of the pixel data that is kept after it was uploaded, in m_thumbnailFormat
+            Buffer m_thumbnail;
+            size_t m_thumbnailWidth;
+            size_t m_thumbnailHeight;
+            GLenum m_thumbnailFormat;
         public:
             Texture(const std::string& name, size_t width, size_t height, const Color& averageColor, Buffer&& buffer, GLenum format, TextureType type);
             Texture(const std::string& name, size_t width, size_t height, const Color& averageColor, BufferList&& buffers, GLenum format, TextureType type);
@@ -148,12 +175,19 @@ namespace TrenchBroom {
             TextureCulling culling() const;
             void setCulling(TextureCulling culling);
 
+            const TextureBlendFunc& blendFunc() const;
             void setBlendFunc(GLenum srcFactor, GLenum destFactor);
             void disableBlend();
 
             size_t usageCount() const;
             void incUsageCount();
             void decUsageCount();
+
+            /**
+             * Returns the number of times that the usage count of any texture became zero or stopped being zero so far.
+             */
+            static size_t usageChangeCount();
+
             bool overridden() const;
             void setOverridden(bool overridden);
 
@@ -161,8 +195,83 @@ namespace TrenchBroom {
             void prepare(GLuint textureId, int minFilter, int magFilter);
             void setMode(int minFilter, int magFilter);
 
+            /**
+             * Sets the function that decodes the pixel data of this texture. A texture with a decoder is only
+             * uploaded once its pixel data is passed to load(), and it can be evicted again later.
+             */
+            void setDecoder(TextureDecoder decoder);
+
+            /**
+             * Indicates whether the pixel data of this texture is decoded on demand.
+             */
+            bool deferred() const;
+
+            /**
+             * Indicates whether this texture is deferred and its pixel data is currently not uploaded.
+             */
+            bool needsLoading() const;
+
+            /**
+             * Decodes the pixel data of this deferred texture and returns it as a new texture. Does not modify this
+             * texture, so different textures can be decoded concurrently.
+             */
+            Texture decode(Logger& logger) const;
+
+            /**
+             * Takes the pixel data and the average color from the given decoded texture and uploads the pixel data if
+             * this texture is prepared. If the decoded texture has no pixel data or its size differs from this
+             * texture's size, this texture stops being deferred and remains without pixel data.
+             */
+            void load(Texture decoded);
+
+            /**
+             * Releases the GPU memory held by this deferred texture. Its pixel data must be loaded again before it is
+             * rendered.
+             */
+            void evict();
+
+            /**
+             * Returns the approximate number of bytes of GPU memory held by this texture.
+             */
+            size_t uploadedSize() const;
+
+            /**
+             * Returns the number of mip levels of this texture that are available on the GPU, including those
+             * generated by the driver, or 0 if this texture is not uploaded.
+             */
+            size_t mipLevelCount() const;
+
+            /**
+             * Indicates whether this texture has a thumbnail. Textures that are created with pixel data keep a copy
+             * of their largest mip level whose width and height do not exceed ThumbnailSize, so that the thumbnail
+             * remains available after the pixel data was uploaded or evicted.
+             */
+            bool hasThumbnail() const;
+            size_t thumbnailWidth() const;
+            size_t thumbnailHeight() const;
+
+            /**
+             * Returns the pixels of the thumbnail of this texture in GL_RGBA format. This texture must have a
+             * thumbnail.
+             */
+            TextureBuffer readThumbnail() const;
+
+            /**
+             * Returns the value of activationCount() after the most recent activation of this texture, or 0 if it was
+             * never activated.
+             */
+            size_t lastActivation() const;
+
+            /**
+             * Returns the number of texture activations so far.
+             */
+            static size_t activationCount();
+
             void activate() const;
             void deactivate() const;
+        private:
+            void createThumbnail();
+            void upload();
         public: // exposed for tests only
             /**
              * Returns the texture data in the format returned by format().
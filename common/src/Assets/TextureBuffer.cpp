@@ -25,7 +25,7 @@
 
 #include <FreeImage.h>
 
-#include <algorithm> // for std::max
+#include <algorithm> // for std::max, std::min
 
 namespace TrenchBroom {
     namespace Assets {
@@ -59,6 +59,16 @@ namespace TrenchBroom {
                              std::max(size_t(1), height >> level));
         }
 
+        size_t fullMipLevelCount(size_t width, size_t height) {
+            size_t result = 1;
+            while (width > 1 || height > 1) {
+                width = std::max(width / 2, size_t(1));
+                height = std::max(height / 2, size_t(1));
+                ++result;
+            }
+            return result;
+        }
+
         size_t bytesPerPixelForFormat(const GLenum format) {
             switch (format) {
                 case GL_RGB:
@@ -83,6 +93,37 @@ namespace TrenchBroom {
             }
         }
 
+        void generateMipLevels(TextureBufferList& buffers, const size_t width, const size_t height, const GLenum format) {
+            const auto bytesPerPixel = bytesPerPixelForFormat(format);
+
+            for (size_t level = 1u; level < buffers.size(); ++level) {
+                const auto sourceSize = sizeAtMipLevel(width, height, level - 1u);
+                const auto targetSize = sizeAtMipLevel(width, height, level);
+                const auto sourcePitch = sourceSize.x() * bytesPerPixel;
+                const auto targetPitch = targetSize.x() * bytesPerPixel;
+
+                const auto* source = buffers[level - 1u].data();
+                      auto* target = buffers[level].data();
+
+                // If a dimension of the source level is 1, the same row or column is sampled twice.
+                for (size_t y = 0u; y < targetSize.y(); ++y) {
+                    const auto* row0 = source + std::min(2u * y,      sourceSize.y() - 1u) * sourcePitch;
+                    const auto* row1 = source + std::min(2u * y + 1u, sourceSize.y() - 1u) * sourcePitch;
+                          auto* out  = target + y * targetPitch;
+
+                    for (size_t x = 0u; x < targetSize.x(); ++x) {
+                        const auto x0 = std::min(2u * x,      sourceSize.x() - 1u) * bytesPerPixel;
+                        const auto x1 = std::min(2u * x + 1u, sourceSize.x() - 1u) * bytesPerPixel;
+
+                        for (size_t c = 0u; c < bytesPerPixel; ++c) {
+                            const auto sum = static_cast<unsigned int>(row0[x0 + c]) + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                            out[x * bytesPerPixel + c] = static_cast<unsigned char>((sum + 2u) / 4u);
+                        }
+                    }
+                }
+            }
+        }
+
         void resizeMips(TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize) {
             if (oldSize == newSize)
                 return;
@@ -45,9 +45,16 @@ namespace TrenchBroom {
         using TextureBufferList = std::vector<TextureBuffer>;
 
         vm::vec2s sizeAtMipLevel(size_t width, size_t height, size_t level);
+        size_t fullMipLevelCount(size_t width, size_t height);
         size_t bytesPerPixelForFormat(GLenum format);
         void setMipBufferSize(TextureBufferList& buffers, size_t mipLevels, size_t width, size_t height, GLenum format);
 
+        /**
+         * Computes every mip level after the first from the level above it using a 2x2 box filter. The buffers must
+         * have been sized using setMipBufferSize, and the first buffer must contain the image data.
+         */
+        void generateMipLevels(TextureBufferList& buffers, size_t width, size_t height, GLenum format);
+
         void resizeMips(TextureBufferList& buffers, const vm::vec2s& oldSize, const vm::vec2s& newSize);
     }
 }
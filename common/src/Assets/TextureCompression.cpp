@@ -0,0 +1,390 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureCompression.h"
+
+#include "Ensure.h"
+
+#include <vecmath/vec.h>
+
+#include <algorithm> // for std::min, std::max, std::swap
+#include <array>
+#include <cstdint>
+#include <cmath> // for std::abs
+#include <limits>
+
+namespace TrenchBroom {
+    namespace Assets {
+        // The 16 pixels of a 4x4 block in RGBA order
+        using PixelBlock = std::array<std::array<int, 4>, 16>;
+
+        bool isCompressedFormat(const GLenum format) {
+            return format == GL_COMPRESSED_RGB_S3TC_DXT1_EXT || format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+        }
+
+        bool isTextureCompressionSupported() {
+            return GLEW_EXT_texture_compression_s3tc;
+        }
+
+        static size_t bytesPerBlock(const GLenum format) {
+            switch (format) {
+                case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+                    return 8u;
+                case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                    return 16u;
+            }
+            ensure(false, "unknown compressed format");
+            return 0u;
+        }
+
+        size_t compressedImageSize(const size_t width, const size_t height, const GLenum format) {
+            return ((width + 3u) / 4u) * ((height + 3u) / 4u) * bytesPerBlock(format);
+        }
+
+        /**
+         * Reads the block at the given block coordinates. Pixels outside of the image are replaced by the nearest
+         * pixel inside of it.
+         */
+        static void readBlock(const unsigned char* image, const size_t width, const size_t height, const size_t blockX, const size_t blockY, const size_t redIndex, const size_t blueIndex, PixelBlock& block) {
+            for (size_t y = 0u; y < 4u; ++y) {
+                const auto imageY = std::min(blockY * 4u + y, height - 1u);
+                for (size_t x = 0u; x < 4u; ++x) {
+                    const auto imageX = std::min(blockX * 4u + x, width - 1u);
+                    const auto* pixel = image + (imageY * width + imageX) * 4u;
+                    block[y * 4u + x] = { pixel[redIndex], pixel[1], pixel[blueIndex], pixel[3] };
+                }
+            }
+        }
+
+        static uint16_t toRGB565(const int r, const int g, const int b) {
+            return static_cast<uint16_t>(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+        }
+
+        static std::array<int, 3> fromRGB565(const uint16_t color) {
+            const auto r = (color >> 11) & 0x1F;
+            const auto g = (color >> 5) & 0x3F;
+            const auto b = color & 0x1F;
+            return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+        }
+
+        static void writeLittleEndian(unsigned char* out, uint64_t value, const size_t byteCount) {
+            for (size_t i = 0u; i < byteCount; ++i) {
+                out[i] = static_cast<unsigned char>(value & 0xFF);
+                value >>= 8;
+            }
+        }
+
+        static uint64_t readLittleEndian(const unsigned char* in, const size_t byteCount) {
+            uint64_t value = 0u;
+            for (size_t i = byteCount; i > 0u; --i) {
+                value = (value << 8) | in[i - 1u];
+            }
+            return value;
+        }
+
+        /**
+         * Writes the given block to the block coordinates. Pixels outside of the image are skipped.
+         */
+        static void writeBlock(unsigned char* image, const size_t width, const size_t height, const size_t blockX, const size_t blockY, const PixelBlock& block) {
+            for (size_t y = 0u; y < 4u && blockY * 4u + y < height; ++y) {
+                for (size_t x = 0u; x < 4u && blockX * 4u + x < width; ++x) {
+                    auto* pixel = image + ((blockY * 4u + y) * width + blockX * 4u + x) * 4u;
+                    for (size_t c = 0u; c < 4u; ++c) {
+                        pixel[c] = static_cast<unsigned char>(block[y * 4u + x][c]);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Decodes a BC1 block of 8 bytes. BC1 blocks whose first color is not greater than the second use the three
+         * color mode with transparent black, while the color blocks of BC3 always use four colors.
+         */
+        static void decodeColorBlock(const unsigned char* in, const bool alwaysFourColors, PixelBlock& block) {
+            const auto color0 = static_cast<uint16_t>(readLittleEndian(in, 2u));
+            const auto color1 = static_cast<uint16_t>(readLittleEndian(in + 2, 2u));
+            const auto indices = readLittleEndian(in + 4, 4u);
+            const auto fourColors = alwaysFourColors || color0 > color1;
+
+            const auto c0 = fromRGB565(color0);
+            const auto c1 = fromRGB565(color1);
+
+            std::array<std::array<int, 4>, 4> palette;
+            for (size_t c = 0u; c < 3u; ++c) {
+                palette[0][c] = c0[c];
+                palette[1][c] = c1[c];
+                palette[2][c] = fourColors ? (2 * c0[c] + c1[c]) / 3 : (c0[c] + c1[c]) / 2;
+                palette[3][c] = fourColors ? (c0[c] + 2 * c1[c]) / 3 : 0;
+            }
+            palette[0][3] = palette[1][3] = palette[2][3] = 255;
+            palette[3][3] = fourColors ? 255 : 0;
+
+            for (size_t i = 0u; i < block.size(); ++i) {
+                block[i] = palette[(indices >> (2u * i)) & 0x3];
+            }
+        }
+
+        /**
+         * Decodes a BC3 alpha block of 8 bytes into the alpha channel of the given block.
+         */
+        static void decodeAlphaBlock(const unsigned char* in, PixelBlock& block) {
+            const auto alpha0 = static_cast<int>(in[0]);
+            const auto alpha1 = static_cast<int>(in[1]);
+            const auto indices = readLittleEndian(in + 2, 6u);
+
+            std::array<int, 8> palette;
+            palette[0] = alpha0;
+            palette[1] = alpha1;
+            if (alpha0 > alpha1) {
+                for (int i = 1; i < 7; ++i) {
+                    palette[static_cast<size_t>(i + 1)] = ((7 - i) * alpha0 + i * alpha1) / 7;
+                }
+            } else {
+                for (int i = 1; i < 5; ++i) {
+                    palette[static_cast<size_t>(i + 1)] = ((5 - i) * alpha0 + i * alpha1) / 5;
+                }
+                palette[6] = 0;
+                palette[7] = 255;
+            }
+
+            for (size_t i = 0u; i < block.size(); ++i) {
+                block[i][3] = palette[(indices >> (3u * i)) & 0x7];
+            }
+        }
+
+        /**
+         * Encodes the color channels of the given block as a BC1 block of 8 bytes. The end points are the colors with
+         * the smallest and largest projections onto the principal axis of the block's colors.
+         */
+        static void encodeColorBlock(const PixelBlock& block, unsigned char* out) {
+            std::array<float, 3> mean = { 0.0f, 0.0f, 0.0f };
+            for (const auto& pixel : block) {
+                for (size_t c = 0u; c < 3u; ++c) {
+                    mean[c] += static_cast<float>(pixel[c]);
+                }
+            }
+            for (size_t c = 0u; c < 3u; ++c) {
+                mean[c] /= static_cast<float>(block.size());
+            }
+
+            std::array<std::array<float, 3>, 3> covariance = {};
+            for (const auto& pixel : block) {
+                for (size_t i = 0u; i < 3u; ++i) {
+                    for (size_t j = 0u; j < 3u; ++j) {
+                        covariance[i][j] += (static_cast<float>(pixel[i]) - mean[i]) * (static_cast<float>(pixel[j]) - mean[j]);
+                    }
+                }
+            }
+
+            // Starting with the column of the channel with the largest variance, a few power iterations yield a good
+            // enough approximation of the principal axis.
+            size_t maxVarianceChannel = 0u;
+            for (size_t c = 1u; c < 3u; ++c) {
+                if (covariance[c][c] > covariance[maxVarianceChannel][maxVarianceChannel]) {
+                    maxVarianceChannel = c;
+                }
+            }
+
+            auto axis = covariance[maxVarianceChannel];
+            for (size_t iteration = 0u; iteration < 4u; ++iteration) {
+                std::array<float, 3> next = { 0.0f, 0.0f, 0.0f };
+                for (size_t i = 0u; i < 3u; ++i) {
+                    for (size_t j = 0u; j < 3u; ++j) {
+                        next[i] += covariance[i][j] * axis[j];
+                    }
+                }
+
+                const auto length = std::max({ std::abs(next[0]), std::abs(next[1]), std::abs(next[2]) });
+                if (length == 0.0f) {
+                    // all colors are equal, so any end points will do
+                    break;
+                }
+                for (size_t c = 0u; c < 3u; ++c) {
+                    axis[c] = next[c] / length;
+                }
+            }
+
+            size_t minPixel = 0u;
+            size_t maxPixel = 0u;
+            auto minProjection = std::numeric_limits<float>::max();
+            auto maxProjection = std::numeric_limits<float>::lowest();
+            for (size_t i = 0u; i < block.size(); ++i) {
+                const auto projection = static_cast<float>(block[i][0]) * axis[0] + static_cast<float>(block[i][1]) * axis[1] + static_cast<float>(block[i][2]) * axis[2];
+                if (projection < minProjection) {
+                    minProjection = projection;
+                    minPixel = i;
+                }
+                if (projection > maxProjection) {
+                    maxProjection = projection;
+                    maxPixel = i;
+                }
+            }
+
+            const auto& min = block[minPixel];
+            const auto& max = block[maxPixel];
+
+            auto color0 = toRGB565(max[0], max[1], max[2]);
+            auto color1 = toRGB565(min[0], min[1], min[2]);
+            if (color0 < color1) {
+                std::swap(color0, color1);
+            }
+
+            // If both colors are equal, the block uses the three color mode in which index 0 also selects color0, so
+            // the indices can remain 0.
+            uint32_t indices = 0u;
+            if (color0 != color1) {
+                const auto c0 = fromRGB565(color0);
+                const auto c1 = fromRGB565(color1);
+
+                std::array<std::array<int, 3>, 4> palette;
+                for (size_t c = 0u; c < 3u; ++c) {
+                    palette[0][c] = c0[c];
+                    palette[1][c] = c1[c];
+                    palette[2][c] = (2 * c0[c] + c1[c]) / 3;
+                    palette[3][c] = (c0[c] + 2 * c1[c]) / 3;
+                }
+
+                for (size_t i = 0u; i < block.size(); ++i) {
+                    uint32_t bestIndex = 0u;
+                    int bestError = std::numeric_limits<int>::max();
+                    for (uint32_t j = 0u; j < 4u; ++j) {
+                        int error = 0;
+                        for (size_t c = 0u; c < 3u; ++c) {
+                            const auto d = block[i][c] - palette[j][c];
+                            error += d * d;
+                        }
+                        if (error < bestError) {
+                            bestError = error;
+                            bestIndex = j;
+                        }
+                    }
+                    indices |= bestIndex << (2u * i);
+                }
+            }
+
+            writeLittleEndian(out, color0, 2u);
+            writeLittleEndian(out + 2, color1, 2u);
+            writeLittleEndian(out + 4, indices, 4u);
+        }
+
+        /**
+         * Encodes the alpha channel of the given block as a BC3 alpha block of 8 bytes, using the minimum and maximum
+         * alpha values as end points.
+         */
+        static void encodeAlphaBlock(const PixelBlock& block, unsigned char* out) {
+            int min = 255;
+            int max = 0;
+            for (const auto& pixel : block) {
+                min = std::min(min, pixel[3]);
+                max = std::max(max, pixel[3]);
+            }
+
+            // If both values are equal, the block uses the six value mode in which index 0 also selects the first
+            // value, so the indices can remain 0.
+            uint64_t indices = 0u;
+            if (max > min) {
+                std::array<int, 8> palette;
+                palette[0] = max;
+                palette[1] = min;
+                for (int i = 1; i < 7; ++i) {
+                    palette[static_cast<size_t>(i + 1)] = ((7 - i) * max + i * min) / 7;
+                }
+
+                for (size_t i = 0u; i < block.size(); ++i) {
+                    uint64_t bestIndex = 0u;
+                    int bestError = std::numeric_limits<int>::max();
+                    for (size_t j = 0u; j < palette.size(); ++j) {
+                        const auto error = std::abs(block[i][3] - palette[j]);
+                        if (error < bestError) {
+                            bestError = error;
+                            bestIndex = j;
+                        }
+                    }
+                    indices |= bestIndex << (3u * i);
+                }
+            }
+
+            out[0] = static_cast<unsigned char>(max);
+            out[1] = static_cast<unsigned char>(min);
+            writeLittleEndian(out + 2, indices, 6u);
+        }
+
+        GLenum compressTextureBuffers(TextureBufferList& buffers, const size_t width, const size_t height, const GLenum format, const bool withAlpha) {
+            ensure(format == GL_RGBA || format == GL_BGRA, "expected RGBA or BGRA");
+
+            const auto redIndex = format == GL_RGBA ? 0u : 2u;
+            const auto blueIndex = 2u - redIndex;
+            const auto compressedFormat = withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+
+            PixelBlock block;
+            for (size_t level = 0u; level < buffers.size(); ++level) {
+                const auto mipSize = sizeAtMipLevel(width, height, level);
+                auto compressed = TextureBuffer(compressedImageSize(mipSize.x(), mipSize.y(), compressedFormat));
+                auto* out = compressed.data();
+
+                for (size_t blockY = 0u; blockY < (mipSize.y() + 3u) / 4u; ++blockY) {
+                    for (size_t blockX = 0u; blockX < (mipSize.x() + 3u) / 4u; ++blockX) {
+                        readBlock(buffers[level].data(), mipSize.x(), mipSize.y(), blockX, blockY, redIndex, blueIndex, block);
+                        if (withAlpha) {
+                            encodeAlphaBlock(block, out);
+                            out += 8;
+                        }
+                        encodeColorBlock(block, out);
+                        out += 8;
+                    }
+                }
+
+                buffers[level] = std::move(compressed);
+            }
+
+            return static_cast<GLenum>(compressedFormat);
+        }
+
+        GLenum decompressTextureBuffers(TextureBufferList& buffers, const size_t width, const size_t height, const GLenum format) {
+            ensure(isCompressedFormat(format), "expected a compressed format");
+
+            const auto withAlpha = format == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+
+            PixelBlock block;
+            for (size_t level = 0u; level < buffers.size(); ++level) {
+                const auto mipSize = sizeAtMipLevel(width, height, level);
+                auto decompressed = TextureBuffer(mipSize.x() * mipSize.y() * 4u);
+                const auto* in = buffers[level].data();
+
+                for (size_t blockY = 0u; blockY < (mipSize.y() + 3u) / 4u; ++blockY) {
+                    for (size_t blockX = 0u; blockX < (mipSize.x() + 3u) / 4u; ++blockX) {
+                        if (withAlpha) {
+                            decodeColorBlock(in + 8, true, block);
+                            decodeAlphaBlock(in, block);
+                            in += 16;
+                        } else {
+                            decodeColorBlock(in, false, block);
+                            in += 8;
+                        }
+                        writeBlock(decompressed.data(), mipSize.x(), mipSize.y(), blockX, blockY, block);
+                    }
+                }
+
+                buffers[level] = std::move(decompressed);
+            }
+
+            return GL_RGBA;
+        }
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRENCHBROOM_TEXTURECOMPRESSION_H
+#define TRENCHBROOM_TEXTURECOMPRESSION_H
+
+#include "Assets/TextureBuffer.h"
+#include "Renderer/GL.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        /**
+         * Returns whether the given format is one of the block compressed formats produced by compressTextureBuffers.
+         */
+        bool isCompressedFormat(GLenum format);
+
+        /**
+         * Returns whether the OpenGL driver can upload the formats produced by compressTextureBuffers. Returns false
+         * until the OpenGL extensions have been initialized, so it must only be called with a current OpenGL context.
+         */
+        bool isTextureCompressionSupported();
+
+        /**
+         * Returns the number of bytes of an image of the given size in the given block compressed format.
+         */
+        size_t compressedImageSize(size_t width, size_t height, GLenum format);
+
+        /**
+         * Replaces the data of every mip level with its block compressed encoding and returns the resulting format.
+         * Images with an alpha channel are encoded as BC3 (DXT5), all others as BC1 (DXT1).
+         *
+         * @param buffers the mip levels, which must have been sized using setMipBufferSize
+         * @param width the width of the first mip level
+         * @param height the height of the first mip level
+         * @param format the format of the given buffers, must be GL_RGBA or GL_BGRA
+         * @param withAlpha whether the alpha channel should be preserved
+         * @return the compressed format
+         */
+        GLenum compressTextureBuffers(TextureBufferList& buffers, size_t width, size_t height, GLenum format, bool withAlpha);
+
+        /**
+         * Replaces the data of every mip level with its decoded pixels and returns the resulting format. Used to upload
+         * compressed textures if the driver does not support the compressed formats.
+         *
+         * @param buffers the mip levels in the given compressed format
+         * @param width the width of the first mip level
+         * @param height the height of the first mip level
+         * @param format the format of the given buffers, must be a format produced by compressTextureBuffers
+         * @return GL_RGBA
+         */
+        GLenum decompressTextureBuffers(TextureBufferList& buffers, size_t width, size_t height, GLenum format);
+    }
+}
+
+#endif //TRENCHBROOM_TEXTURECOMPRESSION_H
@@ -23,15 +23,18 @@
 #include "Logger.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureCollection.h"
+#include "Assets/TextureCompression.h"
 #include "IO/TextureLoader.h"
 
 #include <kdl/map_utils.h>
+#include <kdl/parallel.h>
 #include <kdl/string_format.h>
 #include <kdl/vector_utils.h>
 
 #include <algorithm>
 #include <chrono>
 #include <iterator>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -60,7 +63,14 @@ namespace TrenchBroom {
         m_logger(logger),
         m_minFilter(minFilter),
         m_magFilter(magFilter),
-        m_resetTextureMode(false) {}
+        m_resetTextureMode(false),
+        m_memoryBudget(0),
+        m_activationCountAtLastCommit(0),
+        m_usageChangeCountAtLastCommit(Texture::usageChangeCount()),
+        m_generation(0),
+        m_texturesChanged(false),
+        m_uploadedTexturesChanged(false),
+        m_loggedTextureDecompression(false) {}
 
         TextureManager::~TextureManager() = default;
 
@@ -121,6 +131,8 @@ namespace TrenchBroom {
             m_toPrepare.clear();
             m_texturesByName.clear();
             m_textures.clear();
+            m_texturesChanged = true;
+            ++m_generation;
 
             // Remove logging because it might fail when the document is already destroyed.
         }
@@ -131,10 +143,76 @@ namespace TrenchBroom {
             m_resetTextureMode = true;
         }
 
+        void TextureManager::setMemoryBudget(const size_t memoryBudget) {
+            m_memoryBudget = memoryBudget;
+            m_uploadedTexturesChanged = true;
+        }
+
         void TextureManager::commitChanges() {
             resetTextureMode();
             prepare();
+
+            const auto usageChangeCount = Texture::usageChangeCount();
+            if (m_texturesChanged || usageChangeCount != m_usageChangeCountAtLastCommit) {
+                loadUsedTextures();
+                m_texturesChanged = false;
+                m_usageChangeCountAtLastCommit = usageChangeCount;
+
+                // textures that are not used anymore may be evicted now
+                m_uploadedTexturesChanged = true;
+            }
+
+            if (m_uploadedTexturesChanged) {
+                evictTextures();
+                m_uploadedTexturesChanged = false;
+            }
+
             m_toRemove.clear();
+
+            m_activationCountAtLastCommit = Texture::activationCount();
+        }
+
+        void TextureManager::loadTextures(const std::vector<const Texture*>& textures) {
+            struct Result {
+                Texture* texture;
+                std::optional<Texture> decoded;
+                std::string error;
+                BufferingLogger logger;
+            };
+
+            auto results = std::vector<Result>();
+            for (const auto* texture : textures) {
+                if (texture->needsLoading()) {
+                    // the textures are owned by the collections of this manager
+                    results.push_back(Result{const_cast<Texture*>(texture), std::nullopt, "", BufferingLogger()});
+                }
+            }
+
+            if (results.empty()) {
+                return;
+            }
+            m_uploadedTexturesChanged = true;
+
+            kdl::parallel_for(results.size(), [&](const size_t i) {
+                auto& result = results[i];
+                try {
+                    result.decoded = result.texture->decode(result.logger);
+                } catch (const std::exception& e) {
+                    result.error = e.what();
+                }
+            });
+
+            // upload in the order of the given textures so that the log is deterministic
+            for (auto& result : results) {
+                result.logger.flush(m_logger);
+                if (result.decoded) {
+                    logTextureDecompression(*result.decoded);
+                    result.texture->load(std::move(*result.decoded));
+                } else {
+                    m_logger.error() << "Could not load texture '" << result.texture->name() << "': " << result.error;
+                    result.texture->load(Texture(result.texture->name(), result.texture->width(), result.texture->height()));
+                }
+            }
         }
 
         const Texture* TextureManager::texture(const std::string& name) const {
@@ -158,6 +236,10 @@ namespace TrenchBroom {
             return m_collections;
         }
 
+        size_t TextureManager::generation() const {
+            return m_generation;
+        }
+
         void TextureManager::resetTextureMode() {
             if (m_resetTextureMode) {
                 for (auto& collection : m_collections) {
@@ -170,14 +252,74 @@ namespace TrenchBroom {
         void TextureManager::prepare() {
             for (const size_t index : m_toPrepare) {
                 auto& collection = m_collections[index];
+                for (const auto& texture : collection.textures()) {
+                    logTextureDecompression(texture);
+                }
                 collection.prepare(m_minFilter, m_magFilter);
+                m_uploadedTexturesChanged = true;
             }
             m_toPrepare.clear();
         }
 
+        void TextureManager::loadUsedTextures() {
+            auto usedTextures = std::vector<const Texture*>();
+            for (const auto* texture : m_textures) {
+                if (texture->usageCount() > 0) {
+                    usedTextures.push_back(texture);
+                }
+            }
+            loadTextures(usedTextures);
+        }
+
+        void TextureManager::evictTextures() {
+            if (m_memoryBudget == 0) {
+                return;
+            }
+
+            auto uploadedSize = size_t(0);
+            auto evictable = std::vector<Texture*>();
+            for (auto& collection : m_collections) {
+                for (auto& texture : collection.textures()) {
+                    uploadedSize += texture.uploadedSize();
+
+                    // textures activated since the last commit are probably still visible
+                    if (texture.deferred() && texture.isPrepared() && texture.usageCount() == 0 &&
+                        texture.lastActivation() <= m_activationCountAtLastCommit) {
+                        evictable.push_back(&texture);
+                    }
+                }
+            }
+
+            if (uploadedSize <= m_memoryBudget) {
+                return;
+            }
+
+            // evict the least recently activated textures first
+            std::sort(std::begin(evictable), std::end(evictable), [](const auto* lhs, const auto* rhs) {
+                return lhs->lastActivation() < rhs->lastActivation();
+            });
+
+            for (auto* texture : evictable) {
+                if (uploadedSize <= m_memoryBudget) {
+                    break;
+                }
+                uploadedSize -= texture->uploadedSize();
+                texture->evict();
+            }
+        }
+
+        void TextureManager::logTextureDecompression(const Texture& texture) {
+            if (!m_loggedTextureDecompression && isCompressedFormat(texture.format()) && !isTextureCompressionSupported()) {
+                m_logger.warn() << "The graphics driver does not support S3TC texture compression, compressed textures are decompressed before they are uploaded";
+                m_loggedTextureDecompression = true;
+            }
+        }
+
         void TextureManager::updateTextures() {
             m_texturesByName.clear();
             m_textures.clear();
+            m_texturesChanged = true;
+            ++m_generation;
 
             for (auto& collection : m_collections) {
                 for (auto& texture : collection.textures()) {
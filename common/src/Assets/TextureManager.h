@@ -55,6 +55,16 @@ namespace TrenchBroom {
             int m_minFilter;
             int m_magFilter;
             bool m_resetTextureMode;
+
+            size_t m_memoryBudget;
+            size_t m_activationCountAtLastCommit;
+            size_t m_usageChangeCountAtLastCommit;
+            size_t m_generation;
+
+            // whether the textures of the collections or the uploaded textures changed since the last commit
+            bool m_texturesChanged;
+            bool m_uploadedTexturesChanged;
+            bool m_loggedTextureDecompression;
         public:
             TextureManager(int magFilter, int minFilter, Logger& logger);
             ~TextureManager();
@@ -67,16 +77,45 @@ namespace TrenchBroom {
             void clear();
 
             void setTextureMode(int minFilter, int magFilter);
+
+            /**
+             * Sets the number of bytes of GPU memory that the textures may use before unused textures are evicted.
+             * A budget of 0 disables eviction.
+             */
+            void setMemoryBudget(size_t memoryBudget);
+
+            /**
+             * Prepares the added texture collections, loads the pixel data of all textures that are in use and evicts
+             * unused textures if the memory budget is exceeded. Requires a current OpenGL context.
+             *
+             * The textures are only checked if their usage counts, the texture collections or the uploaded textures
+             * changed since the last commit, so that committing is cheap if nothing changed.
+             */
             void commitChanges();
 
+            /**
+             * Loads the pixel data of the given textures if they have been deferred. Requires a current OpenGL
+             * context. The textures must be managed by this texture manager.
+             */
+            void loadTextures(const std::vector<const Texture*>& textures);
+
             const Texture* texture(const std::string& name) const;
             Texture* texture(const std::string& name);
             
             const std::vector<const Texture*>& textures() const;
             const std::vector<TextureCollection>& collections() const;
+
+            /**
+             * Returns a number that changes whenever texture collections are added or removed. Once it has changed,
+             * textures obtained from this manager earlier may have been destroyed.
+             */
+            size_t generation() const;
         private:
             void resetTextureMode();
             void prepare();
+            void loadUsedTextures();
+            void evictTextures();
+            void logTextureDecompression(const Texture& texture);
 
             void updateTextures();
         };
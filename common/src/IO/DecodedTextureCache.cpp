@@ -0,0 +1,287 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "DecodedTextureCache.h"
+
+#include "Exceptions.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/PathQt.h"
+#include "IO/Reader.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtGlobal>
+
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace IO {
+        namespace DecodedTextureCacheLayout {
+            static const uint32_t Magic = 0x43544254; // "TBTC"
+            static const uint32_t Version = 1;
+            static const size_t MaxMipLevels = 32;
+            static const char* EntryExtension = "tbtex";
+        }
+
+        static uint64_t fnv1a(uint64_t hash, const char* begin, const char* end) {
+            static const uint64_t Prime = 0x100000001b3;
+            for (const auto* cur = begin; cur != end; ++cur) {
+                hash ^= static_cast<unsigned char>(*cur);
+                hash *= Prime;
+            }
+            return hash;
+        }
+
+        template <typename T>
+        static uint64_t fnv1a(const uint64_t hash, const T& value) {
+            const auto* begin = reinterpret_cast<const char*>(&value);
+            return fnv1a(hash, begin, begin + sizeof(T));
+        }
+
+        template <typename T>
+        static void write(QFileDevice& file, const T& value) {
+            file.write(reinterpret_cast<const char*>(&value), static_cast<qint64>(sizeof(T)));
+        }
+
+        template <typename T>
+        static bool read(QFile& file, T& value) {
+            return file.read(reinterpret_cast<char*>(&value), static_cast<qint64>(sizeof(T))) == static_cast<qint64>(sizeof(T));
+        }
+
+        /**
+         * Sets the modification time of the given entry to the current time so that the entry is pruned last. Entries
+         * that were loaded recently are not touched again, so that loading them does not write to the disk every time.
+         */
+        static void touch(const QString& entryPath) {
+            const auto now = QDateTime::currentDateTime();
+            if (QFileInfo(entryPath).lastModified().secsTo(now) < 60 * 60) {
+                return;
+            }
+
+            // setting the modification time requires write access on some platforms
+            QFile file(entryPath);
+            if (file.open(QIODevice::ReadWrite)) {
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+                file.setFileTime(now, QFileDevice::FileModificationTime);
+#else
+                // rewriting the first bytes of the entry updates its modification time
+                write(file, DecodedTextureCacheLayout::Magic);
+#endif
+            }
+        }
+
+        /**
+         * Returns the entries in the given directory, the most recently used entry first.
+         */
+        static QFileInfoList findEntries(const Path& directory) {
+            using namespace DecodedTextureCacheLayout;
+
+            const auto nameFilter = QString("*.") + EntryExtension;
+            return QDir(pathAsQString(directory)).entryInfoList(QStringList(nameFilter), QDir::Files, QDir::Time);
+        }
+
+        static uint64_t totalSize(const QFileInfoList& entries) {
+            auto result = uint64_t(0);
+            for (const auto& entry : entries) {
+                result += static_cast<uint64_t>(entry.size());
+            }
+            return result;
+        }
+
+        const uint64_t DecodedTextureCache::DefaultMaxSize = uint64_t(1) << 30;
+
+        DecodedTextureCache::DecodedTextureCache(const Path& directory, const uint64_t maxSize) :
+        m_directory(directory),
+        m_maxSize(maxSize) {}
+
+        uint64_t DecodedTextureCache::key(const File& file, const std::string& parameters) {
+            static const uint64_t OffsetBasis = 0xcbf29ce484222325;
+
+            auto hash = fnv1a(OffsetBasis, parameters.data(), parameters.data() + parameters.size());
+            hash = fnv1a(hash, static_cast<uint64_t>(file.size()));
+
+            const auto diskPath = file.diskPath();
+            if (diskPath.isEmpty()) {
+                // the file only exists in memory, e.g. because it was extracted from a compressed archive
+                const auto path = file.path().asString();
+                const auto reader = file.reader().buffer();
+                hash = fnv1a(hash, path.data(), path.data() + path.size() + 1u); // include the terminating zero
+                return fnv1a(hash, reader.begin(), reader.end());
+            }
+
+            // a file that is stored in an archive is identified by the archive and its offset in it
+            const auto path = diskPath.asString();
+            const auto modificationTime = QFileInfo(pathAsQString(diskPath)).lastModified().toMSecsSinceEpoch();
+            hash = fnv1a(hash, path.data(), path.data() + path.size() + 1u); // include the terminating zero
+            hash = fnv1a(hash, static_cast<uint64_t>(file.diskOffset()));
+            return fnv1a(hash, static_cast<int64_t>(modificationTime));
+        }
+
+        std::optional<DecodedTexture> DecodedTextureCache::load(const uint64_t key) const {
+            using namespace DecodedTextureCacheLayout;
+
+            const auto path = pathAsQString(entryPath(key));
+            QFile file(path);
+            if (!file.open(QIODevice::ReadOnly)) {
+                return std::nullopt;
+            }
+
+            uint32_t magic, version, width, height, format, type, mipLevels;
+            float r, g, b, a;
+            if (!read(file, magic) || magic != Magic ||
+                !read(file, version) || version != Version ||
+                !read(file, width) || !read(file, height) || !read(file, format) || !read(file, type) ||
+                !read(file, r) || !read(file, g) || !read(file, b) || !read(file, a) ||
+                !read(file, mipLevels)) {
+                return std::nullopt;
+            }
+
+            if (width == 0u || height == 0u || mipLevels == 0u || mipLevels > MaxMipLevels ||
+                type > static_cast<uint32_t>(Assets::TextureType::Masked)) {
+                return std::nullopt;
+            }
+
+            auto sizes = std::vector<uint64_t>(mipLevels);
+            for (auto& size : sizes) {
+                if (!read(file, size)) {
+                    return std::nullopt;
+                }
+            }
+
+            // check the sizes before anything is allocated
+            auto remaining = static_cast<uint64_t>(file.size() - file.pos());
+            for (const auto size : sizes) {
+                if (size > remaining) {
+                    return std::nullopt;
+                }
+                remaining -= size;
+            }
+
+            // the mip levels are read directly into the buffers
+            auto buffers = Assets::TextureBufferList();
+            buffers.reserve(mipLevels);
+            for (const auto size : sizes) {
+                auto buffer = Assets::TextureBuffer(static_cast<size_t>(size));
+                if (file.read(reinterpret_cast<char*>(buffer.data()), static_cast<qint64>(size)) != static_cast<qint64>(size)) {
+                    return std::nullopt;
+                }
+                buffers.push_back(std::move(buffer));
+            }
+
+            file.close();
+            touch(path);
+
+            return DecodedTexture{width, height, static_cast<GLenum>(format), static_cast<Assets::TextureType>(type), Color(r, g, b, a), std::move(buffers)};
+        }
+
+        void DecodedTextureCache::store(const uint64_t key, const DecodedTexture& texture) const {
+            using namespace DecodedTextureCacheLayout;
+
+            if (texture.buffers.empty() || texture.buffers.size() > MaxMipLevels) {
+                return;
+            }
+
+            try {
+                Disk::ensureDirectoryExists(m_directory);
+            } catch (const FileSystemException&) {
+                return;
+            }
+
+            // QSaveFile writes to a temporary file and renames it on commit
+            QSaveFile file(pathAsQString(entryPath(key)));
+            if (!file.open(QIODevice::WriteOnly)) {
+                return;
+            }
+
+            write(file, Magic);
+            write(file, Version);
+            write(file, static_cast<uint32_t>(texture.width));
+            write(file, static_cast<uint32_t>(texture.height));
+            write(file, static_cast<uint32_t>(texture.format));
+            write(file, static_cast<uint32_t>(texture.type));
+            write(file, texture.averageColor.r());
+            write(file, texture.averageColor.g());
+            write(file, texture.averageColor.b());
+            write(file, texture.averageColor.a());
+            write(file, static_cast<uint32_t>(texture.buffers.size()));
+
+            for (const auto& buffer : texture.buffers) {
+                write(file, static_cast<uint64_t>(buffer.size()));
+            }
+            for (const auto& buffer : texture.buffers) {
+                file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<qint64>(buffer.size()));
+            }
+
+            const auto entrySize = static_cast<uint64_t>(file.size());
+            if (file.commit()) {
+                addToSize(key, entrySize);
+            }
+        }
+
+        void DecodedTextureCache::clear() const {
+            const auto lock = std::lock_guard<std::mutex>(m_sizeMutex);
+            m_size = prune(std::nullopt, 0u);
+        }
+
+        Path DecodedTextureCache::entryPath(const uint64_t key) const {
+            std::stringstream str;
+            str << std::hex << std::setw(16) << std::setfill('0') << key << "." << DecodedTextureCacheLayout::EntryExtension;
+            return m_directory + Path(str.str());
+        }
+
+        void DecodedTextureCache::addToSize(const uint64_t key, const uint64_t entrySize) const {
+            const auto lock = std::lock_guard<std::mutex>(m_sizeMutex);
+            if (m_size.has_value()) {
+                *m_size += entrySize;
+            } else {
+                // the given entry is already stored, so it is included
+                m_size = totalSize(findEntries(m_directory));
+            }
+
+            if (*m_size > m_maxSize) {
+                // leave some room so that the cache is not pruned again by the next few entries
+                m_size = prune(key, m_maxSize / 4u * 3u);
+            }
+        }
+
+        // Removes the least recently used entries except for the entry to keep until the total size of the entries does not exceed
+        // the given size, and returns the size of the remaining entries.
+        uint64_t DecodedTextureCache::prune(const std::optional<uint64_t> keepKey, const uint64_t maxSize) const {
+            const auto entries = findEntries(m_directory);
+            const auto keepName = keepKey.has_value() ? pathAsQString(entryPath(*keepKey).lastComponent()) : QString();
+
+            auto size = totalSize(entries);
+            for (auto it = entries.rbegin(); it != entries.rend() && size > maxSize; ++it) {
+                // removing an entry fails on some platforms while it is being read
+                if (it->fileName() != keepName && QFile::remove(it->filePath())) {
+                    size -= static_cast<uint64_t>(it->size());
+                }
+            }
+            return size;
+        }
+    }
+}
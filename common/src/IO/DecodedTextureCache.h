@@ -0,0 +1,128 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_DecodedTextureCache
+#define TrenchBroom_DecodedTextureCache
+
+#include "Color.h"
+#include "Macros.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "IO/Path.h"
+#include "Renderer/GL.h"
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace TrenchBroom {
+    namespace IO {
+        class File;
+
+        /**
+         * The pixel data and attributes of a decoded texture, excluding its name.
+         */
+        struct DecodedTexture {
+            size_t width;
+            size_t height;
+            GLenum format;
+            Assets::TextureType type;
+            Color averageColor;
+            Assets::TextureBufferList buffers;
+        };
+
+        /**
+         * Stores decoded textures in a directory so that they need not be decoded again the next time they are
+         * loaded.
+         *
+         * The key of an entry is a hash of where the source file is stored on the disk, its size and modification
+         * time, and of the parameters that affect decoding, so computing it does not require reading the source file.
+         * Changing the source file or the decoder therefore leads to a different key instead of a stale entry. Source
+         * files that are not stored on the disk are identified by their path and contents instead.
+         *
+         * Each entry is a single file with a small header followed by the data of every mip level exactly as it is
+         * passed to OpenGL, so that reading an entry requires no further processing. The mip levels are read directly
+         * into the buffers of the decoded texture. Entries are written atomically, so concurrent readers and writers
+         * never observe a partially written entry.
+         *
+         * The total size of the entries is limited. When storing an entry exceeds the limit, the least recently used
+         * entries are removed until the cache is reduced to three quarters of its maximum size. The modification time
+         * of an entry is updated when it is loaded, unless that happened less than an hour ago. An entry that is
+         * removed while still in use is decoded and stored again the next time it is loaded.
+         *
+         * All member functions can be called concurrently.
+         */
+        class DecodedTextureCache {
+        public:
+            static const uint64_t DefaultMaxSize;
+        private:
+            Path m_directory;
+            uint64_t m_maxSize;
+
+            // the total size of the entries, determined when the first entry is stored
+            mutable std::mutex m_sizeMutex;
+            mutable std::optional<uint64_t> m_size;
+        public:
+            /**
+             * Creates a cache that stores its entries in the given directory. The directory is created when the first
+             * entry is stored.
+             *
+             * @param directory the directory to store the entries in
+             * @param maxSize the maximum total size of the entries in bytes
+             */
+            explicit DecodedTextureCache(const Path& directory, uint64_t maxSize = DefaultMaxSize);
+
+            /**
+             * Computes the key of the entry for the given source file. Only reads the file if it is not stored on the
+             * disk.
+             *
+             * @param file the source file
+             * @param parameters a string that identifies everything besides the file that affects decoding, such as
+             * the decoder version or the palette
+             */
+            static uint64_t key(const File& file, const std::string& parameters);
+
+            /**
+             * Returns the entry with the given key, or an empty optional if there is no such entry or if it cannot be
+             * read.
+             */
+            std::optional<DecodedTexture> load(uint64_t key) const;
+
+            /**
+             * Stores the given texture under the given key. Errors are ignored since the cache is only an
+             * optimization.
+             */
+            void store(uint64_t key, const DecodedTexture& texture) const;
+
+            /**
+             * Removes all entries. Entries that cannot be removed because they are in use are left in place.
+             */
+            void clear() const;
+        private:
+            Path entryPath(uint64_t key) const;
+            void addToSize(uint64_t key, uint64_t entrySize) const;
+            uint64_t prune(std::optional<uint64_t> keepKey, uint64_t maxSize) const;
+
+            deleteCopyAndMove(DecodedTextureCache)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_DecodedTextureCache) */
@@ -20,6 +20,10 @@
 #include "EntityModelParser.h"
 
 #include "Assets/EntityModel.h"
+#include "IO/File.h"
+#include "IO/Reader.h"
+
+#include <algorithm>
 
 namespace TrenchBroom {
     namespace IO {
@@ -34,5 +38,24 @@ namespace TrenchBroom {
         }
 
         void EntityModelParser::doLoadFrame(const size_t /* frameIndex */, Assets::EntityModel& /* model */, Logger& /* logger */) {}
+
+        std::unique_ptr<Assets::EntityModel> initializeModel(std::shared_ptr<File> file, EntityModelParserFactory createParser, Logger& logger) {
+            auto model = [&]() {
+                const auto reader = file->reader().buffer();
+                return createParser(std::begin(reader), std::end(reader))->initializeModel(logger);
+            }();
+
+            const auto frames = model->frames();
+            if (std::all_of(std::begin(frames), std::end(frames), [](const auto* frame) { return frame->loaded(); })) {
+                return model;
+            }
+
+            // the model keeps the file until all of its frames are loaded
+            model->setFrameLoader([file = std::move(file), createParser = std::move(createParser)](const size_t frameIndex, Assets::EntityModel& m, Logger& l) {
+                const auto reader = file->reader().buffer();
+                createParser(std::begin(reader), std::end(reader))->loadFrame(frameIndex, m, l);
+            });
+            return model;
+        }
     }
 }
@@ -20,6 +20,7 @@
 #ifndef TrenchBroom_EntityModelParser
 #define TrenchBroom_EntityModelParser
 
+#include <functional>
 #include <memory>
 
 namespace TrenchBroom {
@@ -30,6 +31,8 @@ namespace TrenchBroom {
     }
 
     namespace IO {
+        class File;
+
         class EntityModelParser {
         public:
             virtual ~EntityModelParser();
@@ -40,6 +43,21 @@ namespace TrenchBroom {
             virtual std::unique_ptr<Assets::EntityModel> doInitializeModel(Logger& logger) = 0;
             virtual void doLoadFrame(size_t frameIndex, Assets::EntityModel& model, Logger& logger);
         };
+
+        using EntityModelParserFactory = std::function<std::unique_ptr<EntityModelParser>(const char* begin, const char* end)>;
+
+        /**
+         * Initializes a model from the given file using a parser created by the given factory. The frames of the
+         * model are loaded on demand by its frame loader, which keeps only the file. Every frame is parsed from the
+         * file contents by a new parser, and both are released once the frame is loaded. The file is released
+         * once all frames are loaded.
+         *
+         * @param file the model file
+         * @param createParser creates a parser for the given file contents
+         * @param logger the logger to use while initializing the model
+         * @return the initialized model
+         */
+        std::unique_ptr<Assets::EntityModel> initializeModel(std::shared_ptr<File> file, EntityModelParserFactory createParser, Logger& logger);
     }
 }
 
@@ -33,6 +33,14 @@ namespace TrenchBroom {
             return m_path;
         }
 
+        Path File::diskPath() const {
+            return Path();
+        }
+
+        size_t File::diskOffset() const {
+            return 0u;
+        }
+
         OwningBufferFile::OwningBufferFile(const Path& path, std::unique_ptr<char[]> buffer, const size_t size) :
         File(path),
         m_buffer(std::move(buffer)),
@@ -86,6 +94,10 @@ namespace TrenchBroom {
             return m_size;
         }
 
+        Path CFile::diskPath() const {
+            return path();
+        }
+
         std::FILE* CFile::file() const {
             return m_file;
         }
@@ -103,5 +115,13 @@ namespace TrenchBroom {
         size_t FileView::size() const {
             return m_length;
         }
+
+        Path FileView::diskPath() const {
+            return m_file->diskPath();
+        }
+
+        size_t FileView::diskOffset() const {
+            return m_file->diskOffset() + m_offset;
+        }
     }
 }
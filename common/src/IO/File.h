@@ -60,6 +60,17 @@ namespace TrenchBroom {
              * Returns the size of this file in bytes.
              */
             virtual size_t size() const = 0;
+
+            /**
+             * Returns the path of the physical file on the disk that contains the data of this file, or an empty path
+             * if this file is not backed by a physical file.
+             */
+            virtual Path diskPath() const;
+
+            /**
+             * Returns the offset of the data of this file in the physical file returned by diskPath().
+             */
+            virtual size_t diskOffset() const;
         };
 
         /**
@@ -127,6 +138,7 @@ namespace TrenchBroom {
 
             Reader reader() const override;
             size_t size() const override;
+            Path diskPath() const override;
 
             /**
              * Returns the underlying file.
@@ -155,6 +167,8 @@ namespace TrenchBroom {
 
             Reader reader() const override;
             size_t size() const override;
+            Path diskPath() const override;
+            size_t diskOffset() const override;
         };
 
         // TODO: get rid of this, it's evil
@@ -25,15 +25,26 @@
 #include "FreeImage.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureBuffer.h"
+#include "Assets/TextureCompression.h"
+#include "IO/DecodedTextureCache.h"
 #include "IO/File.h"
 #include "IO/ImageLoaderImpl.h"
 
 #include <stdexcept>
+#include <string>
 
 namespace TrenchBroom {
     namespace IO {
-        FreeImageTextureReader::FreeImageTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger) :
-        TextureReader(nameStrategy, fs, logger) {}
+        /**
+         * Identifies the decoding performed by decodeImage in the keys of cached textures. Change it whenever the
+         * decoded data changes.
+         */
+        static const std::string CacheParameters = "FreeImage 2";
+
+        FreeImageTextureReader::FreeImageTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache, const bool compress) :
+        TextureReader(nameStrategy, fs, logger),
+        m_cache(std::move(cache)),
+        m_compress(compress) {}
 
         /**
          * The byte order of a 32bpp FIBITMAP is defined by the macros FI_RGBA_RED,
@@ -76,12 +87,11 @@ namespace TrenchBroom {
             return average;
         }
 
-        Assets::Texture FreeImageTextureReader::doReadTexture(std::shared_ptr<File> file) const {
-            auto reader = file->reader().buffer();
+        DecodedTexture FreeImageTextureReader::decodeImage(const File& file, const bool compress) {
+            auto reader = file.reader().buffer();
 
             InitFreeImage::initialize();
 
-            const auto& path            = file->path();
             const auto* begin           = reader.begin();
             const auto* end             = reader.end();
             const auto  imageSize       = static_cast<size_t>(end - begin);
@@ -108,7 +118,9 @@ namespace TrenchBroom {
             // This is supposed to indicate whether any pixels are transparent (alpha < 100%)
             const auto masked = FreeImage_IsTransparent(image);
 
-            const size_t mipCount = 1;
+            // Masked textures are uploaded without mipmaps, see Assets::Texture::upload. For all others, we compute the
+            // full mipmap chain here so that it is decoded concurrently and can be cached.
+            const auto mipCount = masked ? size_t(1) : Assets::fullMipLevelCount(imageWidth, imageHeight);
             constexpr auto format = freeImage32BPPFormatToGLFormat();
             Assets::TextureBufferList buffers(mipCount);
             Assets::setMipBufferSize(buffers, mipCount, imageWidth, imageHeight, format);
@@ -136,10 +148,77 @@ namespace TrenchBroom {
             FreeImage_Unload(image);
             FreeImage_CloseMemory(imageMemory);
 
+            Assets::generateMipLevels(buffers, imageWidth, imageHeight, format);
+
             const auto textureType = Assets::Texture::selectTextureType(masked);
             const Color averageColor = getAverageColor(buffers.at(0), format);
 
-            return Assets::Texture(textureName(path), imageWidth, imageHeight, averageColor, std::move(buffers), format, textureType);
+            if (compress) {
+                const auto compressedFormat = Assets::compressTextureBuffers(buffers, imageWidth, imageHeight, format, masked);
+                return DecodedTexture{imageWidth, imageHeight, compressedFormat, textureType, averageColor, std::move(buffers)};
+            }
+
+            return DecodedTexture{imageWidth, imageHeight, format, textureType, averageColor, std::move(buffers)};
+        }
+
+        Assets::Texture FreeImageTextureReader::doReadTexture(std::shared_ptr<File> file, Logger& /* logger */) const {
+            const auto& path = file->path();
+
+            // textures are usually read before the OpenGL context exists, so the support for the compressed formats is
+            // only checked when they are uploaded
+            if (m_cache == nullptr) {
+                auto decoded = decodeImage(*file, m_compress);
+                return Assets::Texture(textureName(path), decoded.width, decoded.height, decoded.averageColor, std::move(decoded.buffers), decoded.format, decoded.type);
+            }
+
+            const auto key = DecodedTextureCache::key(*file, m_compress ? CacheParameters + " BC" : CacheParameters);
+            auto decoded = m_cache->load(key);
+            if (!decoded) {
+                decoded = decodeImage(*file, m_compress);
+                m_cache->store(key, *decoded);
+            }
+
+            return Assets::Texture(textureName(path), decoded->width, decoded->height, decoded->averageColor, std::move(decoded->buffers), decoded->format, decoded->type);
+        }
+
+        Assets::Texture FreeImageTextureReader::doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const {
+            auto reader = file->reader().buffer();
+
+            InitFreeImage::initialize();
+
+            const auto& path            = file->path();
+            const auto* begin           = reader.begin();
+            const auto* end             = reader.end();
+            const auto  imageSize       = static_cast<size_t>(end - begin);
+                  auto* imageBegin      = reinterpret_cast<BYTE*>(const_cast<char*>(begin));
+                  auto* imageMemory     = FreeImage_OpenMemory(imageBegin, static_cast<DWORD>(imageSize));
+            const auto  imageFormat     = FreeImage_GetFileTypeFromMemory(imageMemory);
+
+            if (imageFormat == FIF_UNKNOWN || !FreeImage_FIFSupportsNoPixels(imageFormat)) {
+                FreeImage_CloseMemory(imageMemory);
+                return doReadTexture(file, logger);
+            }
+
+            auto* image = FreeImage_LoadFromMemory(imageFormat, imageMemory, FIF_LOAD_NOPIXELS);
+            if (image == nullptr) {
+                FreeImage_CloseMemory(imageMemory);
+                throw AssetException("FreeImage could not load image header");
+            }
+
+            const auto imageWidth      = static_cast<size_t>(FreeImage_GetWidth(image));
+            const auto imageHeight     = static_cast<size_t>(FreeImage_GetHeight(image));
+            const auto masked          = FreeImage_IsTransparent(image);
+
+            FreeImage_Unload(image);
+            FreeImage_CloseMemory(imageMemory);
+
+            if (!checkTextureDimensions(imageWidth, imageHeight)) {
+                throw AssetException("Invalid texture dimensions");
+            }
+
+            // the type is only a guess until the pixels are decoded, see Assets::Texture::load
+            const auto textureType = Assets::Texture::selectTextureType(masked);
+            return Assets::Texture(textureName(path), imageWidth, imageHeight, freeImage32BPPFormatToGLFormat(), textureType);
         }
     }
 }
@@ -29,14 +29,25 @@ namespace TrenchBroom {
     class Logger;
     
     namespace IO {
+        class DecodedTextureCache;
+        struct DecodedTexture;
         class File;
         class FileSystem;
 
         class FreeImageTextureReader : public TextureReader {
+        private:
+            std::shared_ptr<const DecodedTextureCache> m_cache;
+            bool m_compress;
         public:
-            explicit FreeImageTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger);
+            /**
+             * Creates a new reader. If a cache is given, decoded images are looked up in and stored to it. If compress
+             * is true, the decoded images are block compressed, see Assets::compressTextureBuffers.
+             */
+            explicit FreeImageTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache = nullptr, bool compress = false);
         private:
-            Assets::Texture doReadTexture(std::shared_ptr<File> file) const override;
+            Assets::Texture doReadTexture(std::shared_ptr<File> file, Logger& logger) const override;
+            Assets::Texture doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const override;
+            static DecodedTexture decodeImage(const File& file, bool compress);
         };
     }
 }
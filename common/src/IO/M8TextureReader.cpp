@@ -44,7 +44,7 @@ namespace TrenchBroom {
         M8TextureReader::M8TextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger) :
         TextureReader(nameStrategy, fs, logger) {}
 
-        Assets::Texture M8TextureReader::doReadTexture(std::shared_ptr<File> file) const {
+        Assets::Texture M8TextureReader::doReadTexture(std::shared_ptr<File> file, Logger& /* logger */) const {
             const auto& path = file->path();
             BufferedReader reader = file->reader().buffer();
             try {
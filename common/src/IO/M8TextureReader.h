@@ -36,7 +36,7 @@ namespace TrenchBroom {
         public:
             M8TextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger);
         private:
-            Assets::Texture doReadTexture(std::shared_ptr<File> file) const override;
+            Assets::Texture doReadTexture(std::shared_ptr<File> file, Logger& logger) const override;
         };
     }
 }
@@ -268,6 +268,23 @@ namespace TrenchBroom {
         }
 
         void Md2Parser::doLoadFrame(size_t frameIndex, Assets::EntityModel& model, Logger& /* logger */) {
+            if (!m_frameTable) {
+                m_frameTable = parseFrameTable();
+            }
+
+            const auto& table = *m_frameTable;
+            if (frameIndex >= table.frameCount) {
+                throw AssetException("Invalid MD2 frame index: " + std::to_string(frameIndex));
+            }
+
+            const auto reader = Reader::from(m_begin, m_end);
+            const auto frame = parseFrame(reader.subReaderFromBegin(table.frameOffset + frameIndex * table.frameSize, table.frameSize), frameIndex, table.vertexCount);
+
+            auto& surface = model.surface(0);
+            buildFrame(model, surface, frameIndex, frame, table.meshes);
+        }
+
+        Md2Parser::Md2FrameTable Md2Parser::parseFrameTable() {
             auto reader = Reader::from(m_begin, m_end);
             const auto ident = reader.readInt<int32_t>();
             const auto version = reader.readInt<int32_t>();
@@ -288,7 +305,7 @@ namespace TrenchBroom {
             /* const auto texCoordCount =*/ reader.readSize<int32_t>();
             /* const auto triangleCount =*/ reader.readSize<int32_t>();
             const auto commandCount = reader.readSize<int32_t>();
-            /* const auto frameCount = */ reader.readSize<int32_t>();
+            const auto frameCount = reader.readSize<int32_t>();
 
             /* const auto skinOffset = */ reader.readSize<int32_t>();
             /* const auto texCoordOffset =*/ reader.readSize<int32_t>();
@@ -297,11 +314,9 @@ namespace TrenchBroom {
             const auto commandOffset = reader.readSize<int32_t>();
 
             const auto frameSize = 6 * sizeof(float) + Md2Layout::FrameNameLength + vertexCount * 4;
-            const auto frame = parseFrame(reader.subReaderFromBegin(frameOffset + frameIndex * frameSize, frameSize), frameIndex, vertexCount);
-            const auto meshes = parseMeshes(reader.subReaderFromBegin(commandOffset, commandCount * 4), commandCount);
+            auto meshes = parseMeshes(reader.subReaderFromBegin(commandOffset, commandCount * 4), commandCount);
 
-            auto& surface = model.surface(0);
-            buildFrame(model, surface, frameIndex, frame, meshes);
+            return Md2FrameTable{vertexCount, frameCount, frameOffset, frameSize, std::move(meshes)};
         }
 
         Md2Parser::Md2SkinList Md2Parser::parseSkins(Reader reader, const size_t skinCount) {
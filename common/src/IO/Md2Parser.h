@@ -26,6 +26,7 @@
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -89,18 +90,30 @@ namespace TrenchBroom {
             };
             using Md2MeshList =  std::vector<Md2Mesh>;
 
+            /**
+             * The data shared by all frames and the location of the frames in the file.
+             */
+            struct Md2FrameTable {
+                size_t vertexCount;
+                size_t frameCount;
+                size_t frameOffset;
+                size_t frameSize;
+                Md2MeshList meshes;
+            };
 
             std::string m_name;
             const char* m_begin;
             const char* m_end;
             const Assets::Palette& m_palette;
             const FileSystem& m_fs;
+            std::optional<Md2FrameTable> m_frameTable;
         public:
             Md2Parser(const std::string& name, const char* begin, const char* end, const Assets::Palette& palette, const FileSystem& fs);
         private:
             std::unique_ptr<Assets::EntityModel> doInitializeModel(Logger& logger) override;
             void doLoadFrame(size_t frameIndex, Assets::EntityModel& model, Logger& logger) override;
 
+            Md2FrameTable parseFrameTable();
             Md2SkinList parseSkins(Reader reader, size_t skinCount);
             Md2Frame parseFrame(Reader reader, size_t frameIndex, size_t vertexCount);
             Md2MeshList parseMeshes(Reader reader, size_t commandCount);
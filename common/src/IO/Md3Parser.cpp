@@ -92,32 +92,18 @@ namespace TrenchBroom {
         }
 
         void Md3Parser::doLoadFrame(const size_t frameIndex, Assets::EntityModel& model, Logger& /* logger */) {
-            auto reader = Reader::from(m_begin, m_end);
-
-            const auto ident = reader.readInt<int32_t>();
-            const auto version = reader.readInt<int32_t>();
-
-            if (ident != Md3Layout::Ident) {
-                throw AssetException("Unknown MD3 model ident: " + std::to_string(ident));
-            }
-            if (version != Md3Layout::Version) {
-                throw AssetException("Unknown MD3 model version: " + std::to_string(version));
+            if (!m_frameTable) {
+                m_frameTable = parseFrameTable();
             }
 
-            /* const auto name = */ reader.readString(Md3Layout::ModelNameLength);
-            /* const auto flags = */ reader.readInt<int32_t>();
-
-            /* const auto frameCount = */ reader.readSize<int32_t>();
-            /* const auto tagCount = */ reader.readSize<int32_t>();
-            /* const auto surfaceCount = */ reader.readSize<int32_t>();
-            /* const auto skinCount = */ reader.readSize<int32_t>();
-
-            const auto frameOffset = reader.readSize<int32_t>();
-            /* const auto tagOffset = */ reader.readSize<int32_t>();
-            const auto surfaceOffset = reader.readSize<int32_t>();
+            const auto& table = *m_frameTable;
+            if (frameIndex >= table.frameCount) {
+                throw AssetException("Invalid MD3 frame index: " + std::to_string(frameIndex));
+            }
 
-            auto& frame = parseFrame(reader.subReaderFromBegin(frameOffset + frameIndex * Md3Layout::FrameLength, Md3Layout::FrameLength), frameIndex, model);
-            parseFrameSurfaces(reader.subReaderFromBegin(surfaceOffset), frame, model);
+            const auto reader = Reader::from(m_begin, m_end);
+            auto& frame = parseFrame(reader.subReaderFromBegin(table.frameOffset + frameIndex * Md3Layout::FrameLength, Md3Layout::FrameLength), frameIndex, model);
+            parseFrameSurfaces(table, frame, model);
         }
 
         void Md3Parser::parseSurfaces(Reader reader, const size_t surfaceCount, Assets::EntityModel& model, Logger& logger) {
@@ -160,8 +146,58 @@ namespace TrenchBroom {
             return model.loadFrame(frameIndex, frameName, vm::bbox3f(minBounds, maxBounds));
         }
 
-        void Md3Parser::parseFrameSurfaces(Reader reader, Assets::EntityModelLoadedFrame& frame, Assets::EntityModel& model) {
-            for (size_t i = 0; i < model.surfaceCount(); ++i) {
+        void Md3Parser::parseFrameSurfaces(const Md3FrameTable& table, Assets::EntityModelLoadedFrame& frame, Assets::EntityModel& model) {
+            const auto reader = Reader::from(m_begin, m_end);
+
+            for (size_t i = 0; i < table.surfaces.size(); ++i) {
+                const auto& surfaceTable = table.surfaces[i];
+                if (surfaceTable.frameCount > 0) {
+                    const auto frameVertexLength = surfaceTable.vertexCount * Md3Layout::VertexLength;
+                    const auto frameVertexOffset = surfaceTable.vertexOffset + frame.index() * frameVertexLength;
+
+                    const auto vertexPositions = parseVertexPositions(reader.subReaderFromBegin(frameVertexOffset, frameVertexLength), surfaceTable.vertexCount);
+                    const auto vertices = buildVertices(vertexPositions, surfaceTable.texCoords);
+
+                    auto& surface = model.surface(i);
+                    buildFrameSurface(frame, surface, surfaceTable.triangles, vertices);
+                }
+            }
+        }
+
+        Md3Parser::Md3FrameTable Md3Parser::parseFrameTable() {
+            auto reader = Reader::from(m_begin, m_end);
+
+            const auto ident = reader.readInt<int32_t>();
+            const auto version = reader.readInt<int32_t>();
+
+            if (ident != Md3Layout::Ident) {
+                throw AssetException("Unknown MD3 model ident: " + std::to_string(ident));
+            }
+            if (version != Md3Layout::Version) {
+                throw AssetException("Unknown MD3 model version: " + std::to_string(version));
+            }
+
+            /* const auto name = */ reader.readString(Md3Layout::ModelNameLength);
+            /* const auto flags = */ reader.readInt<int32_t>();
+
+            const auto frameCount = reader.readSize<int32_t>();
+            /* const auto tagCount = */ reader.readSize<int32_t>();
+            const auto surfaceCount = reader.readSize<int32_t>();
+            /* const auto skinCount = */ reader.readSize<int32_t>();
+
+            const auto frameOffset = reader.readSize<int32_t>();
+            /* const auto tagOffset = */ reader.readSize<int32_t>();
+            const auto surfaceOffset = reader.readSize<int32_t>();
+
+            return Md3FrameTable{frameCount, frameOffset, parseSurfaceTables(reader, surfaceOffset, surfaceCount)};
+        }
+
+        std::vector<Md3Parser::Md3SurfaceTable> Md3Parser::parseSurfaceTables(const Reader& fileReader, size_t surfaceOffset, const size_t surfaceCount) {
+            std::vector<Md3SurfaceTable> result;
+            result.reserve(surfaceCount);
+
+            for (size_t i = 0; i < surfaceCount; ++i) {
+                auto reader = fileReader.subReaderFromBegin(surfaceOffset);
                 const auto ident = reader.readInt<int32_t>();
 
                 if (ident != Md3Layout::Ident) {
@@ -181,22 +217,18 @@ namespace TrenchBroom {
                 const auto vertexOffset = reader.readSize<int32_t>(); // all vertices for all frames are stored there!
                 const auto endOffset = reader.readSize<int32_t>();
 
+                auto texCoords = std::vector<vm::vec2f>();
+                auto triangles = std::vector<Md3Triangle>();
                 if (frameCount > 0) {
-                    const auto frameVertexLength = vertexCount * Md3Layout::VertexLength;
-                    const auto frameVertexOffset = vertexOffset + frame.index() * frameVertexLength;
-
-                    const auto vertexPositions = parseVertexPositions(reader.subReaderFromBegin(frameVertexOffset, frameVertexLength), vertexCount);
-                    const auto texCoords = parseTexCoords(reader.subReaderFromBegin(texCoordOffset, vertexCount * Md3Layout::TexCoordLength), vertexCount);
-                    const auto vertices = buildVertices(vertexPositions, texCoords);
-
-                    const auto triangles = parseTriangles(reader.subReaderFromBegin(triangleOffset, triangleCount * Md3Layout::TriangleLength), triangleCount);
-
-                    auto& surface = model.surface(i);
-                    buildFrameSurface(frame, surface, triangles, vertices);
+                    texCoords = parseTexCoords(reader.subReaderFromBegin(texCoordOffset, vertexCount * Md3Layout::TexCoordLength), vertexCount);
+                    triangles = parseTriangles(reader.subReaderFromBegin(triangleOffset, triangleCount * Md3Layout::TriangleLength), triangleCount);
                 }
 
-                reader = reader.subReaderFromBegin(endOffset);
+                result.push_back(Md3SurfaceTable{frameCount, vertexCount, surfaceOffset + vertexOffset, std::move(texCoords), std::move(triangles)});
+                surfaceOffset += endOffset;
             }
+
+            return result;
         }
 
         std::vector<Md3Parser::Md3Triangle> Md3Parser::parseTriangles(Reader reader, const size_t triangleCount) {
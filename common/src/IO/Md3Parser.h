@@ -24,8 +24,10 @@
 #include "IO/EntityModelParser.h"
 
 #include <vecmath/forward.h>
+#include <vecmath/vec.h>
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -49,6 +51,28 @@ namespace TrenchBroom {
             struct Md3Triangle {
                 size_t i1, i2, i3;
             };
+
+            /**
+             * The data of a surface that is shared by all frames and the location of its per frame vertices.
+             */
+            struct Md3SurfaceTable {
+                size_t frameCount;
+                size_t vertexCount;
+                size_t vertexOffset; // relative to the start of the file
+                std::vector<vm::vec2f> texCoords;
+                std::vector<Md3Triangle> triangles;
+            };
+
+            /**
+             * The location of the frames in the file and the tables of all surfaces.
+             */
+            struct Md3FrameTable {
+                size_t frameCount;
+                size_t frameOffset;
+                std::vector<Md3SurfaceTable> surfaces;
+            };
+
+            std::optional<Md3FrameTable> m_frameTable;
         public:
             Md3Parser(const std::string& name, const char* begin, const char* end, const FileSystem& fs);
         private:
@@ -57,7 +81,10 @@ namespace TrenchBroom {
 
             void parseSurfaces(Reader surfaceReader, size_t surfaceCount, Assets::EntityModel& model, Logger& logger);
             Assets::EntityModelLoadedFrame& parseFrame(Reader frameReader, size_t frameIndex, Assets::EntityModel& model);
-            void parseFrameSurfaces(Reader surfaceReader, Assets::EntityModelLoadedFrame& frame, Assets::EntityModel& model);
+            void parseFrameSurfaces(const Md3FrameTable& table, Assets::EntityModelLoadedFrame& frame, Assets::EntityModel& model);
+
+            Md3FrameTable parseFrameTable();
+            std::vector<Md3SurfaceTable> parseSurfaceTables(const Reader& reader, size_t surfaceOffset, size_t surfaceCount);
 
             std::vector<Md3Triangle> parseTriangles(Reader reader, size_t triangleCount);
             std::vector<Path> parseShaders(Reader reader, size_t shaderCount);
@@ -260,6 +260,23 @@ namespace TrenchBroom {
         }
 
         void MdlParser::doLoadFrame(const size_t frameIndex, Assets::EntityModel& model, Logger& /* logger */) {
+            if (!m_frameTable) {
+                m_frameTable = parseFrameTable();
+            }
+
+            const auto& table = *m_frameTable;
+            if (frameIndex >= table.frameOffsets.size()) {
+                throw AssetException("Invalid MDL frame index: " + std::to_string(frameIndex));
+            }
+
+            auto reader = Reader::from(m_begin, m_end);
+            reader.seekFromBegin(table.frameOffsets[frameIndex]);
+
+            auto& surface = model.surface(0);
+            parseFrame(reader, model, frameIndex, surface, table.triangles, table.vertices, table.skinWidth, table.skinHeight, table.origin, table.scale);
+        }
+
+        MdlParser::MdlFrameTable MdlParser::parseFrameTable() {
             auto reader = Reader::from(m_begin, m_end).buffer();
 
             const auto ident = reader.readInt<int32_t>();
@@ -281,19 +298,18 @@ namespace TrenchBroom {
             const auto skinHeight = reader.readSize<int32_t>();
             const auto vertexCount = reader.readSize<int32_t>();
             const auto triangleCount = reader.readSize<int32_t>();
-            /* const auto frameCount = */ reader.readSize<int32_t>();
+            const auto frameCount = reader.readSize<int32_t>();
             /* const auto syncType = */ reader.readSize<int32_t>();
             const auto flags = reader.readInt<int32_t>();
 
             reader.seekFromBegin(MdlLayout::Skins);
             skipSkins(reader, skinCount, skinWidth, skinHeight, flags);
 
-            const auto vertices = parseVertices(reader, vertexCount);
-            const auto triangles = parseTriangles(reader, triangleCount);
+            auto vertices = parseVertices(reader, vertexCount);
+            auto triangles = parseTriangles(reader, triangleCount);
+            auto frameOffsets = indexFrames(reader, frameCount, vertexCount);
 
-            auto& surface = model.surface(0);
-            skipFrames(reader, frameIndex, vertexCount);
-            parseFrame(reader, model, frameIndex, surface, triangles, vertices, skinWidth, skinHeight, origin, scale);
+            return MdlFrameTable{scale, origin, skinWidth, skinHeight, std::move(vertices), std::move(triangles), std::move(frameOffsets)};
         }
 
         void MdlParser::parseSkins(BufferedReader& reader, Assets::EntityModelSurface& surface, const size_t count, const size_t width, const size_t height, const int flags) {
@@ -369,10 +385,15 @@ namespace TrenchBroom {
             return triangles;
         }
 
-        void MdlParser::skipFrames(Reader& reader, const size_t count, size_t vertexCount) {
+        std::vector<size_t> MdlParser::indexFrames(Reader& reader, const size_t count, size_t vertexCount) {
             const auto frameLength = MdlLayout::SimpleFrameName + MdlLayout::SimpleFrameLength + vertexCount * 4;
 
+            auto offsets = std::vector<size_t>();
+            offsets.reserve(count);
+
             for (size_t i = 0; i < count; ++i) {
+                offsets.push_back(reader.position());
+
                 const auto type = reader.readInt<int32_t>();
                 if (type == 0) { // single frame
                     reader.seekForward(frameLength);
@@ -386,6 +407,8 @@ namespace TrenchBroom {
                     reader.seekForward(frameTimeLength + groupFrameCount * frameLength);
                 }
             }
+
+            return offsets;
         }
 
         void MdlParser::parseFrame(Reader& reader, Assets::EntityModel& model, size_t frameIndex, Assets::EntityModelSurface& surface, const MdlSkinTriangleList& triangles, const MdlSkinVertexList& vertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale) {
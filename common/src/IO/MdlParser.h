@@ -26,6 +26,7 @@
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
 
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -58,10 +59,25 @@ namespace TrenchBroom {
             using PackedFrameVertex = vm::vec<unsigned char, 4>;
             using PackedFrameVertexList = std::vector<PackedFrameVertex>;
 
+            /**
+             * The data shared by all frames and the offsets of the frames in the file, so that loading a frame only
+             * reads that frame's vertices.
+             */
+            struct MdlFrameTable {
+                vm::vec3f scale;
+                vm::vec3f origin;
+                size_t skinWidth;
+                size_t skinHeight;
+                MdlSkinVertexList vertices;
+                MdlSkinTriangleList triangles;
+                std::vector<size_t> frameOffsets;
+            };
+
             std::string m_name;
             const char* m_begin;
             const char* m_end;
             const Assets::Palette& m_palette;
+            std::optional<MdlFrameTable> m_frameTable;
         public:
             MdlParser(const std::string& name, const char* begin, const char* end, const Assets::Palette& palette);
         private:
@@ -74,7 +90,8 @@ namespace TrenchBroom {
             MdlSkinVertexList parseVertices(Reader& reader, size_t count);
             MdlSkinTriangleList parseTriangles(Reader& reader, size_t count);
 
-            void skipFrames(Reader& reader, size_t count, size_t vertexCount);
+            MdlFrameTable parseFrameTable();
+            std::vector<size_t> indexFrames(Reader& reader, size_t count, size_t vertexCount);
             void parseFrame(Reader& reader, Assets::EntityModel& model, size_t frameIndex, Assets::EntityModelSurface& surface, const MdlSkinTriangleList& triangles, const MdlSkinVertexList& vertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale);
             void doParseFrame(Reader reader, Assets::EntityModel& model, size_t frameIndex, Assets::EntityModelSurface& surface, const MdlSkinTriangleList& triangles, const MdlSkinVertexList& vertices, size_t skinWidth, size_t skinHeight, const vm::vec3f& origin, const vm::vec3f& scale);
             vm::vec3f unpackFrameVertex(const PackedFrameVertex& vertex, const vm::vec3f& origin, const vm::vec3f& scale) const;
@@ -58,7 +58,7 @@ namespace TrenchBroom {
             }
         }
 
-        Assets::Texture MipTextureReader::doReadTexture(std::shared_ptr<File> file) const {
+        Assets::Texture MipTextureReader::doReadTexture(std::shared_ptr<File> file, Logger& /* logger */) const {
             static const size_t MipLevels = 4;
 
             Color averageColor;
@@ -118,5 +118,31 @@ namespace TrenchBroom {
                 throw AssetException(e.what());
             }
         }
+
+        Assets::Texture MipTextureReader::doReadTextureHeader(std::shared_ptr<File> file, Logger& /* logger */) const {
+            ensure(!file->path().isEmpty(), "MipTextureReader::doReadTextureHeader requires a path");
+
+            const auto path = file->path();
+            const auto basename = path.lastComponent().deleteExtension().asString();
+            const auto name = textureName(basename, path);
+            try {
+                auto reader = file->reader().buffer();
+                reader.readString(MipLayout::TextureNameLength);
+
+                const auto width = reader.readSize<int32_t>();
+                const auto height = reader.readSize<int32_t>();
+
+                if (!checkTextureDimensions(width, height)) {
+                    throw AssetException("Invalid texture dimensions");
+                }
+
+                const auto type = (!name.empty() && name.at(0) == '{')
+                                  ? Assets::TextureType::Masked
+                                  : Assets::TextureType::Opaque;
+                return Assets::Texture(name, width, height, GL_RGBA, type);
+            } catch (const ReaderException& e) {
+                throw AssetException(e.what());
+            }
+        }
     }
 }
@@ -32,10 +32,20 @@
 
 namespace TrenchBroom {
     namespace IO {
-        Quake3ShaderTextureReader::Quake3ShaderTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger) :
-        TextureReader(nameStrategy, fs, logger) {}
+        Quake3ShaderTextureReader::Quake3ShaderTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache, const bool compress) :
+        TextureReader(nameStrategy, fs, logger),
+        m_cache(std::move(cache)),
+        m_compress(compress) {}
 
-        Assets::Texture Quake3ShaderTextureReader::doReadTexture(std::shared_ptr<File> file) const {
+        Assets::Texture Quake3ShaderTextureReader::doReadTexture(std::shared_ptr<File> file, Logger& logger) const {
+            return readShaderTexture(std::move(file), logger, false);
+        }
+
+        Assets::Texture Quake3ShaderTextureReader::doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const {
+            return readShaderTexture(std::move(file), logger, true);
+        }
+
+        Assets::Texture Quake3ShaderTextureReader::readShaderTexture(std::shared_ptr<File> file, Logger& logger, const bool headerOnly) const {
             const auto* shaderFile = dynamic_cast<ObjectFile<Assets::Quake3Shader>*>(file.get());
             if (shaderFile == nullptr) {
                 throw AssetException("File is not a shader");
@@ -47,7 +57,7 @@ namespace TrenchBroom {
                 throw AssetException("Could not find texture path for shader '" + shader.shaderPath.asString() + "'");
             }
 
-            auto texture = loadTextureImage(shader.shaderPath, texturePath);
+            auto texture = loadTextureImage(shader.shaderPath, texturePath, logger, headerOnly);
             texture.setSurfaceParms(shader.surfaceParms);
             texture.setOpaque();
 
@@ -79,14 +89,15 @@ namespace TrenchBroom {
             return texture;
         }
 
-        Assets::Texture Quake3ShaderTextureReader::loadTextureImage(const Path& shaderPath, const Path& imagePath) const {
+        Assets::Texture Quake3ShaderTextureReader::loadTextureImage(const Path& shaderPath, const Path& imagePath, Logger& logger, const bool headerOnly) const {
             const auto name = textureName(shaderPath);
             if (!m_fs.fileExists(imagePath)) {
                 throw AssetException("Image file '" + imagePath.asString() + "' does not exist");
             }
 
-            FreeImageTextureReader imageReader(StaticNameStrategy(name), m_fs, m_logger);
-            return imageReader.readTexture(m_fs.openFile(imagePath));
+            FreeImageTextureReader imageReader(StaticNameStrategy(name), m_fs, logger, m_cache, m_compress);
+            auto imageFile = m_fs.openFile(imagePath);
+            return headerOnly ? imageReader.readTextureHeader(imageFile, logger) : imageReader.readTexture(imageFile, logger);
         }
 
         Path Quake3ShaderTextureReader::findTexturePath(const Assets::Quake3Shader& shader) const {
@@ -30,6 +30,7 @@ namespace TrenchBroom {
     }
 
     namespace IO {
+        class DecodedTextureCache;
         class File;
         class FileSystem;
         class Path;
@@ -40,6 +41,9 @@ namespace TrenchBroom {
          * available as a virtual object file in the file system.
          */
         class Quake3ShaderTextureReader : public TextureReader {
+        private:
+            std::shared_ptr<const DecodedTextureCache> m_cache;
+            bool m_compress;
         public:
             /**
              * Creates a texture reader using the given name strategy and file system to locate the texture image.
@@ -47,11 +51,15 @@ namespace TrenchBroom {
              * @param nameStrategy the strategy to determine the texture name
              * @param fs the file system to use when locating the texture image
              * @param logger the logger to use
+             * @param cache the cache for decoded texture images, may be null
+             * @param compress whether to block compress the texture images
              */
-            Quake3ShaderTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger);
+            Quake3ShaderTextureReader(const NameStrategy& nameStrategy, const FileSystem& fs, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache = nullptr, bool compress = false);
         private:
-            Assets::Texture doReadTexture(std::shared_ptr<File> file) const override;
-            Assets::Texture loadTextureImage(const Path& shaderPath, const Path& imagePath) const;
+            Assets::Texture doReadTexture(std::shared_ptr<File> file, Logger& logger) const override;
+            Assets::Texture doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const override;
+            Assets::Texture readShaderTexture(std::shared_ptr<File> file, Logger& logger, bool headerOnly) const;
+            Assets::Texture loadTextureImage(const Path& shaderPath, const Path& imagePath, Logger& logger, bool headerOnly) const;
             Path findTexturePath(const Assets::Quake3Shader& shader) const;
             Path findTexture(const Path& texturePath) const;
         };
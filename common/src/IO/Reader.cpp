@@ -70,13 +70,41 @@ namespace TrenchBroom {
             return doBuffer();
         }
 
+        /**
+         * Locks a file for the current thread while it is in scope. The stdio functions lock the file themselves, but
+         * seeking and reading must happen under one lock if several sources share a file.
+         */
+        class FileLock {
+        private:
+            std::FILE* m_file;
+        public:
+            explicit FileLock(std::FILE* file) :
+            m_file(file) {
+#ifdef _WIN32
+                _lock_file(m_file);
+#else
+                flockfile(m_file);
+#endif
+            }
+
+            ~FileLock() {
+#ifdef _WIN32
+                _unlock_file(m_file);
+#else
+                funlockfile(m_file);
+#endif
+            }
+
+            FileLock(const FileLock&) = delete;
+            FileLock& operator=(const FileLock&) = delete;
+        };
+
         Reader::FileSource::FileSource(std::FILE* file, const size_t offset, const size_t length) :
         m_file(file),
         m_offset(offset),
         m_length(length),
         m_position(0) {
             assert(m_file != nullptr);
-            std::rewind(m_file);
         }
 
 
@@ -89,9 +117,8 @@ namespace TrenchBroom {
         }
 
         void Reader::FileSource::doRead(char* val, const size_t size) {
-            // We might consider removing this check under the assumption that the file position is set in the constructor
-            // of this reader and that no other reader will access the file while this reader is in use. This may be a
-            // reasonable assumption, since we usually read files one by one.
+            // other sources may have moved the file position, possibly on another thread
+            const auto lock = FileLock(m_file);
 
             const auto pos = std::ftell(m_file);
             if (pos < 0) {
@@ -117,16 +144,17 @@ namespace TrenchBroom {
         }
 
         std::tuple<const char*, const char*, std::unique_ptr<char[]>> Reader::FileSource::doBuffer() const {
-            std::fseek(m_file, static_cast<long>(m_offset), SEEK_SET);
-
             auto buffer = std::make_unique<char[]>(m_length);
-            const auto read = std::fread(buffer.get(), 1, m_length, m_file);
-            if (read != m_length) {
-                throwError("fread failed");
-            }
+            {
+                const auto lock = FileLock(m_file);
+                if (std::fseek(m_file, static_cast<long>(m_offset), SEEK_SET) != 0) {
+                    throwError("fseek failed");
+                }
 
-            if (std::fseek(m_file, static_cast<long>(m_offset + m_position), SEEK_SET) != 0) {
-                throwError("fseek failed");
+                const auto read = std::fread(buffer.get(), 1, m_length, m_file);
+                if (read != m_length) {
+                    throwError("fread failed");
+                }
             }
 
             const char* begin = buffer.get();
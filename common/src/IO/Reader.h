@@ -124,7 +124,8 @@ namespace TrenchBroom {
             /**
              * A reader source that reads directly from a file. Note that the seek position of the underlying C file
              * is kept in sync with this file source's position automatically, that is, two readers can read from the
-             * same underlying file without causing problems.
+             * same underlying file without causing problems. The file is locked while it is positioned and read, so
+             * this also holds if the readers are used on different threads, e.g. for the entries of a pak file.
              */
             class FileSource : public Source {
             private:
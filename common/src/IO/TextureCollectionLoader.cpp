@@ -19,6 +19,7 @@
 
 #include "TextureCollectionLoader.h"
 
+#include "Exceptions.h"
 #include "Logger.h"
 #include "Assets/TextureCollection.h"
 #include "IO/DiskIO.h"
@@ -28,18 +29,24 @@
 #include "IO/TextureReader.h"
 #include "IO/WadFileSystem.h"
 
+#include <kdl/parallel.h>
+
+#include <cassert>
 #include <memory>
+#include <optional>
+#include <string>
 #include <vector>
 
 namespace TrenchBroom {
     namespace IO {
-        TextureCollectionLoader::TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions) :
+        TextureCollectionLoader::TextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<std::string>& exclusions) :
         m_logger(logger),
+        m_gameFS(std::move(gameFS)),
         m_textureExclusions(exclusions) {}
 
         TextureCollectionLoader::~TextureCollectionLoader() = default;
 
-        bool TextureCollectionLoader::shouldExclude(const std::string& textureName) {
+        bool TextureCollectionLoader::shouldExclude(const std::string& textureName) const {
             for (const auto& pattern : m_textureExclusions) {
                 if (kdl::ci::str_matches_glob(textureName, pattern)) {
                     return true;
@@ -48,68 +55,118 @@ namespace TrenchBroom {
             return false;
         }
 
-        FileTextureCollectionLoader::FileTextureCollectionLoader(Logger& logger, const std::vector<IO::Path>& searchPaths, const std::vector<std::string>& exclusions) :
-        TextureCollectionLoader(logger, exclusions),
+        std::vector<std::optional<Assets::Texture>> TextureCollectionLoader::readTextures(const size_t fileCount, const OpenFile& openFile, const CreateDecoder& createDecoder, const TextureReader& textureReader) {
+            struct Result {
+                std::optional<Assets::Texture> texture;
+                BufferingLogger logger;
+            };
+
+            // Reading is independent for every file, but the messages are passed on in the order of the files so
+            // that the log does not depend on how the work was distributed over the threads.
+            auto results = std::vector<Result>(fileCount);
+            kdl::parallel_for(fileCount, [&](const size_t i) {
+                auto& result = results[i];
+                try {
+                    auto file = openFile(i, result.logger);
+                    if (file == nullptr) {
+                        return;
+                    }
+
+                    try {
+                        auto texture = textureReader.readTextureHeader(file, result.logger);
+                        texture.setDecoder(createDecoder(i));
+                        result.texture = std::move(texture);
+                    } catch (const AssetException&) {
+                        // let the reader report the error and substitute the default texture
+                        result.texture = textureReader.readTexture(file, result.logger);
+                    }
+                } catch (const std::exception& e) {
+                    result.logger.warn() << e.what();
+                }
+            });
+
+            auto textures = std::vector<std::optional<Assets::Texture>>();
+            textures.reserve(results.size());
+            for (auto& result : results) {
+                result.logger.flush(m_logger);
+                textures.push_back(std::move(result.texture));
+            }
+            return textures;
+        }
+
+        FileTextureCollectionLoader::FileTextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<IO::Path>& searchPaths, const std::vector<std::string>& exclusions) :
+        TextureCollectionLoader(logger, std::move(gameFS), exclusions),
         m_searchPaths(searchPaths) {}
 
-        Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) {
+        Assets::TextureCollection FileTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, std::shared_ptr<const TextureReader> textureReader) {
             const auto wadPath = Disk::resolvePath(m_searchPaths, path);
-            WadFileSystem wadFS(wadPath, m_logger);
+            // shared with the decoders of the textures, which open their files again when they are needed
+            auto wadFS = std::make_shared<WadFileSystem>(wadPath, m_logger);
+
+            const auto texturePaths = wadFS->findItems(Path(""), FileExtensionMatcher(textureExtensions));
+            const auto openFile = [&](const size_t i, Logger& /* logger */) -> std::shared_ptr<File> {
+                auto file = wadFS->openFile(texturePaths[i]);
+                const auto name = file->path().lastComponent().deleteExtension().asString();
+                return !shouldExclude(name) ? file : nullptr;
+            };
+            const auto createDecoder = [&](const size_t i) -> Decoder {
+                // the texture reader refers to the game file system, so the decoder must keep it alive
+                return [gameFS = m_gameFS, wadFS, texturePath = texturePaths[i], textureReader](Logger& logger) {
+                    return textureReader->readTexture(wadFS->openFile(texturePath), logger);
+                };
+            };
 
-            const auto texturePaths = wadFS.findItems(Path(""), FileExtensionMatcher(textureExtensions));
             auto textures = std::vector<Assets::Texture>();
             textures.reserve(texturePaths.size());
-            
-            for (const auto& texturePath : texturePaths)  {
-                try {
-                    auto file = wadFS.openFile(texturePath);
-                    const auto name = file->path().lastComponent().deleteExtension().asString();
-                    if (shouldExclude(name)) {
-                        continue;
-                    }
-                    textures.push_back(textureReader.readTexture(file));
-                } catch (const std::exception& e) {
-                    m_logger.warn() << e.what();
+
+            for (auto& texture : readTextures(texturePaths.size(), openFile, createDecoder, *textureReader)) {
+                if (texture) {
+                    textures.push_back(std::move(*texture));
                 }
             }
 
             return Assets::TextureCollection(path, std::move(textures));
         }
 
-        DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions) :
-        TextureCollectionLoader(logger, exclusions),
-        m_gameFS(gameFS) {}
+        DirectoryTextureCollectionLoader::DirectoryTextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<std::string>& exclusions) :
+        TextureCollectionLoader(logger, std::move(gameFS), exclusions) {}
 
-        Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) {
-            const auto texturePaths = m_gameFS.findItems(path, FileExtensionMatcher(textureExtensions));
-            auto textures = std::vector<Assets::Texture>();
-            textures.reserve(texturePaths.size());
+        Assets::TextureCollection DirectoryTextureCollectionLoader::loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, std::shared_ptr<const TextureReader> textureReader) {
+            const auto texturePaths = m_gameFS->findItems(path, FileExtensionMatcher(textureExtensions));
+            auto absolutePaths = std::vector<Path>(texturePaths.size());
 
-            for (const auto& texturePath : texturePaths) {
+            const auto openFile = [&](const size_t i, Logger& logger) -> std::shared_ptr<File> {
+                const auto& texturePath = texturePaths[i];
+                auto file = m_gameFS->openFile(texturePath);
+
+                // Store the absolute path to the original file (may be used by .obj export)
                 try {
-                    auto file = m_gameFS.openFile(texturePath);
+                    absolutePaths[i] = m_gameFS->makeAbsolute(texturePath);
+                } catch (const FileSystemException& e) {
+                    logger.debug() << e.what();
+                }
 
-                    // Store the absolute path to the original file (may be used by .obj export)
-                    IO::Path absolutePath;
-                    try {
-                        absolutePath = m_gameFS.makeAbsolute(texturePath);
-                    } catch (const FileSystemException& e) {
-                        m_logger.debug() << e.what();
-                    }
+                const auto name = file->path().lastComponent().deleteExtension().asString();
+                return !shouldExclude(name) ? file : nullptr;
+            };
+            const auto createDecoder = [&](const size_t i) -> Decoder {
+                return [gameFS = m_gameFS, texturePath = texturePaths[i], textureReader](Logger& logger) {
+                    return textureReader->readTexture(gameFS->openFile(texturePath), logger);
+                };
+            };
 
-                    const auto name = file->path().lastComponent().deleteExtension().asString();
-                    if (shouldExclude(name)) {
-                        continue;
-                    }
-                    auto texture = textureReader.readTexture(file);
-                    texture.setAbsolutePath(absolutePath);
-                    texture.setRelativePath(texturePath);
-                    textures.push_back(std::move(texture));
-                } catch (const std::exception& e) {
-                    m_logger.warn() << e.what();
+            auto readResults = readTextures(texturePaths.size(), openFile, createDecoder, *textureReader);
+            auto textures = std::vector<Assets::Texture>();
+            textures.reserve(readResults.size());
+
+            for (size_t i = 0u; i < readResults.size(); ++i) {
+                if (auto& texture = readResults[i]) {
+                    texture->setAbsolutePath(absolutePaths[i]);
+                    texture->setRelativePath(texturePaths[i]);
+                    textures.push_back(std::move(*texture));
                 }
             }
-            
+
             return Assets::TextureCollection(path, std::move(textures));
         }
     }
@@ -20,7 +20,9 @@
 #ifndef TextureCollectionLoader_h
 #define TextureCollectionLoader_h
 
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 #include <string>
@@ -29,6 +31,7 @@ namespace TrenchBroom {
     class Logger;
 
     namespace Assets {
+        class Texture;
         class TextureCollection;
     }
 
@@ -40,36 +43,59 @@ namespace TrenchBroom {
 
         class TextureCollectionLoader {
         protected:
-            using FileList = std::vector<std::shared_ptr<File>>;
+            /**
+             * Opens the texture file with the given index. Returns null if the texture is excluded. Messages must be
+             * logged to the given logger.
+             */
+            using OpenFile = std::function<std::shared_ptr<File>(size_t index, Logger& logger)>;
+            using Decoder = std::function<Assets::Texture(Logger&)>;
+            using CreateDecoder = std::function<Decoder(size_t index)>;
         protected:
             Logger& m_logger;
+            /**
+             * The game file system, which the texture readers refer to. The decoders of the loaded textures share it,
+             * so that it outlives them.
+             */
+            std::shared_ptr<const FileSystem> m_gameFS;
             const std::vector<std::string> m_textureExclusions;
         protected:
-            explicit TextureCollectionLoader(Logger& logger, const std::vector<std::string>& exclusions);
+            TextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<std::string>& exclusions);
         public:
             virtual ~TextureCollectionLoader();
         public:
-            virtual Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader) = 0;
+            /**
+             * Loads the texture collection at the given path. Where the texture format allows it, only the headers of
+             * the textures are read, and the returned textures use the given reader to decode their pixel data on
+             * demand.
+             */
+            virtual Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, std::shared_ptr<const TextureReader> textureReader) = 0;
         protected:
-            bool shouldExclude(const std::string& textureName);
+            bool shouldExclude(const std::string& textureName) const;
+
+            /**
+             * Opens the given number of texture files and reads the headers of their textures concurrently, and sets
+             * the decoders created for them. Every file is released once its header is read, so only a few files are
+             * open at a time. Messages logged while opening a file or reading a texture are passed on to this
+             * loader's logger in the order of the files. The returned vector contains an element for each file, which
+             * is empty if the texture is excluded or could not be read.
+             */
+            std::vector<std::optional<Assets::Texture>> readTextures(size_t fileCount, const OpenFile& openFile, const CreateDecoder& createDecoder, const TextureReader& textureReader);
         };
 
         class FileTextureCollectionLoader : public TextureCollectionLoader {
         private:
             const std::vector<Path> m_searchPaths;
         public:
-            FileTextureCollectionLoader(Logger& logger, const std::vector<Path>& searchPaths, const std::vector<std::string>& exclusions);
+            FileTextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<Path>& searchPaths, const std::vector<std::string>& exclusions);
         private:
-            Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader);
+            Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, std::shared_ptr<const TextureReader> textureReader) override;
         };
 
         class DirectoryTextureCollectionLoader : public TextureCollectionLoader {
-        private:
-            const FileSystem& m_gameFS;
         public:
-            DirectoryTextureCollectionLoader(Logger& logger, const FileSystem& gameFS, const std::vector<std::string>& exclusions);
+            DirectoryTextureCollectionLoader(Logger& logger, std::shared_ptr<const FileSystem> gameFS, const std::vector<std::string>& exclusions);
         private:
-            Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, const TextureReader& textureReader);
+            Assets::TextureCollection loadTextureCollection(const Path& path, const std::vector<std::string>& textureExtensions, std::shared_ptr<const TextureReader> textureReader) override;
         };
     }
 }
@@ -40,10 +40,10 @@
 
 namespace TrenchBroom {
     namespace IO {
-        TextureLoader::TextureLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger) :
+        TextureLoader::TextureLoader(std::shared_ptr<const FileSystem> gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache, const bool compress) :
         m_textureExtensions(getTextureExtensions(textureConfig)),
-        m_textureReader(createTextureReader(gameFS, textureConfig, logger)),
-        m_textureCollectionLoader(createTextureCollectionLoader(gameFS, fileSearchPaths, textureConfig, logger)) {
+        m_textureReader(createTextureReader(*gameFS, textureConfig, logger, std::move(cache), compress)),
+        m_textureCollectionLoader(createTextureCollectionLoader(std::move(gameFS), fileSearchPaths, textureConfig, logger)) {
             ensure(m_textureReader != nullptr, "textureReader is null");
             ensure(m_textureCollectionLoader != nullptr, "textureCollectionLoader is null");
         }
@@ -54,7 +54,7 @@ namespace TrenchBroom {
             return textureConfig.format.extensions;
         }
 
-        std::unique_ptr<TextureReader> TextureLoader::createTextureReader(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger) {
+        std::unique_ptr<TextureReader> TextureLoader::createTextureReader(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache, const bool compress) {
             const auto prefixLength = textureConfig.package.rootDirectory.length();
             const TextureReader::PathSuffixNameStrategy nameStrategy(prefixLength);
             
@@ -65,9 +65,9 @@ namespace TrenchBroom {
             } else if (textureConfig.format.format == "wal") {
                 return std::make_unique<WalTextureReader>(nameStrategy, gameFS, logger, loadPalette(gameFS, textureConfig, logger));
             } else if (textureConfig.format.format == "image") {
-                return std::make_unique<FreeImageTextureReader>(nameStrategy, gameFS, logger);
+                return std::make_unique<FreeImageTextureReader>(nameStrategy, gameFS, logger, std::move(cache), compress);
             } else if (textureConfig.format.format == "q3shader") {
-                return std::make_unique<Quake3ShaderTextureReader>(nameStrategy, gameFS, logger);
+                return std::make_unique<Quake3ShaderTextureReader>(nameStrategy, gameFS, logger, std::move(cache), compress);
             } else if (textureConfig.format.format == "m8") {
                 return std::make_unique<M8TextureReader>(nameStrategy, gameFS, logger);
             } else {
@@ -90,13 +90,13 @@ namespace TrenchBroom {
             }
         }
 
-        std::unique_ptr<TextureCollectionLoader> TextureLoader::createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger) {
+        std::unique_ptr<TextureCollectionLoader> TextureLoader::createTextureCollectionLoader(std::shared_ptr<const FileSystem> gameFS, const std::vector<IO::Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger) {
             using Model::GameConfig;
             switch (textureConfig.package.type) {
                 case Model::TexturePackageConfig::PT_File:
-                    return std::make_unique<FileTextureCollectionLoader>(logger, fileSearchPaths, textureConfig.excludes);
+                    return std::make_unique<FileTextureCollectionLoader>(logger, std::move(gameFS), fileSearchPaths, textureConfig.excludes);
                 case Model::TexturePackageConfig::PT_Directory:
-                    return std::make_unique<DirectoryTextureCollectionLoader>(logger, gameFS, textureConfig.excludes);
+                    return std::make_unique<DirectoryTextureCollectionLoader>(logger, std::move(gameFS), textureConfig.excludes);
                 case Model::TexturePackageConfig::PT_Unset:
                     throw GameException("Texture package format is not set");
                 switchDefault()
@@ -104,7 +104,7 @@ namespace TrenchBroom {
         }
 
         Assets::TextureCollection TextureLoader::loadTextureCollection(const Path& path) {
-            return m_textureCollectionLoader->loadTextureCollection(path, m_textureExtensions, *m_textureReader);
+            return m_textureCollectionLoader->loadTextureCollection(path, m_textureExtensions, m_textureReader);
         }
 
         void TextureLoader::loadTextures(const std::vector<Path>& paths, Assets::TextureManager& textureManager) {
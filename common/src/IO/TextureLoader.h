@@ -40,6 +40,7 @@ namespace TrenchBroom {
     }
 
     namespace IO {
+        class DecodedTextureCache;
         class FileSystem;
         class Path;
         class TextureCollectionLoader;
@@ -48,16 +49,17 @@ namespace TrenchBroom {
         class TextureLoader {
         private:
             std::vector<std::string> m_textureExtensions;
-            std::unique_ptr<TextureReader> m_textureReader;
+            // shared with the loaded textures, which use it to decode their pixel data on demand
+            std::shared_ptr<TextureReader> m_textureReader;
             std::unique_ptr<TextureCollectionLoader> m_textureCollectionLoader;
         public:
-            TextureLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger);
+            TextureLoader(std::shared_ptr<const FileSystem> gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache = nullptr, bool compress = false);
             ~TextureLoader();
         private:
             static std::vector<std::string> getTextureExtensions(const Model::TextureConfig& textureConfig);
-            static std::unique_ptr<TextureReader> createTextureReader(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger);
+            static std::unique_ptr<TextureReader> createTextureReader(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger, std::shared_ptr<const DecodedTextureCache> cache, bool compress);
             static Assets::Palette loadPalette(const FileSystem& gameFS, const Model::TextureConfig& textureConfig, Logger& logger);
-            static std::unique_ptr<TextureCollectionLoader> createTextureCollectionLoader(const FileSystem& gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger);
+            static std::unique_ptr<TextureCollectionLoader> createTextureCollectionLoader(std::shared_ptr<const FileSystem> gameFS, const std::vector<Path>& fileSearchPaths, const Model::TextureConfig& textureConfig, Logger& logger);
         public:
             Assets::TextureCollection loadTextureCollection(const Path& path);
             void loadTextures(const std::vector<Path>& paths, Assets::TextureManager& textureManager);
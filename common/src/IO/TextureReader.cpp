@@ -88,14 +88,26 @@ namespace TrenchBroom {
         }
 
         Assets::Texture TextureReader::readTexture(std::shared_ptr<File> file) const {
+            return readTexture(std::move(file), m_logger);
+        }
+
+        Assets::Texture TextureReader::readTexture(std::shared_ptr<File> file, Logger& logger) const {
             try {
-                return doReadTexture(file);
+                return doReadTexture(file, logger);
             } catch (const AssetException& e) {
-                m_logger.error() << "Could not read texture '" << file->path() << "': " << e.what();
-                return loadDefaultTexture(m_fs, m_logger, textureName(file->path()));
+                logger.error() << "Could not read texture '" << file->path() << "': " << e.what();
+                return loadDefaultTexture(m_fs, logger, textureName(file->path()));
             }
         }
 
+        Assets::Texture TextureReader::readTextureHeader(std::shared_ptr<File> file, Logger& logger) const {
+            return doReadTextureHeader(std::move(file), logger);
+        }
+
+        Assets::Texture TextureReader::doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const {
+            return doReadTexture(std::move(file), logger);
+        }
+
         std::string TextureReader::textureName(const std::string& textureName, const Path& path) const {
             return m_nameStrategy->textureName(textureName, path);
         }
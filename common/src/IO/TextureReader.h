@@ -119,6 +119,29 @@ namespace TrenchBroom {
              * @return an Assets::Texture object
              */
             Assets::Texture readTexture(std::shared_ptr<File> file) const;
+
+            /**
+             * Loads a texture from the given file and returns it, logging to the given logger instead of the logger
+             * passed to this reader's constructor. Allows multiple textures to be loaded concurrently by the same
+             * reader if each thread uses its own logger. If an error occurs while loading the texture, the default
+             * texture is returned.
+             *
+             * @param file the file containing the texture
+             * @param logger the logger to use
+             * @return an Assets::Texture object
+             */
+            Assets::Texture readTexture(std::shared_ptr<File> file, Logger& logger) const;
+
+            /**
+             * Loads the name, size and type of the texture in the given file without decoding its pixel data where
+             * the texture format allows it. For other formats, the returned texture contains its pixel data.
+             *
+             * @param file the file containing the texture
+             * @param logger the logger to use
+             * @return an Assets::Texture object
+             * @throws AssetException if the texture cannot be read
+             */
+            Assets::Texture readTextureHeader(std::shared_ptr<File> file, Logger& logger) const;
         protected:
             std::string textureName(const std::string& textureName, const Path& path) const;
             std::string textureName(const Path& path) const;
@@ -128,9 +151,19 @@ namespace TrenchBroom {
              * report errors loading textures except for unrecoverable errors (out of memory, bugs, etc.).
              *
              * @param file the file containing the texture
+             * @param logger the logger to use
+             * @return an Assets::Texture object
+             */
+            virtual Assets::Texture doReadTexture(std::shared_ptr<File> file, Logger& logger) const = 0;
+
+            /**
+             * Loads a texture without its pixel data. The default implementation loads the entire texture.
+             *
+             * @param file the file containing the texture
+             * @param logger the logger to use
              * @return an Assets::Texture object
              */
-            virtual Assets::Texture doReadTexture(std::shared_ptr<File> file) const = 0;
+            virtual Assets::Texture doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const;
         protected:
             static bool checkTextureDimensions(size_t width, size_t height);
         public:
@@ -39,7 +39,7 @@ namespace TrenchBroom {
         TextureReader(nameStrategy, fs, logger),
         m_palette(palette) {}
 
-        Assets::Texture WalTextureReader::doReadTexture(std::shared_ptr<File> file) const {
+        Assets::Texture WalTextureReader::doReadTexture(std::shared_ptr<File> file, Logger& /* logger */) const {
             const auto& path = file->path();
             auto reader = file->reader().buffer();
 
@@ -57,11 +57,38 @@ namespace TrenchBroom {
             }
         }
 
+        Assets::Texture WalTextureReader::doReadTextureHeader(std::shared_ptr<File> file, Logger& logger) const {
+            const auto& path = file->path();
+            auto reader = file->reader().buffer();
+
+            try {
+                const char version = reader.readChar<char>();
+                reader.seekFromBegin(0);
+
+                if (version == 3) {
+                    // whether a Daikatana texture is masked depends on its pixels
+                    return doReadTexture(file, logger);
+                }
+
+                const std::string name = reader.readString(WalLayout::TextureNameLength);
+                const size_t width = reader.readSize<uint32_t>();
+                const size_t height = reader.readSize<uint32_t>();
+
+                if (!checkTextureDimensions(width, height) || !m_palette.initialized()) {
+                    return doReadTexture(file, logger);
+                }
+
+                return Assets::Texture(textureName(name, path), width, height, GL_RGBA, Assets::TextureType::Opaque);
+            } catch (const ReaderException&) {
+                return Assets::Texture(textureName(path), 16, 16);
+            }
+        }
+
         Assets::Texture WalTextureReader::readQ2Wal(BufferedReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 4;
-            static Color averageColor;
-            static Assets::TextureBufferList buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBufferList buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const std::string name = reader.readString(WalLayout::TextureNameLength);
             const size_t width = reader.readSize<uint32_t>();
@@ -83,9 +110,9 @@ namespace TrenchBroom {
 
         Assets::Texture WalTextureReader::readDkWal(BufferedReader& reader, const Path& path) const {
             static const size_t MaxMipLevels = 9;
-            static Color averageColor;
-            static Assets::TextureBufferList buffers(MaxMipLevels);
-            static size_t offsets[MaxMipLevels];
+            Color averageColor;
+            Assets::TextureBufferList buffers(MaxMipLevels);
+            size_t offsets[MaxMipLevels];
 
             const char version = reader.readChar<char>();
             ensure(version == 3, "Unknown WAL texture version");
@@ -129,7 +156,7 @@ namespace TrenchBroom {
         }
 
         bool WalTextureReader::readMips(const Assets::Palette& palette, const size_t mipLevels, const size_t offsets[], const size_t width, const size_t height, BufferedReader& reader, Assets::TextureBufferList& buffers, Color& averageColor, const Assets::PaletteTransparency transparency) {
-            static Color tempColor;
+            Color tempColor;
 
             auto hasTransparency = false;
             for (size_t i = 0; i < mipLevels; ++i) {
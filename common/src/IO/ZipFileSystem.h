@@ -23,6 +23,7 @@
 #include "IO/ImageFileSystem.h"
 
 #include <memory>
+#include <mutex>
 
 #include <miniz/miniz.h>
 
@@ -33,6 +34,10 @@ namespace TrenchBroom {
         class ZipFileSystem : public ImageFileSystem {
         private:
             mz_zip_archive m_archive;
+            /**
+             * Guards m_archive, which reads from a shared file handle, so that files can be opened concurrently.
+             */
+            std::mutex m_archiveMutex;
         private:
             class ZipCompressedFile : public FileEntry {
             private:
@@ -120,4 +120,19 @@ namespace TrenchBroom {
 
     void NullLogger::doLog(const LogLevel /* level */, const std::string& /* message */) {}
     void NullLogger::doLog(const LogLevel /* level */, const QString& /* message */) {}
+
+    void BufferingLogger::flush(Logger& logger) {
+        for (const auto& [level, message] : m_messages) {
+            logger.log(level, message);
+        }
+        m_messages.clear();
+    }
+
+    void BufferingLogger::doLog(const LogLevel level, const std::string& message) {
+        m_messages.emplace_back(level, message);
+    }
+
+    void BufferingLogger::doLog(const LogLevel level, const QString& message) {
+        m_messages.emplace_back(level, message.toStdString());
+    }
 }
@@ -22,6 +22,8 @@
 
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 class QString;
 
@@ -87,6 +89,24 @@ namespace TrenchBroom {
         void doLog(LogLevel level, const std::string& message) override;
         void doLog(LogLevel level, const QString& message) override;
     };
+
+    /**
+     * Keeps the logged messages until they are passed on to another logger. Tasks that run concurrently can each log
+     * to their own buffering logger, and the buffered messages can then be passed on in a deterministic order.
+     */
+    class BufferingLogger : public Logger {
+    private:
+        std::vector<std::pair<LogLevel, std::string>> m_messages;
+    public:
+        /**
+         * Passes all buffered messages on to the given logger in the order in which they were logged and clears the
+         * buffer.
+         */
+        void flush(Logger& logger);
+    private:
+        void doLog(LogLevel level, const std::string& message) override;
+        void doLog(LogLevel level, const QString& message) override;
+    };
 }
 
 #endif /* defined(TrenchBroom_Logger) */
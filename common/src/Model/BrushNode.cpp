@@ -58,6 +58,7 @@
 
 #include <algorithm> // for std::remove
 #include <iterator>
+#include <limits>
 #include <set>
 #include <string>
 #include <vector>
@@ -66,6 +67,59 @@ namespace TrenchBroom {
     namespace Model {
         const HitType::Type BrushNode::BrushHitType = HitType::freeType();
 
+        /**
+         * Caches the boundary polygon of each face projected onto the coordinate plane that is most perpendicular
+         * to the face's normal. Used to check whether a point on a face's plane lies within the face.
+         */
+        struct BrushNode::PickCache {
+            struct ProjectedFace {
+                vm::axis::type axis;
+                std::vector<vm::vec2> vertices;
+            };
+
+            std::vector<ProjectedFace> faces;
+        };
+
+        static vm::vec2 projectToAxisPlane(const vm::vec3& point, const vm::axis::type axis) {
+            switch (axis) {
+                case vm::axis::x:
+                    return vm::vec2(point.y(), point.z());
+                case vm::axis::y:
+                    return vm::vec2(point.z(), point.x());
+                default:
+                    return vm::vec2(point.x(), point.y());
+            }
+        }
+
+        static bool projectedPolygonContainsPoint(const std::vector<vm::vec2>& vertices, const vm::vec2& point) {
+            // The polygon is convex, so it contains the point iff the point is not on opposite sides of two edges.
+            // The projection may have flipped the winding order, so we don't care which side that is.
+            bool hasPointInFront = false;
+            bool hasPointBehind = false;
+
+            const auto epsilon = vm::C::almost_zero();
+            for (size_t i = 0u; i < vertices.size(); ++i) {
+                const auto& start = vertices[i];
+                const auto& end = vertices[(i + 1u) % vertices.size()];
+                const auto edge = end - start;
+                const auto toPoint = point - start;
+                const auto cross = edge.x() * toPoint.y() - edge.y() * toPoint.x();
+
+                // compare the squared distance of the point to the edge line against the squared epsilon
+                if (cross * cross > epsilon * epsilon * vm::squared_length(edge)) {
+                    if (cross > 0.0) {
+                        hasPointInFront = true;
+                    } else {
+                        hasPointBehind = true;
+                    }
+                    if (hasPointInFront && hasPointBehind) {
+                        return false;
+                    }
+                }
+            }
+            return true;
+        }
+
         BrushNode::BrushNode(Brush brush) :
         m_brushRendererBrushCache(std::make_unique<Renderer::BrushRendererBrushCache>()),
         m_brush(std::move(brush)) {
@@ -117,6 +171,7 @@ namespace TrenchBroom {
             updateSelectedFaceCount();
             invalidateIssues();
             invalidateVertexCache();
+            invalidatePickCache();
         }
 
         bool BrushNode::hasSelectedFaces() const {
@@ -220,18 +275,92 @@ namespace TrenchBroom {
         }
 
         std::optional<std::tuple<FloatType, size_t>> BrushNode::findFaceHit(const vm::ray3& ray) const {
-            if (!vm::is_nan(vm::intersect_ray_bbox(ray, logicalBounds()))) {
-                for (size_t i = 0u; i < m_brush.faceCount(); ++i) {
-                    const auto& face = m_brush.face(i);
-                    const auto distance = face.intersectWithRay(ray);
-                    if (!vm::is_nan(distance)) {
-                        return std::make_tuple(distance, i);
+            if (vm::is_nan(vm::intersect_ray_bbox(ray, logicalBounds()))) {
+                return std::nullopt;
+            }
+
+            // Clip the ray against the halfspaces bounded by the face planes (Cyrus-Beck). Since the brush is convex,
+            // the ray enters it through the front facing face whose plane yields the largest distance, and it misses
+            // the brush if it leaves any halfspace before entering all of them.
+            auto enterDistance = -std::numeric_limits<FloatType>::max();
+            auto exitDistance = std::numeric_limits<FloatType>::max();
+            auto enterFaceIndex = m_brush.faceCount();
+
+            for (size_t i = 0u; i < m_brush.faceCount(); ++i) {
+                const auto& boundary = m_brush.face(i).boundary();
+                const auto cos = vm::dot(boundary.normal, ray.direction);
+                const auto pointDistance = boundary.point_distance(ray.origin);
+
+                if (vm::is_zero(cos, vm::C::almost_zero())) {
+                    if (pointDistance > vm::C::almost_zero()) {
+                        // the ray runs parallel to the face plane and outside of the brush
+                        return std::nullopt;
+                    }
+                } else {
+                    const auto distance = -pointDistance / cos;
+                    if (cos < 0.0) {
+                        if (distance > enterDistance) {
+                            enterDistance = distance;
+                            enterFaceIndex = i;
+                        }
+                    } else if (distance < exitDistance) {
+                        exitDistance = distance;
+                    }
+
+                    if (enterDistance > exitDistance) {
+                        return std::nullopt;
                     }
                 }
             }
+
+            if (enterFaceIndex == m_brush.faceCount() || enterDistance < 0.0) {
+                // the ray origin is inside of the brush, so it cannot hit a front facing face
+                return std::nullopt;
+            }
+
+            const auto& projectedFace = pickCache().faces[enterFaceIndex];
+            const auto hitPoint = vm::point_at_distance(ray, enterDistance);
+            if (projectedPolygonContainsPoint(projectedFace.vertices, projectToAxisPlane(hitPoint, projectedFace.axis))) {
+                return std::make_tuple(enterDistance, enterFaceIndex);
+            }
+
+            // The ray grazes an edge or a vertex, or the face planes disagree with the vertices due to rounding errors.
+            return findFaceHitByPolygonIntersection(ray);
+        }
+
+        std::optional<std::tuple<FloatType, size_t>> BrushNode::findFaceHitByPolygonIntersection(const vm::ray3& ray) const {
+            for (size_t i = 0u; i < m_brush.faceCount(); ++i) {
+                const auto& face = m_brush.face(i);
+                const auto distance = face.intersectWithRay(ray);
+                if (!vm::is_nan(distance)) {
+                    return std::make_tuple(distance, i);
+                }
+            }
             return std::nullopt;
         }
 
+        const BrushNode::PickCache& BrushNode::pickCache() const {
+            if (m_pickCache == nullptr) {
+                auto pickCache = std::make_unique<PickCache>();
+                pickCache->faces.reserve(m_brush.faceCount());
+
+                for (const BrushFace& face : m_brush.faces()) {
+                    const auto axis = vm::find_abs_max_component(face.boundary().normal);
+                    auto vertices = kdl::vec_transform(face.vertexPositions(), [&](const vm::vec3& position) {
+                        return projectToAxisPlane(position, axis);
+                    });
+                    pickCache->faces.push_back(PickCache::ProjectedFace{axis, std::move(vertices)});
+                }
+
+                m_pickCache = std::move(pickCache);
+            }
+            return *m_pickCache;
+        }
+
+        void BrushNode::invalidatePickCache() {
+            m_pickCache.reset();
+        }
+
         Node* BrushNode::doGetContainer() const {
             FindContainerVisitor visitor;
             escalate(visitor);
@@ -260,6 +389,7 @@ namespace TrenchBroom {
                         m_brush = std::move(brush);
                         invalidateIssues();
                         invalidateVertexCache();
+                        invalidatePickCache();
 
                         return kdl::result<void, TransformError>::success();
                     },
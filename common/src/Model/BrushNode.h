@@ -64,6 +64,9 @@ namespace TrenchBroom {
             mutable std::unique_ptr<Renderer::BrushRendererBrushCache> m_brushRendererBrushCache; // unique_ptr for breaking header dependencies
             Brush m_brush; // must be destroyed before the brush renderer cache
             size_t m_selectedFaceCount = 0u;
+
+            struct PickCache;
+            mutable std::unique_ptr<PickCache> m_pickCache; // computed lazily on first pick, unique_ptr for breaking header dependencies
         public:
             explicit BrushNode(Brush brush);
             ~BrushNode() override;
@@ -110,6 +113,9 @@ namespace TrenchBroom {
             void doFindNodesContaining(const vm::vec3& point, std::vector<Node*>& result) override;
 
             std::optional<std::tuple<FloatType, size_t>> findFaceHit(const vm::ray3& ray) const;
+            std::optional<std::tuple<FloatType, size_t>> findFaceHitByPolygonIntersection(const vm::ray3& ray) const;
+            const PickCache& pickCache() const;
+            void invalidatePickCache();
 
             Node* doGetContainer() const override;
             LayerNode* doGetLayer() const override;
@@ -23,16 +23,20 @@
 #include "Exceptions.h"
 #include "Logger.h"
 #include "Macros.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
 #include "Assets/Palette.h"
 #include "Assets/EntityModel.h"
 #include "Assets/EntityDefinitionFileSpec.h"
 #include "IO/AseParser.h"
 #include "IO/BrushFaceReader.h"
 #include "IO/Bsp29Parser.h"
+#include "IO/DecodedTextureCache.h"
 #include "IO/DefParser.h"
 #include "IO/DiskIO.h"
 #include "IO/DkmParser.h"
 #include "IO/DiskFileSystem.h"
+#include "IO/EntityModelParser.h"
 #include "IO/EntParser.h"
 #include "IO/FgdParser.h"
 #include "IO/File.h"
@@ -47,6 +51,7 @@
 #include "IO/NodeWriter.h"
 #include "IO/ObjParser.h"
 #include "IO/ObjSerializer.h"
+#include "IO/Reader.h"
 #include "IO/WorldReader.h"
 #include "IO/SimpleParserStatus.h"
 #include "IO/SystemPaths.h"
@@ -69,19 +74,22 @@
 
 #include <vecmath/vec_io.h>
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Model {
         GameImpl::GameImpl(GameConfig& config, const IO::Path& gamePath, Logger& logger) :
         m_config(config),
+        m_fs(std::make_shared<GameFileSystem>()),
         m_gamePath(gamePath) {
             initializeFileSystem(logger);
         }
 
         void GameImpl::initializeFileSystem(Logger& logger) {
-            m_fs.initialize(m_config, m_gamePath, m_additionalSearchPaths, logger);
+            m_fs->initialize(m_config, m_gamePath, m_additionalSearchPaths, logger);
         }
 
         const std::string& GameImpl::doGameName() const {
@@ -248,7 +256,8 @@ namespace TrenchBroom {
             const auto paths = extractTextureCollections(node);
 
             const auto fileSearchPaths = textureCollectionSearchPaths(documentPath);
-            IO::TextureLoader textureLoader(m_fs, fileSearchPaths, m_config.textureConfig(), logger);
+            auto cache = std::make_shared<IO::DecodedTextureCache>(IO::SystemPaths::userDataDirectory() + IO::Path("Texture cache"));
+            IO::TextureLoader textureLoader(m_fs, fileSearchPaths, m_config.textureConfig(), logger, std::move(cache), pref(Preferences::TextureCompression));
             textureLoader.loadTextures(paths, textureManager);
         }
 
@@ -282,8 +291,8 @@ namespace TrenchBroom {
         std::vector<IO::Path> GameImpl::doFindTextureCollections() const {
             try {
                 const auto& searchPath = m_config.textureConfig().package.rootDirectory;
-                if (!searchPath.isEmpty() && m_fs.directoryExists(searchPath)) {
-                    return kdl::vec_concat(std::vector<IO::Path>({searchPath}), m_fs.findItemsRecursively(searchPath, IO::FileTypeMatcher(false, true)));
+                if (!searchPath.isEmpty() && m_fs->directoryExists(searchPath)) {
+                    return kdl::vec_concat(std::vector<IO::Path>({searchPath}), m_fs->findItemsRecursively(searchPath, IO::FileTypeMatcher(false, true)));
                 }
                 return std::vector<IO::Path>();
             } catch (FileSystemException& e) {
@@ -320,7 +329,7 @@ namespace TrenchBroom {
         }
 
         void GameImpl::doReloadShaders() {
-            m_fs.reloadShaders();
+            m_fs->reloadShaders();
         }
 
         bool GameImpl::doIsEntityDefinitionFile(const IO::Path& path) const {
@@ -409,54 +418,70 @@ namespace TrenchBroom {
             }
         }
 
+        /**
+         * Everything that the parsers of a model file need besides the contents of the file. Model sources are
+         * shared by the frame loaders of the models they created, which create a new parser for every frame. The
+         * source keeps the file system alive, so that no parser outlives the file system it loads skins from.
+         */
+        struct GameImpl::ModelSource {
+            std::shared_ptr<const IO::FileSystem> fs;
+            IO::Path path;
+            std::string format;
+            Assets::Palette palette;
+        };
+
+        std::shared_ptr<GameImpl::ModelSource> GameImpl::modelSource(const IO::Path& path) const {
+            const auto extension = kdl::str_to_lower(path.extension());
+            const auto format = extension == "obj" ? std::string("obj_neverball") : extension;
+            if (!kdl::vec_contains(m_config.entityConfig().modelFormats, format)) {
+                throw GameException("Unsupported model format '" + path.asString() + "'");
+            }
+
+            auto source = std::make_shared<ModelSource>();
+            source->fs = m_fs;
+            source->path = path;
+            source->format = format;
+            if (format == "mdl" || format == "md2" || format == "bsp") {
+                source->palette = loadTexturePalette();
+            }
+            return source;
+        }
+
+        std::unique_ptr<IO::EntityModelParser> GameImpl::createModelParser(const ModelSource& source, const char* begin, const char* end) {
+            const auto modelName = source.path.lastComponent().asString();
+            const auto& fs = *source.fs;
+
+            if (source.format == "mdl") {
+                return std::make_unique<IO::MdlParser>(modelName, begin, end, source.palette);
+            } else if (source.format == "md2") {
+                return std::make_unique<IO::Md2Parser>(modelName, begin, end, source.palette, fs);
+            } else if (source.format == "md3") {
+                return std::make_unique<IO::Md3Parser>(modelName, begin, end, fs);
+            } else if (source.format == "mdx") {
+                return std::make_unique<IO::MdxParser>(modelName, begin, end, fs);
+            } else if (source.format == "bsp") {
+                return std::make_unique<IO::Bsp29Parser>(modelName, begin, end, source.palette, fs);
+            } else if (source.format == "dkm") {
+                return std::make_unique<IO::DkmParser>(modelName, begin, end, fs);
+            } else if (source.format == "ase") {
+                return std::make_unique<IO::AseParser>(modelName, std::string_view(begin, static_cast<size_t>(end - begin)), fs);
+            } else if (source.format == "obj_neverball") {
+                // has to be the whole path for implicit textures!
+                return std::make_unique<IO::NvObjParser>(source.path, begin, end, fs);
+            } else {
+                throw GameException("Unsupported model format '" + source.path.asString() + "'");
+            }
+        }
+
         std::unique_ptr<Assets::EntityModel> GameImpl::doInitializeModel(const IO::Path& path, Logger& logger) const {
             try {
-                auto file = m_fs.openFile(path);
+                const auto source = modelSource(path);
+                auto file = m_fs->openFile(path);
                 ensure(file != nullptr, "file is null");
 
-                const auto modelName = path.lastComponent().asString();
-                const auto extension = kdl::str_to_lower(path.extension());
-                const auto supported = m_config.entityConfig().modelFormats;
-
-                if (extension == "mdl" && kdl::vec_contains(supported, "mdl")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::MdlParser parser(modelName, std::begin(reader), std::end(reader), palette);
-                    return parser.initializeModel(logger);
-                } else if (extension == "md2" && kdl::vec_contains(supported, "md2")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::Md2Parser parser(modelName, std::begin(reader), std::end(reader), palette, m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "md3" && kdl::vec_contains(supported, "md3")) {
-                    auto reader = file->reader().buffer();
-                    IO::Md3Parser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "mdx" && kdl::vec_contains(supported, "mdx")) {
-                    auto reader = file->reader().buffer();
-                    IO::MdxParser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "bsp" && kdl::vec_contains(supported, "bsp")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::Bsp29Parser parser(modelName, std::begin(reader), std::end(reader), palette, m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "dkm" && kdl::vec_contains(supported, "dkm")) {
-                    auto reader = file->reader().buffer();
-                    IO::DkmParser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "ase" && kdl::vec_contains(supported, "ase")) {
-                    auto reader = file->reader().buffer();
-                    IO::AseParser parser(modelName, reader.stringView(), m_fs);
-                    return parser.initializeModel(logger);
-                } else if (extension == "obj" && kdl::vec_contains(supported, "obj_neverball")) {
-                    auto reader = file->reader().buffer();
-                    // has to be the whole path for implicit textures!
-                    IO::NvObjParser parser(path, std::begin(reader), std::end(reader), m_fs);
-                    return parser.initializeModel(logger);
-                } else {
-                    throw GameException("Unsupported model format '" + path.asString() + "'");
-                }
+                return IO::initializeModel(std::move(file), [source](const char* begin, const char* end) {
+                    return createModelParser(*source, begin, end);
+                }, logger);
             } catch (const FileSystemException& e) {
                 throw GameException("Could not load model " + path.asString() + ": " + std::string(e.what()));
             } catch (const AssetException& e) {
@@ -471,51 +496,15 @@ namespace TrenchBroom {
                 ensure(model.frame(frameIndex) != nullptr, "invalid frame index");
                 ensure(!model.frame(frameIndex)->loaded(), "frame already loaded");
 
-                const auto file = m_fs.openFile(path);
-                ensure(file != nullptr, "file is null");
-
-                const auto modelName = path.lastComponent().asString();
-                const auto extension = kdl::str_to_lower(path.extension());
-                const auto supported = m_config.entityConfig().modelFormats;
-
-                if (extension == "mdl" && kdl::vec_contains(supported, "mdl")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::MdlParser parser(modelName, std::begin(reader), std::end(reader), palette);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "md2" && kdl::vec_contains(supported, "md2")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::Md2Parser parser(modelName, std::begin(reader), std::end(reader), palette, m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "md3" && kdl::vec_contains(supported, "md3")) {
-                    auto reader = file->reader().buffer();
-                    IO::Md3Parser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "mdx" && kdl::vec_contains(supported, "mdx")) {
-                    auto reader = file->reader().buffer();
-                    IO::MdxParser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "bsp" && kdl::vec_contains(supported, "bsp")) {
-                    const auto palette = loadTexturePalette();
-                    auto reader = file->reader().buffer();
-                    IO::Bsp29Parser parser(modelName, std::begin(reader), std::end(reader), palette, m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "dkm" && kdl::vec_contains(supported, "dkm")) {
-                    auto reader = file->reader().buffer();
-                    IO::DkmParser parser(modelName, std::begin(reader), std::end(reader), m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "ase" && kdl::vec_contains(supported, "ase")) {
-                    auto reader = file->reader().buffer();
-                    IO::AseParser parser(modelName, reader.stringView(), m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
-                } else if (extension == "obj" && kdl::vec_contains(supported, "obj_neverball")) {
-                    auto reader = file->reader().buffer();
-                    // has to be the whole path for implicit textures!
-                    IO::NvObjParser parser(path, std::begin(reader), std::end(reader), m_fs);
-                    parser.loadFrame(frameIndex, model, logger);
+                if (model.hasFrameLoader()) {
+                    model.loadFrame(frameIndex, logger);
                 } else {
-                    throw GameException("Unsupported model format '" + path.asString() + "'");
+                    const auto source = modelSource(path);
+                    const auto file = m_fs->openFile(path);
+                    ensure(file != nullptr, "file is null");
+
+                    const auto reader = file->reader().buffer();
+                    createModelParser(*source, std::begin(reader), std::end(reader))->loadFrame(frameIndex, model, logger);
                 }
             } catch (FileSystemException& e) {
                 throw GameException("Could not load model " + path.asString() + ": " + std::string(e.what()));
@@ -526,7 +515,7 @@ namespace TrenchBroom {
 
         Assets::Palette GameImpl::loadTexturePalette() const {
             const auto& path = m_config.textureConfig().palette;
-            return Assets::Palette::loadFile(m_fs, path);
+            return Assets::Palette::loadFile(*m_fs, path);
         }
 
         std::vector<std::string> GameImpl::doAvailableMods() const {
@@ -37,11 +37,16 @@ namespace TrenchBroom {
         class Palette;
     }
 
+    namespace IO {
+        class EntityModelParser;
+    }
+
     namespace Model {
         class GameImpl : public Game {
         private:
             GameConfig& m_config;
-            GameFileSystem m_fs;
+            // shared with the decoders of the loaded textures
+            std::shared_ptr<GameFileSystem> m_fs;
             IO::Path m_gamePath;
             std::vector<IO::Path> m_additionalSearchPaths;
         public:
@@ -97,6 +102,10 @@ namespace TrenchBroom {
             std::unique_ptr<Assets::EntityModel> doInitializeModel(const IO::Path& path, Logger& logger) const override;
             void doLoadFrame(const IO::Path& path, size_t frameIndex, Assets::EntityModel& model, Logger& logger) const override;
 
+            struct ModelSource;
+            std::shared_ptr<ModelSource> modelSource(const IO::Path& path) const;
+            static std::unique_ptr<IO::EntityModelParser> createModelParser(const ModelSource& source, const char* begin, const char* end);
+
             Assets::Palette loadTexturePalette() const;
 
             std::vector<std::string> doAvailableMods() const override;
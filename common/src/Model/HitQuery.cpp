@@ -138,6 +138,44 @@ namespace TrenchBroom {
             return Hit::NoHit;
         }
 
+        /**
+         * Indicates whether the result of first() cannot change anymore if only hits whose distances are at least the
+         * given distance are added to the underlying hits.
+         *
+         * first() considers the groups of hits at the same distance up to and including the first group that contains
+         * an occluder, so its result is final once such a group exists. A best match without error cannot be replaced
+         * either. In both cases, the group that decides the result must not be able to receive any further hits.
+         */
+        bool HitQuery::firstIsFinal(const FloatType minRemainingDistance) const {
+            auto it = m_hits->begin();
+            auto end = m_hits->end();
+
+            FloatType bestMatchError = std::numeric_limits<FloatType>::max();
+            while (it != end) {
+                if (!visible(*it)) {
+                    ++it;
+                    continue;
+                }
+
+                const FloatType distance = it->distance();
+                bool containsOccluder = false;
+                do {
+                    const Hit& hit = *it;
+                    if (m_include->matches(hit)) {
+                        bestMatchError = vm::min(bestMatchError, hit.error());
+                    } else if (!m_exclude->matches(hit)) {
+                        containsOccluder = true;
+                    }
+                    ++it;
+                } while (it != end && vm::is_equal(it->distance(), distance, vm::C::almost_zero()));
+
+                if (containsOccluder || bestMatchError == static_cast<FloatType>(0.0)) {
+                    return minRemainingDistance > distance + vm::C::almost_zero();
+                }
+            }
+            return false;
+        }
+
         std::vector<Hit> HitQuery::all() const {
             std::vector<Hit> result;
             for (const Hit& hit : *m_hits) {
@@ -56,6 +56,7 @@ namespace TrenchBroom {
 
             bool empty() const;
             const Hit& first() const;
+            bool firstIsFinal(FloatType minRemainingDistance) const;
             std::vector<Hit> all() const;
         private:
             bool visible(const Hit& hit) const;
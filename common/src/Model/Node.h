@@ -288,6 +288,15 @@ namespace TrenchBroom {
             LockState lockState() const;
             bool setLockState(LockState lockState);
         public: // picking
+            /**
+             * Adds the hits of the given ray with this node to the given pick result.
+             *
+             * This may be called concurrently for different nodes, see WorldNode::pick, but never concurrently for the
+             * same node.
+             *
+             * @param ray the pick ray
+             * @param result the pick result to add the hits to
+             */
             void pick(const vm::ray3& ray, PickResult& result);
             void findNodesContaining(const vm::vec3& point, std::vector<Node*>& result);
         public: // file position
@@ -542,6 +551,10 @@ namespace TrenchBroom {
 
             virtual bool doSelectable() const = 0;
 
+            /**
+             * Must be safe to call concurrently for different nodes. Caches that belong to this node only may be
+             * computed lazily, but any data shared with other nodes, such as entity model frames, must be synchronized.
+             */
             virtual void doPick(const vm::ray3& ray, PickResult& pickResult) = 0;
             virtual void doFindNodesContaining(const vm::vec3& point, std::vector<Node*>& result) = 0;
 
@@ -80,6 +80,12 @@ namespace TrenchBroom {
             m_hits.insert(pos, hit);
         }
 
+        void PickResult::merge(const PickResult& other) {
+            ensure(m_compare.get() != nullptr, "compare is null");
+            const auto mid = m_hits.insert(std::end(m_hits), std::begin(other.m_hits), std::end(other.m_hits));
+            std::inplace_merge(std::begin(m_hits), mid, std::end(m_hits), CompareWrapper(m_compare.get()));
+        }
+
         const std::vector<Hit>& PickResult::all() const {
             return m_hits;
         }
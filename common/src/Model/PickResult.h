@@ -56,6 +56,16 @@ namespace TrenchBroom {
 
             void addHit(const Hit& hit);
 
+            /**
+             * Adds all hits of the given pick result to this pick result. Both pick results must order their hits by
+             * the same criteria. Hits that compare equal keep their relative order, and the hits already contained in
+             * this pick result precede equal hits of the given pick result, just as if the given hits had been added
+             * one by one.
+             *
+             * @param other the pick result whose hits to add
+             */
+            void merge(const PickResult& other);
+
             const std::vector<Hit>& all() const;
             HitQuery query() const;
 
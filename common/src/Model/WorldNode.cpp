@@ -21,6 +21,7 @@
 
 #include "AABBTree.h"
 #include "Ensure.h"
+#include "Exceptions.h"
 #include "Model/AssortNodesVisitor.h"
 #include "Model/AttributableNodeIndex.h"
 #include "Model/BrushNode.h"
@@ -28,17 +29,22 @@
 #include "Model/CollectMatchingNodesVisitor.h"
 #include "Model/EntityNode.h"
 #include "Model/GroupNode.h"
+#include "Model/HitQuery.h"
 #include "Model/IssueGenerator.h"
 #include "Model/IssueGeneratorRegistry.h"
 #include "Model/LayerNode.h"
 #include "Model/ModelFactoryImpl.h"
+#include "Model/PickResult.h"
 #include "Model/TagVisitor.h"
 
+#include <kdl/parallel.h>
 #include <kdl/result.h>
 #include <kdl/vector_utils.h>
 
 #include <vecmath/bbox_io.h>
+#include <vecmath/vec.h>
 
+#include <algorithm>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -51,7 +57,8 @@ namespace TrenchBroom {
         m_attributableIndex(std::make_unique<AttributableNodeIndex>()),
         m_issueGeneratorRegistry(std::make_unique<IssueGeneratorRegistry>()),
         m_nodeTree(std::make_unique<NodeTree>()),
-        m_updateNodeTree(true) {
+        m_updateNodeTree(true),
+        m_deferNodeTreeUpdates(false) {
             addOrUpdateAttribute(AttributeNames::Classname, AttributeValues::WorldspawnClassname);
             createDefaultLayer();
         }
@@ -188,6 +195,48 @@ namespace TrenchBroom {
             m_nodeTree->clearAndBuild(collect.nodes(), [](const auto* node){ return node->physicalBounds(); });
         }
 
+        WorldNode::DeferNodeTreeUpdates::DeferNodeTreeUpdates(WorldNode& world) :
+        m_world(world) {
+            m_world.deferNodeTreeUpdates();
+        }
+
+        WorldNode::DeferNodeTreeUpdates::~DeferNodeTreeUpdates() {
+            m_world.applyDeferredNodeTreeUpdates();
+        }
+
+        void WorldNode::deferNodeTreeUpdates() {
+            assert(!m_deferNodeTreeUpdates);
+            m_deferNodeTreeUpdates = true;
+        }
+
+        void WorldNode::applyDeferredNodeTreeUpdates() {
+            m_deferNodeTreeUpdates = false;
+
+            // Nodes that were removed in the meantime are not contained in the tree anymore. The pointers to such nodes
+            // may dangle, but the tree only uses them as keys here without dereferencing them.
+            const auto nodes = kdl::vec_filter(std::move(m_deferredNodeTreeUpdates), [&](Node* node) { return m_nodeTree->contains(node); });
+            m_deferredNodeTreeUpdates.clear();
+
+            try {
+                m_nodeTree->batchUpdate(nodes, [](const Node* node) { return node->physicalBounds(); });
+            } catch (const NodeTreeException&) {
+                // this is called from a destructor and must not throw, so the tree is rebuilt instead, leaving out the
+                // nodes whose bounds are invalid
+                using CollectTreeNodes = CollectMatchingNodesVisitor<MatchTreeNodes>;
+
+                CollectTreeNodes collect;
+                acceptAndRecurse(collect);
+
+                m_nodeTree->clear();
+                for (auto* node : collect.nodes()) {
+                    const auto& bounds = node->physicalBounds();
+                    if (!vm::is_nan(bounds.min) && !vm::is_nan(bounds.max)) {
+                        m_nodeTree->insert(bounds, node);
+                    }
+                }
+            }
+        }
+
         class WorldNode::InvalidateAllIssuesVisitor : public NodeVisitor {
         private:
             void doVisit(WorldNode* world) override   { invalidateIssues(world);  }
@@ -199,6 +248,17 @@ namespace TrenchBroom {
             void invalidateIssues(Node* node) { node->invalidateIssues(); }
         };
 
+        void WorldNode::pickFirst(const vm::ray3& ray, PickResult& pickResult, const HitQuery& query) {
+            m_nodeTree->findIntersectorsInOrder(ray, [&](Node* node, const FloatType distance) {
+                // hits on a node cannot be closer than the point where the ray enters its bounds
+                if (query.firstIsFinal(distance)) {
+                    return false;
+                }
+                node->pick(ray, pickResult);
+                return true;
+            });
+        }
+
         void WorldNode::invalidateAllIssues() {
             InvalidateAllIssuesVisitor visitor;
             acceptAndRecurse(visitor);
@@ -301,8 +361,12 @@ namespace TrenchBroom {
 
         void WorldNode::doDescendantPhysicalBoundsDidChange(Node* node) {
             if (m_updateNodeTree) {
-                UpdateNodeInNodeTree visitor(*m_nodeTree);
-                node->accept(visitor);
+                if (m_deferNodeTreeUpdates) {
+                    m_deferredNodeTreeUpdates.push_back(node);
+                } else {
+                    UpdateNodeInNodeTree visitor(*m_nodeTree);
+                    node->accept(visitor);
+                }
             }
         }
 
@@ -310,9 +374,41 @@ namespace TrenchBroom {
             return false;
         }
 
+        /**
+         * The minimum number of candidates that are picked by one task. Picking a brush only takes a few microseconds,
+         * so it doesn't pay to run a task for fewer candidates.
+         */
+        static const size_t MinParallelPickCandidates = 64u;
+
         void WorldNode::doPick(const vm::ray3& ray, PickResult& pickResult) {
-            for (auto* node : m_nodeTree->findIntersectors(ray)) {
-                node->pick(ray, pickResult);
+            const auto candidates = m_nodeTree->findIntersectors(ray);
+            if (candidates.size() < MinParallelPickCandidates) {
+                for (auto* node : candidates) {
+                    node->pick(ray, pickResult);
+                }
+                return;
+            }
+
+            // Every task picks a contiguous range of candidates into its own pick result, which orders its hits like
+            // the given pick result. Merging the task results in the order of their ranges yields the same order of hits
+            // as picking all candidates sequentially. The tasks run on the threads of kdl's default thread pool, so no
+            // threads are started per pick. Every candidate is contained in the node tree once, so no node is picked by
+            // more than one task, see Node::doPick.
+            auto emptyResult = pickResult;
+            emptyResult.clear();
+
+            const auto taskCount = std::min(candidates.size() / MinParallelPickCandidates, 4u * kdl::hardware_thread_count());
+            std::vector<PickResult> taskResults(taskCount, emptyResult);
+            kdl::parallel_for(taskCount, [&](const size_t task) {
+                const auto first = task * candidates.size() / taskCount;
+                const auto last = (task + 1u) * candidates.size() / taskCount;
+                for (size_t i = first; i < last; ++i) {
+                    candidates[i]->pick(ray, taskResults[task]);
+                }
+            });
+
+            for (const auto& taskResult : taskResults) {
+                pickResult.merge(taskResult);
             }
         }
 
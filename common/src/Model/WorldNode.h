@@ -40,6 +40,7 @@ namespace TrenchBroom {
         class AttributableNodeIndex;
         enum class BrushError;
         class BrushFace;
+        class HitQuery;
         class IssueGeneratorRegistry;
         class IssueQuickFix;
         class PickResult;
@@ -54,6 +55,8 @@ namespace TrenchBroom {
             using NodeTree = AABBTree<FloatType, 3, Node*>;
             std::unique_ptr<NodeTree> m_nodeTree;
             bool m_updateNodeTree;
+            bool m_deferNodeTreeUpdates;
+            std::vector<Node*> m_deferredNodeTreeUpdates;
         public:
             WorldNode(MapFormat mapFormat);
             ~WorldNode() override;
@@ -94,6 +97,34 @@ namespace TrenchBroom {
             void disableNodeTreeUpdates();
             void enableNodeTreeUpdates();
             void rebuildNodeTree();
+
+            /**
+             * While an instance of this class exists, the given world collects the nodes whose physical bounds change
+             * instead of updating them in the node tree one by one. The collected nodes are updated in one batch when
+             * the instance is destroyed, which is much cheaper if many nodes are transformed at once. Nodes that are
+             * removed from the world in the meantime are skipped.
+             *
+             * The updates are also applied if an exception is thrown, so the node tree never stays out of date.
+             */
+            class DeferNodeTreeUpdates {
+            private:
+                WorldNode& m_world;
+            public:
+                explicit DeferNodeTreeUpdates(WorldNode& world);
+                ~DeferNodeTreeUpdates();
+
+                deleteCopyAndMove(DeferNodeTreeUpdates)
+            };
+        private:
+            void deferNodeTreeUpdates();
+            void applyDeferredNodeTreeUpdates();
+        public: // picking
+            /**
+             * Picks the nodes hit by the given ray in the order of their distances and stops as soon as the result of
+             * the given query's first() cannot change anymore. The query must have been created from the given pick
+             * result, which must order its hits by distance.
+             */
+            void pickFirst(const vm::ray3& ray, PickResult& pickResult, const HitQuery& query);
         private:
             class InvalidateAllIssuesVisitor;
             void invalidateAllIssues();
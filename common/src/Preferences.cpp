@@ -126,10 +126,14 @@ namespace TrenchBroom {
 
         Preference<float> Brightness(IO::Path("Renderer/Brightness"), 1.4f);
         Preference<float> GridAlpha(IO::Path("Renderer/Grid/Alpha"), 0.5f);
+        Preference<float> DetailCullingPixelSize(IO::Path("Renderer/Detail culling pixel size"), 2.0f);
         Preference<Color> GridColor2D(IO::Path("Rendere/Grid/Color2D"), Color(0.8f, 0.8f, 0.8f, 0.8f));
 
         Preference<int> TextureMinFilter(IO::Path("Renderer/Texture mode min filter"), 0x2700);
         Preference<int> TextureMagFilter(IO::Path("Renderer/Texture mode mag filter"), 0x2600);
+        // in megabytes, 0 disables evicting unused textures
+        Preference<int> TextureMemoryBudget(IO::Path("Renderer/Texture memory budget"), 1024);
+        Preference<bool> TextureCompression(IO::Path("Renderer/Texture compression"), false);
 
         Preference<bool> TextureLock(IO::Path("Editor/Texture lock"), true);
         Preference<bool> UVLock(IO::Path("Editor/UV lock"), false);
@@ -290,9 +294,12 @@ namespace TrenchBroom {
                 &TextureSeamColor,
                 &Brightness,
                 &GridAlpha,
+                &DetailCullingPixelSize,
                 &GridColor2D,
                 &TextureMinFilter,
                 &TextureMagFilter,
+                &TextureMemoryBudget,
+                &TextureCompression,
                 &TextureLock,
                 &UVLock,
                 &RendererFontPath(),
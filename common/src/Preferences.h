@@ -120,10 +120,13 @@ namespace TrenchBroom {
 
         extern Preference<float> Brightness;
         extern Preference<float> GridAlpha;
+        extern Preference<float> DetailCullingPixelSize;
         extern Preference<Color> GridColor2D;
 
         extern Preference<int> TextureMinFilter;
         extern Preference<int> TextureMagFilter;
+        extern Preference<int> TextureMemoryBudget;
+        extern Preference<bool> TextureCompression;
 
         extern Preference<bool> TextureLock;
         extern Preference<bool> UVLock;
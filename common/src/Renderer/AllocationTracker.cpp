@@ -169,6 +169,8 @@ namespace TrenchBroom {
             block->nextOfSameSize = nullptr;
             block->prevOfSameSize = nullptr;
 
+            m_usedSize += needed;
+
             if (block->size == needed) {
                 // lucky case: exact size. we're done
                 block->free = false;
@@ -217,6 +219,9 @@ namespace TrenchBroom {
             assert(block->prevOfSameSize == nullptr);
             assert(block->nextOfSameSize == nullptr);
 
+            assert(m_usedSize >= block->size);
+            m_usedSize -= block->size;
+
             Block* left = block->left;
             Block* right = block->right;
 
@@ -314,6 +319,7 @@ namespace TrenchBroom {
 
         AllocationTracker::AllocationTracker(const Index initial_capacity)
                 : m_capacity(0),
+                  m_usedSize(0),
                   m_leftmostBlock(nullptr),
                   m_rightmostBlock(nullptr),
                   m_recycledBlockList(nullptr) {
@@ -325,6 +331,7 @@ namespace TrenchBroom {
 
         AllocationTracker::AllocationTracker()
                 : m_capacity(0),
+                  m_usedSize(0),
                   m_leftmostBlock(nullptr),
                   m_rightmostBlock(nullptr),
                   m_recycledBlockList(nullptr) {}
@@ -411,6 +418,109 @@ namespace TrenchBroom {
             checkInvariants();
         }
 
+        size_t AllocationTracker::usedSize() const {
+            return static_cast<size_t>(m_usedSize);
+        }
+
+        std::vector<AllocationTracker::Move> AllocationTracker::compact(const Index maxMoveSize) {
+            checkInvariants();
+
+            Block* gap = m_leftmostBlock;
+            while (gap != nullptr && !gap->free) {
+                gap = gap->right;
+            }
+
+            std::vector<Move> result;
+            Index movedSize = 0;
+            while (gap != nullptr && gap->right != nullptr && movedSize < maxMoveSize) {
+                // adjacent free blocks are always merged, so the block to the right of the gap is used
+                Block* used = gap->right;
+                assert(!used->free);
+
+                unlinkFromBinList(gap);
+
+                result.push_back(Move{used, used->pos});
+                movedSize += used->size;
+
+                // swap the gap and the used block
+                used->pos = gap->pos;
+                gap->pos = used->pos + used->size;
+
+                Block* left = gap->left;
+                Block* right = used->right;
+
+                used->left = left;
+                if (left != nullptr) {
+                    left->right = used;
+                } else {
+                    m_leftmostBlock = used;
+                }
+                used->right = gap;
+                gap->left = used;
+                gap->right = right;
+                if (right != nullptr) {
+                    right->left = gap;
+                } else {
+                    m_rightmostBlock = gap;
+                }
+
+                // merge the gap with the next free block
+                if (right != nullptr && right->free) {
+                    unlinkFromBinList(right);
+
+                    gap->size += right->size;
+                    gap->right = right->right;
+                    if (gap->right != nullptr) {
+                        gap->right->left = gap;
+                    } else {
+                        m_rightmostBlock = gap;
+                    }
+
+                    recycle(right);
+                }
+
+                linkToBinList(gap);
+            }
+
+            checkInvariants();
+            return result;
+        }
+
+        bool AllocationTracker::compacted() const {
+            return m_rightmostBlock == nullptr || m_usedSize == (m_rightmostBlock->free ? m_rightmostBlock->pos : m_capacity);
+        }
+
+        void AllocationTracker::shrink(const Index newCapacity) {
+            checkInvariants();
+
+            if (newCapacity == m_capacity) {
+                return;
+            }
+
+            Block* lastBlock = m_rightmostBlock;
+            if (newCapacity > m_capacity || lastBlock == nullptr || !lastBlock->free || newCapacity < lastBlock->pos) {
+                throw std::invalid_argument("shrink() can only remove free space at the end");
+            }
+
+            unlinkFromBinList(lastBlock);
+            if (newCapacity > lastBlock->pos) {
+                lastBlock->size = newCapacity - lastBlock->pos;
+                linkToBinList(lastBlock);
+            } else {
+                m_rightmostBlock = lastBlock->left;
+                if (m_rightmostBlock != nullptr) {
+                    m_rightmostBlock->right = nullptr;
+                } else {
+                    m_leftmostBlock = nullptr;
+                }
+                recycle(lastBlock);
+            }
+
+            m_capacity = newCapacity;
+
+            checkInvariants();
+        }
+
         bool AllocationTracker::hasAllocations() const {
             // NOTE: this loop should execute at most 2 iterations, because adjacent free blocks are always merged
             for (Block* block = m_leftmostBlock; block != nullptr; block = block->right) {
@@ -469,9 +579,13 @@ namespace TrenchBroom {
 
             // check the left/right pointers, size, pos
             size_t totalSize = 0;
+            size_t usedSize = 0;
             for (Block* block = m_leftmostBlock; block != nullptr; block = block->right) {
                 assert(block->size != 0);
                 totalSize += block->size;
+                if (!block->free) {
+                    usedSize += block->size;
+                }
 
                 if (block->right != nullptr) {
                     assert(block->right->left == block);
@@ -488,6 +602,7 @@ namespace TrenchBroom {
                 }
             }
             assert(m_capacity == totalSize);
+            assert(m_usedSize == usedSize);
 
             // check the size map
             for (const auto& headBlock : m_freeBlockSizeBins) {
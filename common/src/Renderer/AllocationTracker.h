@@ -63,6 +63,14 @@ namespace TrenchBroom {
                 Block* nextRecycledBlock;
             };
 
+            /**
+             * Records that compact() moved a used block from the given old position to its current position.
+             */
+            struct Move {
+                Block* block;
+                Index oldPos;
+            };
+
         private:
             /**
              * Size of memory managed by this AllocationTracker.
@@ -70,6 +78,11 @@ namespace TrenchBroom {
              */
             Index m_capacity;
 
+            /**
+             * The sum of `size` of all used Blocks.
+             */
+            Index m_usedSize;
+
             /**
              * Points to the Block with pos 0. Used to free all of the blocks in the destructor
              */
@@ -119,7 +132,31 @@ namespace TrenchBroom {
             Block* allocate(size_t size);
             void free(Block* block);
             size_t capacity() const;
+            size_t usedSize() const;
             void expand(Index newCapacity);
+
+            /**
+             * Closes the free gaps between used blocks by moving used blocks to the left, starting with the leftmost
+             * gap. Stops once the moved blocks have a total size of at least `maxMoveSize` or no gaps remain.
+             *
+             * Moved blocks keep their identity, only their `pos` changes, so the Block pointers held by callers remain
+             * valid. The caller must move the contents of each moved block from its old position to its new position,
+             * in the order of the returned moves.
+             *
+             * @return the moves that were made, ordered from left to right
+             */
+            std::vector<Move> compact(Index maxMoveSize);
+
+            /**
+             * @return true if there are no free gaps between used blocks, i.e. all free space is at the end.
+             */
+            bool compacted() const;
+
+            /**
+             * Reduces the capacity by removing free space at the end. The new capacity must not be less than the end
+             * of the rightmost used block.
+             */
+            void shrink(Index newCapacity);
             /**
              * @return whether there are any allocations. i.e. returns false iff the whole range managed by the allocation
              * tracker is free. Returns false if `capacity() == 0`. Constant time.
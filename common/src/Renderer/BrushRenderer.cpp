@@ -29,14 +29,35 @@
 #include "Model/TagAttribute.h"
 #include "Renderer/BrushRendererArrays.h"
 #include "Renderer/BrushRendererBrushCache.h"
+#include "Renderer/Camera.h"
 #include "Renderer/RenderContext.h"
+#include "Renderer/RenderUtils.h"
 
+#include <kdl/parallel.h>
+
+#include <algorithm>
 #include <cassert>
+#include <chrono>
+#include <cmath>
 #include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Renderer {
+        const float BrushRenderer::ChunkSize = 1024.0f;
+
+        BrushRenderer::Chunk::Chunk() :
+        bounds(vm::vec3f::zero(), vm::vec3f::zero()),
+        maxBrushSize(0.0f),
+        brushCount(0u),
+        detailCulled(false),
+        edgeIndices(std::make_shared<BrushIndexArray>()),
+        transparentFaces(std::make_shared<TextureToBrushIndicesMap>()),
+        opaqueFaces(std::make_shared<TextureToBrushIndicesMap>()) {}
+
         // Filter
 
         BrushRenderer::Filter::Filter() {}
@@ -133,7 +154,8 @@ namespace TrenchBroom {
         m_showOccludedEdges(false),
         m_forceTransparent(false),
         m_transparencyAlpha(1.0f),
-        m_showHiddenBrushes(false) {
+        m_showHiddenBrushes(false),
+        m_mergeCount(0) {
             clear();
         }
 
@@ -172,8 +194,10 @@ namespace TrenchBroom {
             m_invalidBrushes = m_allBrushes;
 
             assert(m_brushInfo.empty());
-            assert(m_transparentFaces->empty());
-            assert(m_opaqueFaces->empty());
+            assert(m_chunks.empty());
+
+            m_opaqueFaces = MergedFaces();
+            m_transparentFaces = MergedFaces();
         }
 
         void BrushRenderer::invalidateBrushes(const std::vector<Model::BrushNode*>& brushes) {
@@ -197,21 +221,25 @@ namespace TrenchBroom {
 
         void BrushRenderer::clear() {
             m_brushInfo.clear();
+            m_vertexBlockToBrush.clear();
             m_allBrushes.clear();
             m_invalidBrushes.clear();
 
             m_vertexArray = std::make_shared<BrushVertexArray>();
-            m_edgeIndices = std::make_shared<BrushIndexArray>();
-            m_transparentFaces = std::make_shared<TextureToBrushIndicesMap>();
-            m_opaqueFaces = std::make_shared<TextureToBrushIndicesMap>();
+            m_chunks.clear();
 
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            m_opaqueFaces = MergedFaces();
+            m_transparentFaces = MergedFaces();
         }
 
         void BrushRenderer::setFaceColor(const Color& faceColor) {
-            m_faceColor = faceColor;
+            if (faceColor != m_faceColor) {
+                m_faceColor = faceColor;
+
+                // the face renderers are recreated with the new color
+                m_opaqueFaces = MergedFaces();
+                m_transparentFaces = MergedFaces();
+            }
         }
 
         void BrushRenderer::setShowEdges(const bool showEdges) {
@@ -273,11 +301,14 @@ namespace TrenchBroom {
                 if (!valid()) {
                     validate();
                 }
+                compact();
+
+                const auto chunks = visibleChunks(renderContext);
                 if (renderContext.showFaces()) {
-                    renderOpaqueFaces(renderBatch);
+                    renderOpaqueFaces(chunks, renderBatch);
                 }
                 if (renderContext.showEdges() || m_showEdges) {
-                    renderEdges(renderBatch);
+                    renderEdges(chunks, renderBatch);
                 }
             }
         }
@@ -288,31 +319,152 @@ namespace TrenchBroom {
                     validate();
                 }
                 if (renderContext.showFaces()) {
-                    renderTransparentFaces(renderBatch);
+                    renderTransparentFaces(visibleChunks(renderContext), renderBatch);
+                }
+            }
+        }
+
+        std::vector<BrushRenderer::Chunk*> BrushRenderer::visibleChunks(const RenderContext& renderContext) {
+            const auto& camera = renderContext.camera();
+
+            // the same renderer is used by the 3D view and the 2D views, and only the 3D view culls detail, so the
+            // 2D views must not reset the state that the 3D view keeps between frames
+            const auto perspective = camera.perspectiveProjection();
+            const auto threshold = pref(Preferences::DetailCullingPixelSize);
+
+            std::vector<Chunk*> result;
+            result.reserve(m_chunks.size());
+            for (auto& [key, chunk] : m_chunks) {
+                if (perspective && std::get<3>(key) != SelectedSizeClass) {
+                    chunk.detailCulled = cullDetail(chunk.detailCulled, camera, chunk.bounds, chunk.maxBrushSize, threshold);
+                }
+                if ((!perspective || !chunk.detailCulled) && camera.intersectsFrustum(chunk.bounds)) {
+                    result.push_back(&chunk);
+                }
+            }
+            return result;
+        }
+
+        static std::shared_ptr<BrushIndexArray> mergeIndices(const std::vector<std::pair<const BrushIndexArray*, size_t>>& sources, std::unordered_map<const BrushIndexArray*, IndexRange>& ranges) {
+            auto indexCount = size_t(0);
+            for (const auto& [indices, revision] : sources) {
+                indexCount += indices->usedIndexCount();
+            }
+
+            auto result = std::make_shared<BrushIndexArray>();
+            auto [block, dest] = result->getPointerToInsertElementsAt(indexCount);
+
+            auto offset = block->pos;
+            for (const auto& [indices, revision] : sources) {
+                const auto count = indices->usedIndexCount();
+                dest = indices->copyUsedIndices(dest);
+                ranges.emplace(indices, IndexRange{offset, count});
+                offset += count;
+            }
+            return result;
+        }
+
+        bool BrushRenderer::mergeFaces(MergedFaces& mergedFaces, const bool transparent) {
+            auto sources = std::unordered_map<const Assets::Texture*, MergedFaces::Sources>();
+            for (const auto& [key, chunk] : m_chunks) {
+                const auto& faces = transparent ? *chunk.transparentFaces : *chunk.opaqueFaces;
+                for (const auto& [texture, indices] : faces) {
+                    if (indices->hasValidIndices()) {
+                        sources[texture].emplace_back(indices.get(), indices->revision());
+                    }
                 }
             }
+
+            if (mergedFaces.indices != nullptr && sources == mergedFaces.sources) {
+                return false;
+            }
+
+            // only the textures whose sources changed are merged again
+            auto indices = std::make_shared<TextureToBrushIndicesMap>();
+            auto ranges = std::unordered_map<const Assets::Texture*, MergedFaces::Ranges>();
+            for (const auto& [texture, textureSources] : sources) {
+                const auto it = mergedFaces.sources.find(texture);
+                if (it != std::end(mergedFaces.sources) && it->second == textureSources) {
+                    indices->emplace(texture, mergedFaces.indices->at(texture));
+                    ranges.emplace(texture, std::move(mergedFaces.ranges.at(texture)));
+                } else {
+                    indices->emplace(texture, mergeIndices(textureSources, ranges[texture]));
+                    ++m_mergeCount;
+                }
+            }
+
+            mergedFaces.sources = std::move(sources);
+            mergedFaces.ranges = std::move(ranges);
+            mergedFaces.indices = std::move(indices);
+            return true;
         }
 
-        void BrushRenderer::renderOpaqueFaces(RenderBatch& renderBatch) {
-            m_opaqueFaceRenderer.setGrayscale(m_grayscale);
-            m_opaqueFaceRenderer.setTint(m_tint);
-            m_opaqueFaceRenderer.setTintColor(m_tintColor);
-            m_opaqueFaceRenderer.render(renderBatch);
+        FaceRenderer::TextureToIndexRangesMap BrushRenderer::visibleIndexRanges(const MergedFaces& mergedFaces, const std::vector<Chunk*>& chunks, const bool transparent) const {
+            auto result = FaceRenderer::TextureToIndexRangesMap();
+            for (const auto* chunk : chunks) {
+                const auto& faces = transparent ? *chunk->transparentFaces : *chunk->opaqueFaces;
+                for (const auto& [texture, indices] : faces) {
+                    if (indices->hasValidIndices()) {
+                        const auto& range = mergedFaces.ranges.at(texture).at(indices.get());
+                        auto& textureRanges = result[texture];
+
+                        // the chunks are merged in the same order, so the ranges of neighboring chunks can be joined
+                        if (!textureRanges.empty() && textureRanges.back().offset + textureRanges.back().count == range.offset) {
+                            textureRanges.back().count += range.count;
+                        } else {
+                            textureRanges.push_back(range);
+                        }
+                    }
+                }
+            }
+            return result;
         }
 
-        void BrushRenderer::renderTransparentFaces(RenderBatch& renderBatch) {
-            m_transparentFaceRenderer.setGrayscale(m_grayscale);
-            m_transparentFaceRenderer.setTint(m_tint);
-            m_transparentFaceRenderer.setTintColor(m_tintColor);
-            m_transparentFaceRenderer.setAlpha(m_transparencyAlpha);
-            m_transparentFaceRenderer.render(renderBatch);
+        void BrushRenderer::renderOpaqueFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            if (mergeFaces(m_opaqueFaces, false)) {
+                m_opaqueFaces.renderer = FaceRenderer(m_vertexArray, m_opaqueFaces.indices, m_faceColor);
+            }
+
+            auto indexRanges = visibleIndexRanges(m_opaqueFaces, chunks, false);
+            if (!indexRanges.empty()) {
+                m_opaqueFaces.renderer.setIndexRanges(std::move(indexRanges));
+                m_opaqueFaces.renderer.setGrayscale(m_grayscale);
+                m_opaqueFaces.renderer.setTint(m_tint);
+                m_opaqueFaces.renderer.setTintColor(m_tintColor);
+                m_opaqueFaces.renderer.render(renderBatch);
+            }
         }
 
-        void BrushRenderer::renderEdges(RenderBatch& renderBatch) {
+        void BrushRenderer::renderTransparentFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            if (mergeFaces(m_transparentFaces, true)) {
+                m_transparentFaces.renderer = FaceRenderer(m_vertexArray, m_transparentFaces.indices, m_faceColor);
+            }
+
+            auto indexRanges = visibleIndexRanges(m_transparentFaces, chunks, true);
+            if (!indexRanges.empty()) {
+                m_transparentFaces.renderer.setIndexRanges(std::move(indexRanges));
+                m_transparentFaces.renderer.setGrayscale(m_grayscale);
+                m_transparentFaces.renderer.setTint(m_tint);
+                m_transparentFaces.renderer.setTintColor(m_tintColor);
+                m_transparentFaces.renderer.setAlpha(m_transparencyAlpha);
+                m_transparentFaces.renderer.render(renderBatch);
+            }
+        }
+
+        void BrushRenderer::renderEdges(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch) {
+            // render all occluded edges first so that the order of the render batch is the same as without chunks
             if (m_showOccludedEdges) {
-                m_edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
+                for (auto* chunk : chunks) {
+                    if (chunk->edgeIndices->hasValidIndices()) {
+                        chunk->edgeRenderer.renderOnTop(renderBatch, m_occludedEdgeColor);
+                    }
+                }
+            }
+            for (auto* chunk : chunks) {
+                if (chunk->edgeIndices->hasValidIndices()) {
+                    chunk->edgeRenderer.render(renderBatch, m_edgeColor);
+                }
             }
-            m_edgeRenderer.render(renderBatch, m_edgeColor);
         }
 
         class BrushRenderer::FilterWrapper : public BrushRenderer::Filter {
@@ -338,18 +490,85 @@ namespace TrenchBroom {
             }
         };
 
+        static const size_t MinBrushesPerValidationThread = 32u;
+
         void BrushRenderer::validate() {
             assert(!valid());
 
+            // Generating the cached vertices of a brush only touches that brush, so the vertex caches of all invalid
+            // brushes are validated concurrently. Allocating and copying into the vertex and index arrays remains here.
+            const auto invalidBrushes = std::vector<const Model::BrushNode*>(std::begin(m_invalidBrushes), std::end(m_invalidBrushes));
+            const auto threadCount = std::min(invalidBrushes.size() / MinBrushesPerValidationThread, kdl::hardware_thread_count());
+            kdl::parallel_for(invalidBrushes.size(), [&](const size_t i) {
+                const auto* brush = invalidBrushes[i];
+                brush->brushRendererBrushCache().validateVertexCache(brush);
+            }, threadCount);
+
             for (auto brush : m_invalidBrushes) {
                 validateBrush(brush);
             }
             m_invalidBrushes.clear();
             assert(valid());
 
-            m_opaqueFaceRenderer = FaceRenderer(m_vertexArray, m_opaqueFaces, m_faceColor);
-            m_transparentFaceRenderer = FaceRenderer(m_vertexArray, m_transparentFaces, m_faceColor);
-            m_edgeRenderer = IndexedEdgeRenderer(m_vertexArray, m_edgeIndices);
+            for (auto& [key, chunk] : m_chunks) {
+                chunk.edgeRenderer = IndexedEdgeRenderer(m_vertexArray, chunk.edgeIndices);
+            }
+        }
+
+        size_t BrushRenderer::mergeCount() const {
+            return m_mergeCount;
+        }
+
+        /**
+         * The time that may be spent compacting the arrays per frame, and the number of elements moved between checks
+         * of the elapsed time.
+         */
+        static const auto CompactionTimeBudget = std::chrono::milliseconds(1);
+        static const size_t CompactionStepSize = 16384u;
+
+        void BrushRenderer::compact() {
+            const auto deadline = std::chrono::steady_clock::now() + CompactionTimeBudget;
+            const auto withinBudget = [&]() { return std::chrono::steady_clock::now() < deadline; };
+
+            while (m_vertexArray->needsCompaction() && withinBudget()) {
+                for (const auto& move : m_vertexArray->compact(CompactionStepSize)) {
+                    const auto* brush = m_vertexBlockToBrush.at(move.block);
+                    const auto& info = m_brushInfo.at(brush);
+                    auto& chunk = m_chunks.at(info.chunkKey);
+
+                    const auto oldBase = static_cast<GLuint>(move.oldPos);
+                    const auto newBase = static_cast<GLuint>(move.block->pos);
+                    if (info.edgeIndicesKey != nullptr) {
+                        chunk.edgeIndices->rebaseElementsWithKey(info.edgeIndicesKey, oldBase, newBase);
+                    }
+                    for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
+                        chunk.opaqueFaces->at(texture)->rebaseElementsWithKey(opaqueKey, oldBase, newBase);
+                    }
+                    for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
+                        chunk.transparentFaces->at(texture)->rebaseElementsWithKey(transparentKey, oldBase, newBase);
+                    }
+                }
+            }
+
+            const auto compactIndices = [&](BrushIndexArray& indices) {
+                while (indices.needsCompaction() && withinBudget()) {
+                    indices.compact(CompactionStepSize);
+                }
+            };
+
+            for (auto& [key, chunk] : m_chunks) {
+                if (!withinBudget()) {
+                    break;
+                }
+
+                compactIndices(*chunk.edgeIndices);
+                for (auto& [texture, indices] : *chunk.opaqueFaces) {
+                    compactIndices(*indices);
+                }
+                for (auto& [texture, indices] : *chunk.transparentFaces) {
+                    compactIndices(*indices);
+                }
+            }
         }
 
         static size_t triIndicesCountForPolygon(const size_t vertexCount) {
@@ -456,6 +675,8 @@ namespace TrenchBroom {
             }
 
             BrushInfo& info = m_brushInfo[brush];
+            auto& [chunkKey, chunk] = *addBrushToChunk(brush);
+            info.chunkKey = chunkKey;
 
             // collect vertices
             auto& brushCache = brush->brushRendererBrushCache();
@@ -467,6 +688,7 @@ namespace TrenchBroom {
             auto [vertBlock, dest] = m_vertexArray->getPointerToInsertVerticesAt(cachedVertices.size());
             std::memcpy(dest, cachedVertices.data(), cachedVertices.size() * sizeof(*dest));
             info.vertexHolderKey = vertBlock;
+            m_vertexBlockToBrush.emplace(vertBlock, brush);
 
             const auto brushVerticesStartIndex = static_cast<GLuint>(vertBlock->pos);
 
@@ -474,7 +696,7 @@ namespace TrenchBroom {
             {
                 const size_t edgeIndexCount = countMarkedEdgeIndices(brush, edgePolicy);
                 if (edgeIndexCount > 0) {
-                    auto [key, insertDest] = m_edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
+                    auto [key, insertDest] = chunk.edgeIndices->getPointerToInsertElementsAt(edgeIndexCount);
                     info.edgeIndicesKey = key;
                     getMarkedEdgeIndices(brush, edgePolicy, brushVerticesStartIndex, insertDest);
                 } else {
@@ -514,7 +736,7 @@ namespace TrenchBroom {
                 }
 
                 if (transparentIndexCount > 0) {
-                    TextureToBrushIndicesMap& faceVboMap = *m_transparentFaces;
+                    TextureToBrushIndicesMap& faceVboMap = *chunk.transparentFaces;
                     auto& holderPtr = faceVboMap[texture];
                     if (holderPtr == nullptr) {
                         // inserts into map!
@@ -541,7 +763,7 @@ namespace TrenchBroom {
                 }
 
                 if (opaqueIndexCount > 0) {
-                    TextureToBrushIndicesMap& faceVboMap = *m_opaqueFaces;
+                    TextureToBrushIndicesMap& faceVboMap = *chunk.opaqueFaces;
                     auto& holderPtr = faceVboMap[texture];
                     if (holderPtr == nullptr) {
                         // inserts into map!
@@ -569,6 +791,58 @@ namespace TrenchBroom {
             }
         }
 
+        /**
+         * Brushes of up to this size are in the smallest size class, and every further size class contains brushes
+         * that are up to SizeClassFactor times larger, except for the last one, which contains all larger brushes.
+         */
+        static const float SmallestSizeClassSize = 16.0f;
+        static const float SizeClassFactor = 8.0f;
+        static const int SizeClassCount = 3;
+
+        /**
+         * Selected brushes and brushes with selected faces are put into chunks of this size class, which are never
+         * culled for being too small on screen.
+         */
+        static const int SelectedSizeClass = -1;
+
+        static int sizeClass(const float size) {
+            auto result = 0;
+            auto maxSize = SmallestSizeClassSize;
+            while (result < SizeClassCount - 1 && size > maxSize) {
+                ++result;
+                maxSize *= SizeClassFactor;
+            }
+            return result;
+        }
+
+        BrushRenderer::ChunkMap::iterator BrushRenderer::addBrushToChunk(const Model::BrushNode* brush) {
+            const auto bounds = vm::bbox3f(brush->physicalBounds());
+            const auto center = bounds.center();
+            const auto size = vm::get_max_component(bounds.size());
+
+            // separating brushes by their size keeps small detail brushes in chunks of their own, so that such chunks
+            // can be culled when their brushes become too small on screen, while the few size classes keep the number
+            // of chunks per grid cell small
+            const auto selected = brush->selected() || brush->parentSelected() || brush->hasSelectedFaces();
+            const auto key = ChunkKey(
+                static_cast<int>(std::floor(center.x() / ChunkSize)),
+                static_cast<int>(std::floor(center.y() / ChunkSize)),
+                static_cast<int>(std::floor(center.z() / ChunkSize)),
+                selected ? SelectedSizeClass : sizeClass(size));
+
+            auto it = m_chunks.find(key);
+            if (it == std::end(m_chunks)) {
+                it = m_chunks.emplace(key, Chunk()).first;
+                it->second.bounds = bounds;
+            } else {
+                it->second.bounds = vm::merge(it->second.bounds, bounds);
+            }
+            it->second.maxBrushSize = vm::max(it->second.maxBrushSize, size);
+
+            ++it->second.brushCount;
+            return it;
+        }
+
         void BrushRenderer::addBrush(const Model::BrushNode* brush) {
             // i.e. insert the brush as "invalid" if it's not already present.
             // if it is present, its validity is unchanged.
@@ -601,32 +875,41 @@ namespace TrenchBroom {
             }
 
             const BrushInfo& info = it->second;
+            const auto chunkIt = m_chunks.find(info.chunkKey);
+            assert(chunkIt != std::end(m_chunks));
+            Chunk& chunk = chunkIt->second;
 
             // update Vbo's
+            m_vertexBlockToBrush.erase(info.vertexHolderKey);
             m_vertexArray->deleteVerticesWithKey(info.vertexHolderKey);
             if (info.edgeIndicesKey != nullptr) {
-                m_edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
+                chunk.edgeIndices->zeroElementsWithKey(info.edgeIndicesKey);
             }
 
             for (const auto& [texture, opaqueKey] : info.opaqueFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_opaqueFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.opaqueFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(opaqueKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_opaqueFaces->erase(texture);
+                    chunk.opaqueFaces->erase(texture);
                 }
             }
             for (const auto& [texture, transparentKey] : info.transparentFaceIndicesKeys) {
-                std::shared_ptr<BrushIndexArray> faceIndexHolder = m_transparentFaces->at(texture);
+                std::shared_ptr<BrushIndexArray> faceIndexHolder = chunk.transparentFaces->at(texture);
                 faceIndexHolder->zeroElementsWithKey(transparentKey);
 
                 if (!faceIndexHolder->hasValidIndices()) {
                     // There are no indices left to render for this texture, so delete the <Texture, BrushIndexArray> entry from the map
-                    m_transparentFaces->erase(texture);
+                    chunk.transparentFaces->erase(texture);
                 }
             }
 
+            assert(chunk.brushCount > 0u);
+            if (--chunk.brushCount == 0u) {
+                m_chunks.erase(chunkIt);
+            }
+
             m_brushInfo.erase(it);
         }
     }
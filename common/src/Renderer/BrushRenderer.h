@@ -26,6 +26,9 @@
 #include "Renderer/EdgeRenderer.h"
 #include "Renderer/FaceRenderer.h"
 
+#include <vecmath/bbox.h>
+
+#include <map>
 #include <memory>
 #include <tuple>
 #include <unordered_map>
@@ -118,7 +121,43 @@ namespace TrenchBroom {
         private:
             std::unique_ptr<Filter> m_filter;
 
+            using TextureToBrushIndicesMap = std::unordered_map<const Assets::Texture*, std::shared_ptr<BrushIndexArray>>;
+
+            /**
+             * Brushes are grouped into chunks by the grid cell that contains the center of their bounds and by one of
+             * a few size classes, so that there are at most three chunks per grid cell, plus one chunk for selected
+             * brushes, which are never culled for being too small on screen. Every chunk has its own index arrays, so
+             * that chunks outside of the view frustum or whose brushes are too small on screen can be skipped. All
+             * chunks share the vertex array. The index arrays of the chunks are never uploaded, instead the indices of
+             * all chunks are merged by texture, see MergedFaces.
+             */
+            struct Chunk {
+                /**
+                 * The union of the bounds of all brushes added to this chunk. Removing a brush does not shrink it.
+                 */
+                vm::bbox3f bounds;
+                /**
+                 * The largest extent of the bounds of any brush added to this chunk.
+                 */
+                float maxBrushSize;
+                size_t brushCount;
+                bool detailCulled;
+
+                std::shared_ptr<BrushIndexArray> edgeIndices;
+                std::shared_ptr<TextureToBrushIndicesMap> transparentFaces;
+                std::shared_ptr<TextureToBrushIndicesMap> opaqueFaces;
+
+                IndexedEdgeRenderer edgeRenderer;
+
+                Chunk();
+            };
+
+            using ChunkKey = std::tuple<int, int, int, int>;
+            using ChunkMap = std::map<ChunkKey, Chunk>;
+            static const float ChunkSize;
+
             struct BrushInfo {
+                ChunkKey chunkKey;
                 AllocationTracker::Block* vertexHolderKey;
                 AllocationTracker::Block* edgeIndicesKey;
                 std::vector<std::pair<const Assets::Texture*, AllocationTracker::Block*>> opaqueFaceIndicesKeys;
@@ -130,6 +169,12 @@ namespace TrenchBroom {
              */
             std::unordered_map<const Model::BrushNode*, BrushInfo> m_brushInfo;
 
+            /**
+             * Maps the vertex array allocation of each brush in the VBO to the brush, so that the brush's indices can
+             * be rebased when compaction moves its vertices.
+             */
+            std::unordered_map<const AllocationTracker::Block*, const Model::BrushNode*> m_vertexBlockToBrush;
+
             /**
              * If a brush is in the VBO, it's always valid.
              * If a brush is valid, it might not be in the VBO if it was hidden by the Filter.
@@ -140,15 +185,32 @@ namespace TrenchBroom {
             std::unordered_set<const Model::BrushNode*> m_invalidBrushes;
 
             std::shared_ptr<BrushVertexArray> m_vertexArray;
-            std::shared_ptr<BrushIndexArray> m_edgeIndices;
+            ChunkMap m_chunks;
 
-            using TextureToBrushIndicesMap = std::unordered_map<const Assets::Texture*, std::shared_ptr<BrushIndexArray>>;
-            std::shared_ptr<TextureToBrushIndicesMap> m_transparentFaces;
-            std::shared_ptr<TextureToBrushIndicesMap> m_opaqueFaces;
+            /**
+             * The face indices of all chunks that use the same texture are merged into one index array, so that every
+             * texture is drawn with one call per pass. The indices of every chunk take up one range of the merged
+             * array, and only the ranges of the visible chunks are drawn. The merged index arrays and the face
+             * renderer are therefore kept until the faces of a chunk change, no matter which chunks are visible.
+             */
+            struct MergedFaces {
+                using Sources = std::vector<std::pair<const BrushIndexArray*, size_t>>;
+                using Ranges = std::unordered_map<const BrushIndexArray*, IndexRange>;
+
+                /**
+                 * For every texture, the index arrays of the chunks that were merged, with their revisions.
+                 */
+                std::unordered_map<const Assets::Texture*, Sources> sources;
+                /**
+                 * For every texture, the range of the merged index array that holds the indices of each chunk.
+                 */
+                std::unordered_map<const Assets::Texture*, Ranges> ranges;
+                std::shared_ptr<TextureToBrushIndicesMap> indices;
+                FaceRenderer renderer;
+            };
 
-            FaceRenderer m_opaqueFaceRenderer;
-            FaceRenderer m_transparentFaceRenderer;
-            IndexedEdgeRenderer m_edgeRenderer;
+            MergedFaces m_opaqueFaces;
+            MergedFaces m_transparentFaces;
 
             Color m_faceColor;
             bool m_showEdges;
@@ -162,6 +224,8 @@ namespace TrenchBroom {
             float m_transparencyAlpha;
 
             bool m_showHiddenBrushes;
+
+            size_t m_mergeCount;
         public:
             template <typename FilterT>
             explicit BrushRenderer(const FilterT& filter) :
@@ -172,7 +236,8 @@ namespace TrenchBroom {
             m_showOccludedEdges(false),
             m_forceTransparent(false),
             m_transparencyAlpha(1.0f),
-            m_showHiddenBrushes(false) {
+            m_showHiddenBrushes(false),
+            m_mergeCount(0) {
                 clear();
             }
 
@@ -271,18 +336,41 @@ namespace TrenchBroom {
             void renderOpaque(RenderContext& renderContext, RenderBatch& renderBatch);
             void renderTransparent(RenderContext& renderContext, RenderBatch& renderBatch);
         private:
-            void renderOpaqueFaces(RenderBatch& renderBatch);
-            void renderTransparentFaces(RenderBatch& renderBatch);
-            void renderEdges(RenderBatch& renderBatch);
+            std::vector<Chunk*> visibleChunks(const RenderContext& renderContext);
+            /**
+             * Merges the opaque or transparent face indices of all chunks by texture unless they are unchanged.
+             *
+             * @return true if the merged indices changed
+             */
+            bool mergeFaces(MergedFaces& mergedFaces, bool transparent);
+            /**
+             * Returns the ranges of the merged index arrays that contain the faces of the given chunks.
+             */
+            FaceRenderer::TextureToIndexRangesMap visibleIndexRanges(const MergedFaces& mergedFaces, const std::vector<Chunk*>& chunks, bool transparent) const;
+            void renderOpaqueFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
+            void renderTransparentFaces(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
+            void renderEdges(const std::vector<Chunk*>& chunks, RenderBatch& renderBatch);
 
         public:
             /**
              * Only exposed for benchmarking.
              */
             void validate();
+
+            /**
+             * Only exposed for testing. Returns the number of times that the face indices of a texture were merged.
+             */
+            size_t mergeCount() const;
         private:
+            /**
+             * Closes the gaps left in the vertex and index arrays by removed brushes if most of their space is unused.
+             * The work is spread over several frames by stopping once a time budget is used up.
+             */
+            void compact();
+
             bool shouldDrawFaceInTransparentPass(const Model::BrushNode* brush, const Model::BrushFace& face) const;
             void validateBrush(const Model::BrushNode* brush);
+            ChunkMap::iterator addBrushToChunk(const Model::BrushNode* brush);
             void addBrush(const Model::BrushNode* brush);
             void removeBrush(const Model::BrushNode* brush);
 
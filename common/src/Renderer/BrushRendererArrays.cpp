@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <stdexcept>
 
@@ -31,11 +32,22 @@ namespace TrenchBroom {
 
         // DirtyRangeTracker
 
+        size_t DirtyRangeTracker::Range::end() const {
+            return pos + size;
+        }
+
+        bool DirtyRangeTracker::Range::operator==(const Range& other) const {
+            return pos == other.pos && size == other.size;
+        }
+
+        const size_t DirtyRangeTracker::MaxGap = 256u;
+        const size_t DirtyRangeTracker::MaxRangeCount = 16u;
+
         DirtyRangeTracker::DirtyRangeTracker(const size_t initial_capacity)
-                : m_dirtyPos(0), m_dirtySize(0), m_capacity(initial_capacity) {}
+                : m_dirtySize(0), m_capacity(initial_capacity) {}
 
         DirtyRangeTracker::DirtyRangeTracker()
-                : m_dirtyPos(0), m_dirtySize(0), m_capacity(0) {}
+                : m_dirtySize(0), m_capacity(0) {}
 
         void DirtyRangeTracker::expand(const size_t newcap) {
             if (newcap <= m_capacity) {
@@ -57,15 +69,53 @@ namespace TrenchBroom {
                 throw std::invalid_argument("markDirty provided range out of bounds");
             }
 
-            const size_t newPos = std::min(pos, m_dirtyPos);
-            const size_t newEnd = std::max(pos + size, m_dirtyPos + m_dirtySize);
+            if (size == 0) {
+                return;
+            }
+
+            // find the ranges that the given range overlaps or is close to and replace them by their union
+            auto range = Range{pos, size};
+            auto first = std::lower_bound(std::begin(m_dirtyRanges), std::end(m_dirtyRanges), range, [](const Range& lhs, const Range& rhs) {
+                return lhs.end() + MaxGap < rhs.pos;
+            });
+            auto last = first;
+            while (last != std::end(m_dirtyRanges) && last->pos <= range.end() + MaxGap) {
+                const auto start = std::min(range.pos, last->pos);
+                const auto end = std::max(range.end(), last->end());
+                m_dirtySize -= last->size;
+                range = Range{start, end - start};
+                ++last;
+            }
 
-            m_dirtyPos = newPos;
-            m_dirtySize = newEnd - newPos;
+            m_dirtySize += range.size;
+            m_dirtyRanges.insert(m_dirtyRanges.erase(first, last), range);
+
+            if (m_dirtyRanges.size() > MaxRangeCount) {
+                // merge the two neighbouring ranges with the smallest gap
+                auto closest = std::begin(m_dirtyRanges);
+                for (auto it = std::next(closest); std::next(it) != std::end(m_dirtyRanges); ++it) {
+                    if (std::next(it)->pos - it->end() < std::next(closest)->pos - closest->end()) {
+                        closest = it;
+                    }
+                }
+
+                const auto next = std::next(closest);
+                m_dirtySize += next->pos - closest->end();
+                closest->size = next->end() - closest->pos;
+                m_dirtyRanges.erase(next);
+            }
         }
 
         bool DirtyRangeTracker::clean() const {
-            return m_dirtySize == 0;
+            return m_dirtyRanges.empty();
+        }
+
+        const std::vector<DirtyRangeTracker::Range>& DirtyRangeTracker::dirtyRanges() const {
+            return m_dirtyRanges;
+        }
+
+        size_t DirtyRangeTracker::dirtySize() const {
+            return m_dirtySize;
         }
 
         // IndexHolder
@@ -87,22 +137,86 @@ namespace TrenchBroom {
             glAssert(glDrawElements(toGL(primType), renderCount, glType<Index>(), renderOffset));
         }
 
+        void IndexHolder::render(const PrimType primType, const std::vector<IndexRange>& ranges) const {
+            auto renderCounts = std::vector<GLsizei>();
+            auto renderOffsets = std::vector<const GLvoid*>();
+            renderCounts.reserve(ranges.size());
+            renderOffsets.reserve(ranges.size());
+
+            for (const auto& range : ranges) {
+                renderCounts.push_back(static_cast<GLsizei>(range.count));
+                renderOffsets.push_back(reinterpret_cast<GLvoid *>(m_vbo->offset() + sizeof(Index) * range.offset));
+            }
+
+            glAssert(glMultiDrawElements(toGL(primType), renderCounts.data(), glType<Index>(), renderOffsets.data(), static_cast<GLsizei>(ranges.size())));
+        }
+
         std::shared_ptr<IndexHolder> IndexHolder::swap(std::vector<IndexHolder::Index> &elements) {
             return std::make_shared<IndexHolder>(elements);
         }
 
         VertexArrayInterface::~VertexArrayInterface() {}
 
+        /**
+         * Arrays smaller than this are never compacted.
+         */
+        static const size_t MinCompactionCapacity = 4096u;
+
+        static bool needsCompaction(const AllocationTracker& allocationTracker) {
+            const auto capacity = allocationTracker.capacity();
+            return capacity >= MinCompactionCapacity && 2u * allocationTracker.usedSize() < capacity;
+        }
+
+        /**
+         * Releases the free space at the end of a fully compacted array, but keeps some headroom so that the next
+         * allocations don't immediately expand the array again.
+         */
+        template <typename H>
+        static void shrinkCompacted(AllocationTracker& allocationTracker, H& holder) {
+            assert(allocationTracker.compacted());
+
+            const auto usedSize = allocationTracker.usedSize();
+            const auto newSize = usedSize + usedSize / 2u;
+            if (newSize < allocationTracker.capacity()) {
+                allocationTracker.shrink(newSize);
+                holder.shrink(newSize);
+            }
+        }
+
         // BrushIndexArray
 
+        static size_t nextIndexArrayRevision() {
+            static std::atomic<size_t> revision(0u);
+            return ++revision;
+        }
+
         BrushIndexArray::BrushIndexArray() : m_indexHolder(),
-                                             m_allocationTracker(0) {}
+                                             m_allocationTracker(0),
+                                             m_revision(nextIndexArrayRevision()) {}
 
         bool BrushIndexArray::hasValidIndices() const {
             return m_allocationTracker.hasAllocations();
         }
 
+        size_t BrushIndexArray::usedIndexCount() const {
+            return m_allocationTracker.usedSize();
+        }
+
+        GLuint* BrushIndexArray::copyUsedIndices(GLuint* dest) const {
+            const auto* indices = m_indexHolder.data();
+            for (const auto& range : m_allocationTracker.usedBlocks()) {
+                dest = std::copy(indices + range.pos, indices + range.pos + range.size, dest);
+            }
+            return dest;
+        }
+
+        size_t BrushIndexArray::revision() const {
+            return m_revision;
+        }
+
         std::pair<AllocationTracker::Block*, GLuint*> BrushIndexArray::getPointerToInsertElementsAt(const size_t elementCount) {
+            m_revision = nextIndexArrayRevision();
+
             auto block = m_allocationTracker.allocate(elementCount);
             if (block != nullptr) {
                 GLuint* dest = m_indexHolder.getPointerToWriteElementsTo(block->pos, elementCount);
@@ -124,6 +238,8 @@ namespace TrenchBroom {
         }
 
         void BrushIndexArray::zeroElementsWithKey(AllocationTracker::Block* key) {
+            m_revision = nextIndexArrayRevision();
+
             const auto pos = key->pos;
             const auto size = key->size;
             m_allocationTracker.free(key);
@@ -131,11 +247,49 @@ namespace TrenchBroom {
             m_indexHolder.zeroRange(pos, size);
         }
 
+        void BrushIndexArray::rebaseElementsWithKey(AllocationTracker::Block* key, const GLuint oldBase, const GLuint newBase) {
+            m_revision = nextIndexArrayRevision();
+
+            GLuint* indices = m_indexHolder.getPointerToWriteElementsTo(key->pos, key->size);
+            for (size_t i = 0; i < key->size; ++i) {
+                indices[i] = indices[i] - oldBase + newBase;
+            }
+        }
+
+        bool BrushIndexArray::needsCompaction() const {
+            return Renderer::needsCompaction(m_allocationTracker);
+        }
+
+        void BrushIndexArray::compact(const size_t maxMoveSize) {
+            // compaction keeps the order of the indices in use, so the revision does not change
+            const auto moves = m_allocationTracker.compact(maxMoveSize);
+            for (const auto& move : moves) {
+                m_indexHolder.moveElements(move.oldPos, move.block->pos, move.block->size);
+            }
+
+            if (!moves.empty()) {
+                // the whole array is rendered, so the space vacated by the last move must be degenerate
+                const auto* lastBlock = moves.back().block;
+                const auto newEnd = lastBlock->pos + lastBlock->size;
+                const auto oldEnd = moves.back().oldPos + lastBlock->size;
+                m_indexHolder.zeroRange(newEnd, oldEnd - newEnd);
+            }
+
+            if (m_allocationTracker.compacted()) {
+                shrinkCompacted(m_allocationTracker, m_indexHolder);
+            }
+        }
+
         void BrushIndexArray::render(const PrimType primType) const {
             assert(m_indexHolder.prepared());
             m_indexHolder.render(primType, 0, m_indexHolder.size());
         }
 
+        void BrushIndexArray::render(const PrimType primType, const std::vector<IndexRange>& ranges) const {
+            assert(m_indexHolder.prepared());
+            m_indexHolder.render(primType, ranges);
+        }
+
         bool BrushIndexArray::prepared() const {
             return m_indexHolder.prepared();
         }
@@ -188,6 +342,23 @@ namespace TrenchBroom {
             // us to re-use the space later
         }
 
+        bool BrushVertexArray::needsCompaction() const {
+            return Renderer::needsCompaction(m_allocationTracker);
+        }
+
+        std::vector<AllocationTracker::Move> BrushVertexArray::compact(const size_t maxMoveSize) {
+            auto moves = m_allocationTracker.compact(maxMoveSize);
+            for (const auto& move : moves) {
+                m_vertexHolder.moveElements(move.oldPos, move.block->pos, move.block->size);
+            }
+
+            if (m_allocationTracker.compacted()) {
+                shrinkCompacted(m_allocationTracker, m_vertexHolder);
+            }
+
+            return moves;
+        }
+
         bool BrushVertexArray::setupVertices() {
             return m_vertexHolder.setupVertices();
         }
@@ -31,15 +31,37 @@
 
 #include <vecmath/vec.h>
 
+#include <algorithm>
 #include <cassert>
+#include <iterator>
 #include <memory>
 #include <unordered_map>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Renderer {
+        /**
+         * Tracks the ranges of a buffer that were modified since the last upload.
+         *
+         * Dirty ranges that are close to each other are merged so that they can be uploaded with few calls. If there
+         * are more than MaxRangeCount ranges, the two ranges with the smallest gap between them are merged.
+         */
         struct DirtyRangeTracker {
-            size_t m_dirtyPos;
+            struct Range {
+                size_t pos;
+                size_t size;
+
+                size_t end() const;
+                bool operator==(const Range& other) const;
+            };
+
+            /**
+             * Dirty ranges that are separated by at most this many elements are merged.
+             */
+            static const size_t MaxGap;
+            static const size_t MaxRangeCount;
+
+            std::vector<Range> m_dirtyRanges;
             size_t m_dirtySize;
             size_t m_capacity;
 
@@ -56,6 +78,16 @@ namespace TrenchBroom {
             size_t capacity() const;
             void markDirty(size_t pos, size_t size);
             bool clean() const;
+
+            /**
+             * The disjoint dirty ranges, ordered by position.
+             */
+            const std::vector<Range>& dirtyRanges() const;
+
+            /**
+             * The total number of elements in all dirty ranges.
+             */
+            size_t dirtySize() const;
         };
 
         /**
@@ -64,8 +96,9 @@ namespace TrenchBroom {
          * Non-copyable; meant to be held in a std::shared_ptr.
          * Able to be resized, and handles copying edits made in the local std::vector to the VBO.
          *
-         * Currently uses a single range to track the modified region which might upload much more than necessary;
-         * it might be worth mapping the VBO and editing it directly.
+         * Modified regions are tracked as a few coalesced ranges, each of which is uploaded with one call. If most of
+         * the buffer is modified, its entire contents are replaced at once, which allows the driver to orphan the old
+         * storage instead of waiting until the GPU has stopped using it.
          */
         template<typename T>
         class VboHolder {
@@ -143,6 +176,33 @@ namespace TrenchBroom {
                 m_dirtyRange.expand(newSize);
             }
 
+            /**
+             * Releases the elements past the given size. The buffer object is reallocated on the next call to
+             * prepare().
+             */
+            void shrink(const size_t newSize) {
+                assert(newSize <= m_snapshot.size());
+                m_snapshot.resize(newSize);
+                m_snapshot.shrink_to_fit();
+
+                m_dirtyRange = DirtyRangeTracker(newSize);
+                m_dirtyRange.markDirty(0, newSize);
+            }
+
+            /**
+             * Moves the given number of elements to a lower offset within the buffer and marks the destination dirty.
+             */
+            void moveElements(const size_t fromOffset, const size_t toOffset, const size_t elementCount) {
+                assert(toOffset <= fromOffset);
+                assert(fromOffset + elementCount <= m_snapshot.size());
+
+                const auto first = std::next(std::begin(m_snapshot), static_cast<std::ptrdiff_t>(fromOffset));
+                const auto last = std::next(first, static_cast<std::ptrdiff_t>(elementCount));
+                std::copy(first, last, std::next(std::begin(m_snapshot), static_cast<std::ptrdiff_t>(toOffset)));
+
+                m_dirtyRange.markDirty(toOffset, elementCount);
+            }
+
             T* getPointerToWriteElementsTo(const size_t offsetWithinBlock, const size_t elementCount) {
                 assert(offsetWithinBlock + elementCount <= m_snapshot.size());
 
@@ -183,14 +243,15 @@ namespace TrenchBroom {
 
                 // otherwise, it's an incremental update of the dirty ranges.
 
-                if (!m_dirtyRange.clean()) {
-                    const size_t pos = m_dirtyRange.m_dirtyPos;
-                    const size_t size = m_dirtyRange.m_dirtySize;
-
-                    const size_t bytesFromStart = pos * sizeof(T);
-                    m_vbo->writeArray(bytesFromStart,
-                                      m_snapshot.data() + pos,
-                                      size);
+                if (2u * m_dirtyRange.dirtySize() >= m_snapshot.size()) {
+                    m_vbo->replaceArray(m_snapshot.data(), m_snapshot.size());
+                } else {
+                    for (const auto& range : m_dirtyRange.dirtyRanges()) {
+                        const size_t bytesFromStart = range.pos * sizeof(T);
+                        m_vbo->writeArray(bytesFromStart,
+                                          m_snapshot.data() + range.pos,
+                                          range.size);
+                    }
                 }
 
                 m_dirtyRange = DirtyRangeTracker(m_snapshot.size());
@@ -205,6 +266,10 @@ namespace TrenchBroom {
                 return m_snapshot.size();
             }
 
+            const T* data() const {
+                return m_snapshot.data();
+            }
+
             void bindBlock() {
                 m_vbo->bind();
             }
@@ -214,6 +279,14 @@ namespace TrenchBroom {
             }
         };
 
+        /**
+         * A range of indices, given by the position of its first index and its number of indices.
+         */
+        struct IndexRange {
+            size_t offset;
+            size_t count;
+        };
+
         class IndexHolder : public VboHolder<GLuint> {
         public:
             using Index = GLuint;
@@ -225,6 +298,7 @@ namespace TrenchBroom {
             explicit IndexHolder(std::vector<Index>& elements);
             void zeroRange(size_t offsetWithinBlock, size_t count);
             void render(PrimType primType, size_t offset, size_t count) const;
+            void render(PrimType primType, const std::vector<IndexRange>& ranges) const;
 
             static std::shared_ptr<IndexHolder> swap(std::vector<Index>& elements);
         };
@@ -237,6 +311,7 @@ namespace TrenchBroom {
         private:
             IndexHolder m_indexHolder;
             AllocationTracker m_allocationTracker;
+            size_t m_revision;
         public:
             BrushIndexArray();
 
@@ -245,6 +320,25 @@ namespace TrenchBroom {
              */
             bool hasValidIndices() const;
 
+            /**
+             * Returns the number of indices in use. Ranges zeroed by zeroElementsWithKey() do not count.
+             */
+            size_t usedIndexCount() const;
+
+            /**
+             * Copies the indices in use to the given destination, which must have room for usedIndexCount() indices.
+             * Ranges zeroed by zeroElementsWithKey() are skipped.
+             *
+             * @return a pointer past the last copied index
+             */
+            GLuint* copyUsedIndices(GLuint* dest) const;
+
+            /**
+             * Returns a number that changes whenever the indices are modified. Revisions are unique among all index
+             * arrays, so an array and its revision identify its contents.
+             */
+            size_t revision() const;
+
             /**
              * Call this to request writing the given number of indices.
              *
@@ -260,7 +354,30 @@ namespace TrenchBroom {
              */
             void zeroElementsWithKey(AllocationTracker::Block* key);
 
+            /**
+             * Adds `newBase - oldBase` to every index in the given allocation. Used to keep the indices valid after
+             * the vertices they refer to were moved by BrushVertexArray::compact().
+             */
+            void rebaseElementsWithKey(AllocationTracker::Block* key, GLuint oldBase, GLuint newBase);
+
+            /**
+             * Returns true if most of this array is unused, so that compact() should be called.
+             */
+            bool needsCompaction() const;
+
+            /**
+             * Moves allocations to close the gaps between them, stopping after about `maxMoveSize` indices have
+             * been moved. Once all gaps are closed, the unused space at the end is released. The keys of moved
+             * allocations remain valid.
+             */
+            void compact(size_t maxMoveSize);
+
             void render(const PrimType primType) const;
+
+            /**
+             * Renders the given ranges of this array with a single draw call.
+             */
+            void render(PrimType primType, const std::vector<IndexRange>& ranges) const;
             bool prepared() const;
             void prepare(VboManager& vboManager);
 
@@ -334,6 +451,22 @@ namespace TrenchBroom {
 
             void deleteVerticesWithKey(AllocationTracker::Block* key);
 
+            /**
+             * Returns true if most of this array is unused, so that compact() should be called.
+             */
+            bool needsCompaction() const;
+
+            /**
+             * Moves allocations to close the gaps between them, stopping after about `maxMoveSize` vertices have
+             * been moved. Once all gaps are closed, the unused space at the end is released.
+             *
+             * The keys of moved allocations remain valid, but the caller must rebase the indices that refer to the
+             * moved vertices.
+             *
+             * @return the moves that were made
+             */
+            std::vector<AllocationTracker::Move> compact(size_t maxMoveSize);
+
             // setting up GL attributes
             bool setupVertices();
             void cleanupVertices();
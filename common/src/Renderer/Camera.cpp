@@ -21,10 +21,14 @@
 
 #include "Macros.h"
 
+#include <vecmath/bbox.h>
+#include <vecmath/plane.h>
 #include <vecmath/ray.h>
 #include <vecmath/distance.h>
 #include <vecmath/intersection.h>
 
+#include <limits>
+
 namespace TrenchBroom {
     namespace Renderer {
         Camera::Viewport::Viewport() :
@@ -152,6 +156,40 @@ namespace TrenchBroom {
             doComputeFrustumPlanes(top, right, bottom, left);
         }
 
+        bool Camera::intersectsFrustum(const vm::bbox3f& bounds) const {
+            vm::plane3f planes[4];
+            frustumPlanes(planes[0], planes[1], planes[2], planes[3]);
+
+            for (const auto& plane : planes) {
+                // the plane normals point out of the frustum, so test the corner that is farthest inside
+                const auto corner = vm::vec3f(
+                    plane.normal.x() > 0.0f ? bounds.min.x() : bounds.max.x(),
+                    plane.normal.y() > 0.0f ? bounds.min.y() : bounds.max.y(),
+                    plane.normal.z() > 0.0f ? bounds.min.z() : bounds.max.z());
+                if (plane.point_distance(corner) > 0.0f) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        float Camera::maxProjectedSize(const vm::bbox3f& bounds, const float size) const {
+            // the scaling factor is an affine function of the position, so its minimum is attained at a corner
+            auto minScaling = std::numeric_limits<float>::max();
+            for (size_t i = 0u; i < 8u; ++i) {
+                const auto corner = vm::vec3f(
+                    (i & 1u) ? bounds.max.x() : bounds.min.x(),
+                    (i & 2u) ? bounds.max.y() : bounds.min.y(),
+                    (i & 4u) ? bounds.max.z() : bounds.min.z());
+                minScaling = vm::min(minScaling, perspectiveScalingFactor(corner));
+            }
+
+            if (minScaling <= 0.0f) {
+                return std::numeric_limits<float>::max();
+            }
+            return size / minScaling;
+        }
+
         vm::ray3f Camera::viewRay() const {
             return vm::ray3f(m_position, m_direction);
         }
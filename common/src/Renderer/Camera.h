@@ -109,6 +109,19 @@ namespace TrenchBroom {
             const vm::mat4x4f verticalBillboardMatrix() const;
             void frustumPlanes(vm::plane3f& topPlane, vm::plane3f& rightPlane, vm::plane3f& bottomPlane, vm::plane3f& leftPlane) const;
 
+            /**
+             * Indicates whether the given bounds might be visible, i.e., whether they are not entirely outside of any
+             * of the side planes of the view frustum. The near and far planes are not considered.
+             */
+            bool intersectsFrustum(const vm::bbox3f& bounds) const;
+
+            /**
+             * Returns the largest size in pixels that an object of the given size in world units can appear with when
+             * it is placed anywhere within the given bounds. Returns the maximum float value if the bounds reach the
+             * plane of the camera position.
+             */
+            float maxProjectedSize(const vm::bbox3f& bounds, float size) const;
+
             vm::ray3f viewRay() const;
             vm::ray3f pickRay(int x, int y) const;
             vm::ray3f pickRay(const vm::vec3f& point) const;
@@ -30,13 +30,16 @@
 #include "Model/EditorContext.h"
 #include "Model/EntityNode.h"
 #include "Renderer/ActiveShader.h"
+#include "Renderer/Camera.h"
 #include "Renderer/RenderBatch.h"
 #include "Renderer/RenderContext.h"
+#include "Renderer/RenderUtils.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/ShaderManager.h"
 #include "Renderer/TexturedIndexRangeRenderer.h"
 #include "Renderer/Transformation.h"
 
+#include <vecmath/bbox.h>
 #include <vecmath/mat.h>
 
 namespace TrenchBroom {
@@ -45,6 +48,7 @@ namespace TrenchBroom {
         m_logger(logger),
         m_entityModelManager(entityModelManager),
         m_editorContext(editorContext),
+        m_instancesValid(false),
         m_applyTinting(false),
         m_showHiddenEntities(false) {}
 
@@ -61,6 +65,7 @@ namespace TrenchBroom {
             if (renderer != nullptr) {
                 m_entities.insert(std::make_pair(entity, renderer));
             }
+            m_instancesValid = false;
         }
 
         void EntityModelRenderer::updateEntity(Model::EntityNode* entity) {
@@ -71,6 +76,9 @@ namespace TrenchBroom {
             auto* renderer = m_entityModelManager.renderer(modelSpec);
             EntityMap::iterator it = m_entities.find(entity);
 
+            // the entity's transformation may have changed even if its model did not
+            m_instancesValid = false;
+
             if (renderer == nullptr && it == std::end(m_entities)) {
                 return;
             }
@@ -79,6 +87,7 @@ namespace TrenchBroom {
                 m_entities.insert(std::make_pair(entity, renderer));
             } else {
                 if (renderer == nullptr) {
+                    m_detailCulledEntities.erase(entity);
                     m_entities.erase(it);
                 } else if (it->second != renderer) {
                     it->second = renderer;
@@ -88,6 +97,9 @@ namespace TrenchBroom {
 
         void EntityModelRenderer::clear() {
             m_entities.clear();
+            m_detailCulledEntities.clear();
+            m_instances.clear();
+            m_instancesValid = true;
         }
 
         bool EntityModelRenderer::applyTinting() const {
@@ -118,11 +130,49 @@ namespace TrenchBroom {
             renderBatch.add(this);
         }
 
+        void EntityModelRenderer::validateInstances() {
+            m_instances.clear();
+            for (const auto& [entity, renderer] : m_entities) {
+                m_instances[renderer].push_back(Instance{
+                    entity,
+                    vm::mat4x4f(entity->modelTransformation()),
+                    vm::bbox3f(entity->physicalBounds())
+                });
+            }
+            m_instancesValid = true;
+        }
+
         void EntityModelRenderer::doPrepareVertices(VboManager& vboManager) {
             m_entityModelManager.prepare(vboManager);
         }
 
+        class RenderInstanceFunc : public InstanceRenderFunc {
+        private:
+            Transformation& m_transformation;
+            ActiveShader& m_shader;
+            const std::vector<vm::mat4x4f>& m_instanceTransformations;
+        public:
+            RenderInstanceFunc(Transformation& transformation, ActiveShader& shader, const std::vector<vm::mat4x4f>& instanceTransformations) :
+            m_transformation(transformation),
+            m_shader(shader),
+            m_instanceTransformations(instanceTransformations) {}
+
+            void before(const size_t index) override {
+                const auto& instanceTransformation = m_instanceTransformations[index];
+                m_transformation.pushModelMatrix(instanceTransformation);
+                m_shader.set("ModelMatrix", instanceTransformation);
+            }
+
+            void after(const size_t /* index */) override {
+                m_transformation.popModelMatrix();
+            }
+        };
+
         void EntityModelRenderer::doRender(RenderContext& renderContext) {
+            if (!m_instancesValid) {
+                validateInstances();
+            }
+
             auto& prefs = PreferenceManager::instance();
 
             ActiveShader shader(renderContext.shaderManager(), Shaders::EntityModelShader);
@@ -142,20 +192,49 @@ namespace TrenchBroom {
             glAssert(glEnable(GL_TEXTURE_2D));
             glAssert(glActiveTexture(GL_TEXTURE0));
 
-            for (const auto& entry : m_entities) {
-                auto* entity = entry.first;
-                if (!m_showHiddenEntities && !m_editorContext.visible(entity)) {
-                    continue;
+            // only the 3D view culls detail, the 2D views must not reset the state that it keeps between frames
+            const auto& camera = renderContext.camera();
+            const auto perspective = camera.perspectiveProjection();
+            const auto threshold = prefs.get(Preferences::DetailCullingPixelSize);
+
+            // all models share one vertex buffer, which is bound once for all of them, and all instances of a model
+            // are rendered together so that its textures are activated only once
+            const auto verticesSetup = m_entityModelManager.setupVertices();
+
+            std::vector<vm::mat4x4f> instanceTransformations;
+            for (const auto& [renderer, instances] : m_instances) {
+                instanceTransformations.clear();
+                for (const auto& instance : instances) {
+                    auto* entity = instance.entity;
+                    if (!m_showHiddenEntities && !m_editorContext.visible(entity)) {
+                        continue;
+                    }
+
+                    // selected entities are never culled for being too small on screen
+                    if (perspective && !entity->selected() && !entity->parentSelected()) {
+                        const auto& bounds = instance.bounds;
+                        const auto wasCulled = m_detailCulledEntities.count(entity) > 0u;
+                        if (cullDetail(wasCulled, camera, bounds, vm::get_max_component(bounds.size()), threshold)) {
+                            if (!wasCulled) {
+                                m_detailCulledEntities.insert(entity);
+                            }
+                            continue;
+                        } else if (wasCulled) {
+                            m_detailCulledEntities.erase(entity);
+                        }
+                    }
+
+                    instanceTransformations.push_back(instance.transformation);
                 }
 
-                auto* renderer = entry.second;
-
-                const auto transformation = entity->modelTransformation();
-                MultiplyModelMatrix multMatrix(renderContext.transformation(), vm::mat4x4f(transformation));
-
-                shader.set("ModelMatrix", vm::mat4x4f(transformation));
+                if (!instanceTransformations.empty()) {
+                    RenderInstanceFunc func(renderContext.transformation(), shader, instanceTransformations);
+                    renderer->renderInstances(instanceTransformations.size(), func);
+                }
+            }
 
-                renderer->render();
+            if (verticesSetup) {
+                m_entityModelManager.cleanupVertices();
             }
         }
     }
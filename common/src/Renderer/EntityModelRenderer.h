@@ -23,7 +23,13 @@
 #include "Color.h"
 #include "Renderer/Renderable.h"
 
+#include <vecmath/bbox.h>
+#include <vecmath/mat.h>
+
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace TrenchBroom {
     class Logger;
@@ -52,6 +58,24 @@ namespace TrenchBroom {
 
             EntityMap m_entities;
 
+            struct Instance {
+                Model::EntityNode* entity;
+                vm::mat4x4f transformation;
+                vm::bbox3f bounds;
+            };
+
+            /**
+             * The entities grouped by their model renderers, so that all instances of a model can be rendered together.
+             * Rebuilt when entities are added or updated.
+             */
+            std::unordered_map<TexturedRenderer*, std::vector<Instance>> m_instances;
+            bool m_instancesValid;
+
+            /**
+             * The entities whose models were too small on screen to be rendered in the last frame.
+             */
+            std::unordered_set<const Model::EntityNode*> m_detailCulledEntities;
+
             bool m_applyTinting;
             Color m_tintColor;
 
@@ -96,6 +120,8 @@ namespace TrenchBroom {
 
             void render(RenderBatch& renderBatch);
         private:
+            void validateInstances();
+
             void doPrepareVertices(VboManager& vboManager) override;
             void doRender(RenderContext& renderContext) override;
         };
@@ -79,6 +79,7 @@ namespace TrenchBroom {
         IndexedRenderable(other),
         m_vertexArray(other.m_vertexArray),
         m_indexArrayMap(other.m_indexArrayMap),
+        m_indexRanges(other.m_indexRanges),
         m_faceColor(other.m_faceColor),
         m_grayscale(other.m_grayscale),
         m_tint(other.m_tint),
@@ -95,6 +96,7 @@ namespace TrenchBroom {
             using std::swap;
             swap(left.m_vertexArray, right.m_vertexArray);
             swap(left.m_indexArrayMap, right.m_indexArrayMap);
+            swap(left.m_indexRanges, right.m_indexRanges);
             swap(left.m_faceColor, right.m_faceColor);
             swap(left.m_grayscale, right.m_grayscale);
             swap(left.m_tint, right.m_tint);
@@ -118,6 +120,10 @@ namespace TrenchBroom {
             m_alpha = alpha;
         }
 
+        void FaceRenderer::setIndexRanges(TextureToIndexRangesMap indexRanges) {
+            m_indexRanges = std::move(indexRanges);
+        }
+
         void FaceRenderer::render(RenderBatch& renderBatch) {
             renderBatch.add(this);
         }
@@ -193,6 +199,15 @@ namespace TrenchBroom {
                         continue;
                     }
 
+                    const std::vector<IndexRange>* indexRanges = nullptr;
+                    if (m_indexRanges) {
+                        const auto it = m_indexRanges->find(texture);
+                        if (it == std::end(*m_indexRanges)) {
+                            continue;
+                        }
+                        indexRanges = &it->second;
+                    }
+
                     const bool enableMasked = texture != nullptr && texture->masked();
                     
                     // set any per-texture uniforms
@@ -201,7 +216,11 @@ namespace TrenchBroom {
 
                     func.before(texture);
                     brushIndexHolderPtr->setupIndices();
-                    brushIndexHolderPtr->render(PrimType::Triangles);
+                    if (indexRanges != nullptr) {
+                        brushIndexHolderPtr->render(PrimType::Triangles, *indexRanges);
+                    } else {
+                        brushIndexHolderPtr->render(PrimType::Triangles);
+                    }
                     brushIndexHolderPtr->cleanupIndices();
                     func.after(texture);
                 }
@@ -21,13 +21,16 @@
 #define TrenchBroom_FaceRenderer
 
 #include "Color.h"
+#include "Renderer/BrushRendererArrays.h"
 #include "Renderer/Renderable.h"
 
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
 
 #include <memory>
+#include <optional>
 #include <unordered_map>
+#include <vector>
 
 namespace TrenchBroom {
     namespace Assets {
@@ -35,11 +38,11 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
-        class BrushIndexArray;
-        class BrushVertexArray;
         class RenderBatch;
 
         class FaceRenderer : public IndexedRenderable {
+        public:
+            using TextureToIndexRangesMap = std::unordered_map<const Assets::Texture*, std::vector<IndexRange>>;
         private:
             struct RenderFunc;
 
@@ -47,6 +50,7 @@ namespace TrenchBroom {
 
             std::shared_ptr<BrushVertexArray> m_vertexArray;
             std::shared_ptr<TextureToBrushIndicesMap> m_indexArrayMap;
+            std::optional<TextureToIndexRangesMap> m_indexRanges;
             Color m_faceColor;
             bool m_grayscale;
             bool m_tint;
@@ -65,6 +69,13 @@ namespace TrenchBroom {
             void setTintColor(const Color& color);
             void setAlpha(float alpha);
 
+            /**
+             * Restricts rendering to the given ranges of the index arrays, so that only parts of them can be rendered
+             * without building new index arrays. Textures without ranges are not rendered. Unless ranges are set, the
+             * index arrays are rendered entirely.
+             */
+            void setIndexRanges(TextureToIndexRangesMap indexRanges);
+
             void render(RenderBatch& renderBatch);
             static vm::vec3f gridColorForTexture(const Assets::Texture* texture);
         private:
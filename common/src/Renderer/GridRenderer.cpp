@@ -32,10 +32,26 @@
 #include <vecmath/bbox.h>
 #include <vecmath/vec.h>
 
+#include <algorithm>
+
 namespace TrenchBroom {
     namespace Renderer {
-        GridRenderer::GridRenderer(const OrthographicCamera& camera, const vm::bbox3& worldBounds) :
-        m_vertexArray(VertexArray::move(vertices(camera, worldBounds))) {}
+        GridRenderer::GridRenderer() = default;
+
+        GridRenderer::GridRenderer(const OrthographicCamera& camera, const vm::bbox3& worldBounds) {
+            update(camera, worldBounds);
+        }
+
+        void GridRenderer::update(const OrthographicCamera& camera, const vm::bbox3& worldBounds) {
+            auto newVertices = vertices(camera, worldBounds);
+            const auto sameVertices = std::equal(std::begin(newVertices), std::end(newVertices), std::begin(m_vertices), std::end(m_vertices),
+                [](const Vertex& lhs, const Vertex& rhs) { return lhs.attr == rhs.attr; });
+
+            if (!sameVertices) {
+                m_vertices = newVertices;
+                m_vertexArray = VertexArray::move(std::move(newVertices));
+            }
+        }
 
         std::vector<GridRenderer::Vertex> GridRenderer::vertices(const OrthographicCamera& camera, const vm::bbox3& worldBounds) {
             const auto& viewport = camera.zoomedViewport();
@@ -33,12 +33,24 @@ namespace TrenchBroom {
         class RenderContext;
         class VboManager;
 
+        /**
+         * Renders the grid of a 2D view on a single quad that covers the view. The grid lines are computed by the
+         * shader from the world coordinates of the quad and the grid size.
+         */
         class GridRenderer : public DirectRenderable {
         private:
             using Vertex = GLVertexTypes::P3::Vertex;
+            std::vector<Vertex> m_vertices;
             VertexArray m_vertexArray;
         public:
+            GridRenderer();
             GridRenderer(const OrthographicCamera& camera, const vm::bbox3& worldBounds);
+
+            /**
+             * Updates the quad to cover the view of the given camera. The quad is only uploaded again if the camera
+             * was moved or zoomed.
+             */
+            void update(const OrthographicCamera& camera, const vm::bbox3& worldBounds);
         private:
             static std::vector<Vertex> vertices(const OrthographicCamera& camera, const vm::bbox3& worldBounds);
 
@@ -137,6 +137,22 @@ namespace TrenchBroom {
             }
         }
 
+        IndexRangeMap IndexRangeMap::offset(const size_t baseVertex) const {
+            if (baseVertex == 0) {
+                return *this;
+            }
+
+            auto result = IndexRangeMap(size());
+            for (const auto& primType : PrimTypeValues) {
+                auto& indicesAndCounts = result.m_data->get(primType);
+                indicesAndCounts.add(m_data->get(primType), false);
+                for (auto& index : indicesAndCounts.indices) {
+                    index += static_cast<GLint>(baseVertex);
+                }
+            }
+            return result;
+        }
+
         void IndexRangeMap::render(VertexArray& vertexArray) const {
             for (const auto& primType : PrimTypeValues) {
                 const auto& indicesAndCounts = m_data->get(primType);
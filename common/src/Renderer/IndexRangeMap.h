@@ -139,6 +139,14 @@ namespace TrenchBroom {
              */
             void add(const IndexRangeMap& other);
 
+            /**
+             * Returns a copy of this index range map where every range starts the given number of vertices later.
+             *
+             * @param baseVertex the number of vertices to offset the ranges by
+             * @return the offset index range map
+             */
+            IndexRangeMap offset(size_t baseVertex) const;
+
             /**
              * Renders the primitives stored in this index range map using the vertices in the given vertex array.
              *
@@ -30,6 +30,18 @@ namespace TrenchBroom {
         class RenderContext;
         class VboManager;
 
+        /**
+         * A list of renderables collected for one frame of one view.
+         *
+         * Rendering a view happens in two phases. First, the view and its renderers add renderables to the batch,
+         * which is where the renderers extract their data from the map and the view state. Then render() uploads
+         * the vertex data of all renderables and submits them to OpenGL in the order in which they were added.
+         *
+         * Both phases run on the thread that owns the OpenGL context. The renderers are shared by all map views and
+         * read the document while collecting, so collecting for several views concurrently is not safe. Renderables
+         * that are expensive to collect should rather parallelize their own work internally, as BrushRenderer does
+         * when it validates its brushes.
+         */
         class RenderBatch {
         private:
             VboManager& m_vboManager;
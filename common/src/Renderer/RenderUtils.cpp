@@ -20,6 +20,7 @@
 #include "RenderUtils.h"
 
 #include "Assets/Texture.h"
+#include "Renderer/Camera.h"
 #include "Renderer/GL.h"
 
 #include <vecmath/forward.h>
@@ -59,6 +60,17 @@ namespace TrenchBroom {
             end   = vm::vec3f(center.x(),     center.y(),     bounds.max.z());
         }
 
+        static const float DetailCullingHysteresis = 1.25f;
+
+        bool cullDetail(const bool wasCulled, const Camera& camera, const vm::bbox3f& bounds, const float size, const float threshold) {
+            if (threshold <= 0.0f || !camera.perspectiveProjection()) {
+                return false;
+            }
+
+            const auto projectedSize = camera.maxProjectedSize(bounds, size);
+            return projectedSize < (wasCulled ? threshold * DetailCullingHysteresis : threshold);
+        }
+
         TextureRenderFunc::~TextureRenderFunc() {}
         void TextureRenderFunc::before(const Assets::Texture* /* texture */) {}
         void TextureRenderFunc::after(const Assets::Texture* /* texture */) {}
@@ -75,6 +87,8 @@ namespace TrenchBroom {
             }
         }
 
+        InstanceRenderFunc::~InstanceRenderFunc() {}
+
         std::vector<vm::vec2f> circle2D(const float radius, const size_t segments) {
             std::vector<vm::vec2f> vertices = circle2D(radius, 0.0f, vm::Cf::two_pi(), segments);
             vertices.push_back(vm::vec2f::zero());
@@ -32,6 +32,8 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class Camera;
+
         void glSetEdgeOffset(double f);
         void glResetEdgeOffset();
 
@@ -39,6 +41,21 @@ namespace TrenchBroom {
         void coordinateSystemVerticesY(const vm::bbox3f& bounds, vm::vec3f& start, vm::vec3f& end);
         void coordinateSystemVerticesZ(const vm::bbox3f& bounds, vm::vec3f& start, vm::vec3f& end);
 
+        /**
+         * Decides whether detail of the given size in world units, placed anywhere within the given bounds, should be
+         * culled in this frame. Detail is culled once its largest size on screen falls below the detail culling pixel
+         * size, but it is only shown again once its size exceeds that threshold by a margin so that it does not flicker
+         * while the camera moves. Nothing is culled in orthographic views or if the threshold is zero.
+         *
+         * @param wasCulled whether the detail was culled in the previous frame
+         * @param camera the camera
+         * @param bounds the bounds containing the detail
+         * @param size the size of the detail in world units
+         * @param threshold the detail culling pixel size, read once per render pass
+         * @return true if the detail should be culled
+         */
+        bool cullDetail(bool wasCulled, const Camera& camera, const vm::bbox3f& bounds, float size, float threshold);
+
         class TextureRenderFunc {
         public:
             virtual ~TextureRenderFunc();
@@ -52,6 +69,17 @@ namespace TrenchBroom {
             void after(const Assets::Texture* texture) override;
         };
 
+        /**
+         * Callbacks for rendering several instances of the same primitives. One is called before an instance is
+         * rendered, e.g. to apply its transformation, and one is called afterwards.
+         */
+        class InstanceRenderFunc {
+        public:
+            virtual ~InstanceRenderFunc();
+            virtual void before(size_t index) = 0;
+            virtual void after(size_t index) = 0;
+        };
+
         std::vector<vm::vec2f> circle2D(float radius, size_t segments);
         std::vector<vm::vec2f> circle2D(float radius, float startAngle, float angleLength, size_t segments);
         std::vector<vm::vec3f> circle2D(float radius, vm::axis::type axis, float startAngle, float angleLength, size_t segments);
@@ -0,0 +1,206 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_SharedVertexBuffer
+#define TrenchBroom_SharedVertexBuffer
+
+#include "Ensure.h"
+#include "Macros.h"
+#include "Renderer/AllocationTracker.h"
+#include "Renderer/BrushRendererArrays.h"
+#include "Renderer/ShaderManager.h"
+#include "Renderer/VboManager.h"
+#include "Renderer/VertexArray.h"
+
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        /**
+         * A vertex buffer object that stores the vertices of many vertex arrays, so that rendering them does not
+         * require switching between buffers.
+         *
+         * The vertex arrays returned by insertVertices refer to ranges of this buffer. A range is released when the
+         * last copy of its vertex array is destroyed, and released ranges are reused for later insertions. The buffer
+         * grows as needed and is reallocated on the next call to prepare when it does.
+         *
+         * The vertex attributes are specified for the entire buffer, so the indices used to render a vertex array of
+         * this buffer must be offset by the array's base vertex. Calling setup before rendering several of the vertex
+         * arrays binds the buffer only once for all of them.
+         *
+         * Must be held in a std::shared_ptr, since every vertex array keeps the buffer alive.
+         *
+         * @tparam VertexSpec the vertex type, e.g. GLVertexTypes::P3T2
+         */
+        template <typename VertexSpec>
+        class SharedVertexBuffer : public std::enable_shared_from_this<SharedVertexBuffer<VertexSpec>> {
+        public:
+            using Vertex = typename VertexSpec::Vertex;
+        private:
+            class Holder : public VertexArray::BaseHolder {
+            private:
+                std::shared_ptr<SharedVertexBuffer> m_buffer;
+                AllocationTracker::Block* m_block;
+            public:
+                Holder(std::shared_ptr<SharedVertexBuffer> buffer, AllocationTracker::Block* block) :
+                m_buffer(std::move(buffer)),
+                m_block(block) {}
+
+                ~Holder() override {
+                    m_buffer->m_allocationTracker.free(m_block);
+                }
+
+                size_t vertexCount() const override {
+                    return m_block->size;
+                }
+
+                size_t sizeInBytes() const override {
+                    return VertexSpec::Size * m_block->size;
+                }
+
+                size_t baseVertex() const override {
+                    return m_block->pos;
+                }
+
+                void prepare(VboManager& vboManager) override {
+                    m_buffer->prepare(vboManager);
+                }
+
+                void setup() override {
+                    if (!m_buffer->m_setup) {
+                        m_buffer->setupVertices();
+                    }
+                }
+
+                void cleanup() override {
+                    if (!m_buffer->m_setup) {
+                        m_buffer->cleanupVertices();
+                    }
+                }
+            };
+
+            VertexHolder<Vertex> m_vertexHolder;
+            AllocationTracker m_allocationTracker;
+            VboManager* m_vboManager;
+            bool m_setup;
+        public:
+            SharedVertexBuffer() :
+            m_vertexHolder(),
+            m_allocationTracker(0),
+            m_vboManager(nullptr),
+            m_setup(false) {}
+
+            /**
+             * Copies the given vertices into this buffer and returns a vertex array that refers to them. The vertices
+             * are uploaded on the next call to prepare.
+             */
+            VertexArray insertVertices(const std::vector<Vertex>& vertices) {
+                if (vertices.empty()) {
+                    return VertexArray();
+                }
+
+                auto* block = m_allocationTracker.allocate(vertices.size());
+                if (block == nullptr) {
+                    const auto newSize = std::max(2u * m_allocationTracker.capacity(),
+                                                  m_allocationTracker.capacity() + vertices.size());
+                    m_allocationTracker.expand(newSize);
+                    m_vertexHolder.resize(newSize);
+
+                    block = m_allocationTracker.allocate(vertices.size());
+                    assert(block != nullptr);
+                }
+
+                auto* dest = m_vertexHolder.getPointerToWriteElementsTo(block->pos, vertices.size());
+                std::copy(std::begin(vertices), std::end(vertices), dest);
+
+                return VertexArray(std::make_shared<Holder>(this->shared_from_this(), block));
+            }
+
+            /**
+             * Returns the number of vertices this buffer can store without growing.
+             */
+            size_t capacity() const {
+                return m_allocationTracker.capacity();
+            }
+
+            /**
+             * Returns the number of vertices stored in this buffer.
+             */
+            size_t vertexCount() const {
+                return m_allocationTracker.usedSize();
+            }
+
+            bool prepared() const {
+                return m_vertexHolder.prepared();
+            }
+
+            void prepare(VboManager& vboManager) {
+                m_vboManager = &vboManager;
+                m_vertexHolder.prepare(vboManager);
+            }
+
+            /**
+             * Binds this buffer and specifies its vertex attributes until cleanup is called. The vertex arrays of this
+             * buffer that are rendered in the meantime skip their own setup and cleanup.
+             *
+             * @return true if the buffer was set up and false if it was never prepared
+             */
+            bool setup() {
+                assert(!m_setup);
+                if (m_vboManager == nullptr) {
+                    return false;
+                }
+
+                setupVertices();
+                m_setup = true;
+                return true;
+            }
+
+            void cleanup() {
+                assert(m_setup);
+                m_setup = false;
+                cleanupVertices();
+            }
+        private:
+            void setupVertices() {
+                ensure(m_vboManager != nullptr, "buffer was not prepared");
+
+                // vertices may have been inserted since the vertex array was prepared
+                if (!prepared()) {
+                    prepare(*m_vboManager);
+                }
+
+                m_vertexHolder.bindBlock();
+                VertexSpec::setup(m_vboManager->shaderManager().currentProgram(), 0);
+            }
+
+            void cleanupVertices() {
+                VertexSpec::cleanup(m_vboManager->shaderManager().currentProgram());
+                m_vertexHolder.unbindBlock();
+            }
+
+            deleteCopyAndMove(SharedVertexBuffer)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_SharedVertexBuffer) */
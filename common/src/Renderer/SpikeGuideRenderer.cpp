@@ -49,9 +49,10 @@ namespace TrenchBroom {
 
         void SpikeGuideRenderer::add(const vm::ray3& ray, const FloatType length, std::shared_ptr<View::MapDocument> document) {
             Model::PickResult pickResult = Model::PickResult::byDistance(document->editorContext());
-            document->pick(ray, pickResult);
+            const auto query = pickResult.query().pickable().type(Model::BrushNode::BrushHitType).occluded().minDistance(1.0);
+            document->pickFirst(ray, pickResult, query);
 
-            const Model::Hit& hit = pickResult.query().pickable().type(Model::BrushNode::BrushHitType).occluded().minDistance(1.0).first();
+            const Model::Hit& hit = query.first();
             if (hit.isMatch()) {
                 if (hit.distance() <= length)
                     addPoint(vm::point_at_distance(ray, hit.distance() - 0.01));
@@ -43,14 +43,11 @@ namespace TrenchBroom {
         const size_t TextRenderer::RectCornerSegments = 3;
         const float TextRenderer::RectCornerRadius = 3.0f;
 
-        TextRenderer::Entry::Entry(std::vector<vm::vec2f>& i_vertices, const vm::vec2f& i_size, const vm::vec3f& i_offset, const Color& i_textColor, const Color& i_backgroundColor) :
-        size(i_size),
+        TextRenderer::Entry::Entry(std::shared_ptr<const TextureFont::GlyphRun> i_glyphRun, const vm::vec3f& i_offset, const Color& i_textColor, const Color& i_backgroundColor) :
+        glyphRun(std::move(i_glyphRun)),
         offset(i_offset),
         textColor(i_textColor),
-        backgroundColor(i_backgroundColor) {
-            using std::swap;
-            swap(vertices, i_vertices);
-        }
+        backgroundColor(i_backgroundColor) {}
 
         TextRenderer::EntryCollection::EntryCollection() :
         textVertexCount(0),
@@ -77,39 +74,44 @@ namespace TrenchBroom {
             if (distance <= 0.0f)
                 return;
 
-            if (!isVisible(renderContext, string, position, distance, onTop))
+            // reject the string before looking up its glyph run
+            if (!isVisible(renderContext, distance, onTop))
                 return;
 
             FontManager& fontManager = renderContext.fontManager();
             TextureFont& font = fontManager.font(m_fontDescriptor);
 
-            std::vector<vm::vec2f> vertices = font.quads(string, true);
+            auto glyphRun = font.glyphRun(string);
+            if (!isInViewport(renderContext, round(glyphRun->size), position))
+                return;
+
             const float alphaFactor = computeAlphaFactor(renderContext, distance, onTop);
-            const vm::vec2f size = font.measure(string);
-            const vm::vec3f offset = position.offset(camera, size);
+            const vm::vec3f offset = position.offset(camera, glyphRun->size);
 
             if (onTop)
-                addEntry(m_entriesOnTop, Entry(vertices, size, offset,
+                addEntry(m_entriesOnTop, Entry(std::move(glyphRun), offset,
                                                Color(textColor, alphaFactor * textColor.a()),
                                                Color(backgroundColor, alphaFactor * backgroundColor.a())));
             else
-                addEntry(m_entries, Entry(vertices, size, offset,
+                addEntry(m_entries, Entry(std::move(glyphRun), offset,
                                           Color(textColor, alphaFactor * textColor.a()),
                                           Color(backgroundColor, alphaFactor * backgroundColor.a())));
         }
 
-        bool TextRenderer::isVisible(RenderContext& renderContext, const AttrString& string, const TextAnchor& position, const float distance, const bool onTop) const {
+        bool TextRenderer::isVisible(RenderContext& renderContext, const float distance, const bool onTop) const {
             if (!onTop) {
                 if (renderContext.render3D() && distance > m_maxViewDistance)
                     return false;
                 if (renderContext.render2D() && renderContext.camera().zoom() < m_minZoomFactor)
                     return false;
             }
+            return true;
+        }
 
+        bool TextRenderer::isInViewport(RenderContext& renderContext, const vm::vec2f& size, const TextAnchor& position) const {
             const Camera& camera = renderContext.camera();
             const Camera::Viewport& viewport = camera.viewport();
 
-            const vm::vec2f size = stringSize(renderContext, string);
             const vm::vec2f offset = vm::vec2f(position.offset(camera, size)) - m_inset;
             const vm::vec2f actualSize = size + 2.0f * m_inset;
 
@@ -134,16 +136,10 @@ namespace TrenchBroom {
             }
         }
 
-        void TextRenderer::addEntry(EntryCollection& collection, const Entry& entry) {
-            collection.entries.push_back(entry);
-            collection.textVertexCount += entry.vertices.size();
+        void TextRenderer::addEntry(EntryCollection& collection, Entry entry) {
+            collection.textVertexCount += entry.glyphRun->vertices.size();
             collection.rectVertexCount += roundedRect2DVertexCount(RectCornerSegments);
-        }
-
-        vm::vec2f TextRenderer::stringSize(RenderContext& renderContext, const AttrString& string) const {
-            FontManager& fontManager = renderContext.fontManager();
-            TextureFont& font = fontManager.font(m_fontDescriptor);
-            return round(font.measure(string));
+            collection.entries.push_back(std::move(entry));
         }
 
         void TextRenderer::doPrepareVertices(VboManager& vboManager) {
@@ -170,8 +166,8 @@ namespace TrenchBroom {
         }
 
         void TextRenderer::addEntry(const Entry& entry, const bool /* onTop */, std::vector<TextVertex>& textVertices, std::vector<RectVertex>& rectVertices) {
-            const std::vector<vm::vec2f>& stringVertices = entry.vertices;
-            const vm::vec2f& stringSize = entry.size;
+            const std::vector<vm::vec2f>& stringVertices = entry.glyphRun->vertices;
+            const vm::vec2f& stringSize = entry.glyphRun->size;
 
             const vm::vec3f& offset = entry.offset;
 
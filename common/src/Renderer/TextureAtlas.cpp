@@ -0,0 +1,213 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TextureAtlas.h"
+
+#include "Ensure.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+
+#include <algorithm> // for std::max, std::remove_if
+#include <cassert>
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TextureAtlas::TextureAtlas(const size_t slotSize, const size_t maxPageCount) :
+        m_slotSize(slotSize),
+        m_maxPageCount(maxPageCount),
+        m_pageCount(0),
+        m_frame(1) {
+            ensure(m_slotSize > 0 && m_slotSize <= PageSize, "slot size must be between 1 and the page size");
+        }
+
+        TextureAtlas::~TextureAtlas() {
+            clear();
+        }
+
+        size_t TextureAtlas::slotSize() const {
+            return m_slotSize;
+        }
+
+        void TextureAtlas::beginFrame() {
+            ++m_frame;
+        }
+
+        bool TextureAtlas::contains(const Assets::Texture& texture) const {
+            return m_slotIndices.count(&texture) > 0u;
+        }
+
+        std::optional<TextureAtlas::Entry> TextureAtlas::entry(const Assets::Texture& texture) {
+            const auto it = m_slotIndices.find(&texture);
+            if (it != std::end(m_slotIndices)) {
+                auto& slot = m_slots[it->second];
+                slot.lastUse = m_frame;
+                return makeEntry(slot, it->second);
+            }
+
+            if (!texture.hasThumbnail()) {
+                return std::nullopt;
+            }
+
+            const auto slotIndex = allocateSlot();
+            if (!slotIndex) {
+                return std::nullopt;
+            }
+
+            auto& slot = m_slots[*slotIndex];
+            copyTexture(texture, slot, *slotIndex);
+
+            slot.texture = &texture;
+            slot.lastUse = m_frame;
+            m_slotIndices[&texture] = *slotIndex;
+            return makeEntry(slot, *slotIndex);
+        }
+
+        void TextureAtlas::prepare() {
+            while (m_pages.size() < m_pageCount) {
+                m_pages.push_back(createPage());
+            }
+
+            if (!m_uploads.empty()) {
+                glAssert(glPixelStorei(GL_UNPACK_ALIGNMENT, 1));
+                for (const auto& upload : m_uploads) {
+                    const auto& slot = m_slots[upload.slotIndex];
+                    const auto indexInPage = upload.slotIndex % slotsPerPage();
+                    const auto x = (indexInPage % slotsPerRow()) * m_slotSize;
+                    const auto y = (indexInPage / slotsPerRow()) * m_slotSize;
+
+                    activatePage(upload.slotIndex / slotsPerPage());
+                    glAssert(glTexSubImage2D(GL_TEXTURE_2D, 0,
+                                             static_cast<GLint>(x), static_cast<GLint>(y),
+                                             static_cast<GLsizei>(slot.width), static_cast<GLsizei>(slot.height),
+                                             GL_RGBA, GL_UNSIGNED_BYTE, upload.pixels.data()));
+                }
+                deactivatePage();
+                m_uploads.clear();
+            }
+        }
+
+        void TextureAtlas::activatePage(const size_t page) const {
+            assert(page < m_pages.size());
+            glAssert(glBindTexture(GL_TEXTURE_2D, m_pages[page]));
+        }
+
+        void TextureAtlas::deactivatePage() const {
+            glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+        }
+
+        void TextureAtlas::clear() {
+            if (!m_pages.empty()) {
+                glAssert(glDeleteTextures(static_cast<GLsizei>(m_pages.size()), m_pages.data()));
+            }
+            m_pages.clear();
+            m_pageCount = 0;
+            m_slots.clear();
+            m_uploads.clear();
+            m_slotIndices.clear();
+        }
+
+        size_t TextureAtlas::slotsPerRow() const {
+            return PageSize / m_slotSize;
+        }
+
+        size_t TextureAtlas::slotsPerPage() const {
+            return slotsPerRow() * slotsPerRow();
+        }
+
+        std::optional<size_t> TextureAtlas::allocateSlot() {
+            if (m_slots.size() < m_maxPageCount * slotsPerPage()) {
+                const auto slotIndex = m_slots.size();
+                if (slotIndex / slotsPerPage() == m_pageCount) {
+                    ++m_pageCount;
+                }
+                m_slots.push_back(Slot{nullptr, 0, 0, 0});
+                return slotIndex;
+            }
+
+            std::optional<size_t> leastRecentlyUsed;
+            for (size_t i = 0; i < m_slots.size(); ++i) {
+                if (m_slots[i].lastUse < m_frame && (!leastRecentlyUsed || m_slots[i].lastUse < m_slots[*leastRecentlyUsed].lastUse)) {
+                    leastRecentlyUsed = i;
+                }
+            }
+
+            if (leastRecentlyUsed) {
+                auto& slot = m_slots[*leastRecentlyUsed];
+                if (slot.texture != nullptr) {
+                    m_slotIndices.erase(slot.texture);
+                    slot.texture = nullptr;
+                }
+            }
+            return leastRecentlyUsed;
+        }
+
+        void TextureAtlas::copyTexture(const Assets::Texture& texture, Slot& slot, const size_t slotIndex) {
+            const auto fits = [&](const vm::vec2s& size) { return std::max(size.x(), size.y()) <= m_slotSize; };
+
+            // if the thumbnail doesn't fit, we scale it down further
+            const auto thumbnailSize = vm::vec2s(texture.thumbnailWidth(), texture.thumbnailHeight());
+            size_t extraLevels = 0u;
+            while (!fits(Assets::sizeAtMipLevel(thumbnailSize.x(), thumbnailSize.y(), extraLevels))) {
+                ++extraLevels;
+            }
+
+            auto buffers = Assets::TextureBufferList();
+            Assets::setMipBufferSize(buffers, extraLevels + 1u, thumbnailSize.x(), thumbnailSize.y(), GL_RGBA);
+            buffers.front() = texture.readThumbnail();
+            Assets::generateMipLevels(buffers, thumbnailSize.x(), thumbnailSize.y(), GL_RGBA);
+
+            const auto size = Assets::sizeAtMipLevel(thumbnailSize.x(), thumbnailSize.y(), extraLevels);
+            slot.width = size.x();
+            slot.height = size.y();
+
+            // the slot may have been reused before its previous texture was uploaded
+            m_uploads.erase(std::remove_if(std::begin(m_uploads), std::end(m_uploads), [&](const auto& upload) { return upload.slotIndex == slotIndex; }), std::end(m_uploads));
+            m_uploads.push_back(Upload{slotIndex, std::move(buffers.back())});
+        }
+
+        GLuint TextureAtlas::createPage() const {
+            GLuint pageId = 0;
+            glAssert(glGenTextures(1, &pageId));
+            glAssert(glBindTexture(GL_TEXTURE_2D, pageId));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
+            glAssert(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+            glAssert(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, static_cast<GLsizei>(PageSize), static_cast<GLsizei>(PageSize), 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+            glAssert(glBindTexture(GL_TEXTURE_2D, 0));
+            return pageId;
+        }
+
+        TextureAtlas::Entry TextureAtlas::makeEntry(const Slot& slot, const size_t slotIndex) const {
+            const auto indexInPage = slotIndex % slotsPerPage();
+            const auto x = static_cast<float>((indexInPage % slotsPerRow()) * m_slotSize);
+            const auto y = static_cast<float>((indexInPage / slotsPerRow()) * m_slotSize);
+            const auto w = static_cast<float>(slot.width);
+            const auto h = static_cast<float>(slot.height);
+            const auto pageSize = static_cast<float>(PageSize);
+
+            // inset the texture coordinates by half a texel so that linear filtering doesn't sample the neighboring slots
+            return Entry{
+                slotIndex / slotsPerPage(),
+                vm::vec2f(x + 0.5f, y + 0.5f) / pageSize,
+                vm::vec2f(x + w - 0.5f, y + h - 0.5f) / pageSize
+            };
+        }
+    }
+}
@@ -0,0 +1,140 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TrenchBroom_TextureAtlas
+#define TrenchBroom_TextureAtlas
+
+#include "Macros.h"
+#include "Assets/TextureBuffer.h"
+#include "Renderer/GL.h"
+
+#include <vecmath/vec.h>
+
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace TrenchBroom {
+    namespace Assets {
+        class Texture;
+    }
+
+    namespace Renderer {
+        /**
+         * Keeps scaled down copies of textures in a few large textures, called pages, so that many textures can be
+         * rendered with one draw call per page.
+         *
+         * Every page is divided into square slots of equal size, and every texture occupies one slot. A texture is
+         * copied from its thumbnail, which is scaled down further if it doesn't fit into a slot. Once all slots are
+         * taken, the slot of the texture that was used least recently is reused for a new texture, unless it was used
+         * in the current frame.
+         *
+         * The copies are independent of the original textures, which need not be uploaded. The atlas refers to
+         * textures by their address, so it must be cleared whenever textures are destroyed.
+         *
+         * The pages are created and the copies are uploaded on the next call to prepare, which must happen before the
+         * pages are activated. Only prepare, activatePage, deactivatePage and clear require a current OpenGL context,
+         * and the destructor does if the atlas was prepared.
+         */
+        class TextureAtlas {
+        public:
+            static constexpr size_t PageSize = 2048;
+
+            struct Entry {
+                size_t page;
+                vm::vec2f minTexCoords;
+                vm::vec2f maxTexCoords;
+            };
+        private:
+            struct Slot {
+                const Assets::Texture* texture;
+                size_t width;
+                size_t height;
+                size_t lastUse;
+            };
+
+            struct Upload {
+                size_t slotIndex;
+                Assets::TextureBuffer pixels;
+            };
+
+            size_t m_slotSize;
+            size_t m_maxPageCount;
+            size_t m_pageCount;
+            std::vector<GLuint> m_pages;
+            std::vector<Slot> m_slots;
+            std::vector<Upload> m_uploads;
+            std::unordered_map<const Assets::Texture*, size_t> m_slotIndices;
+            size_t m_frame;
+        public:
+            /**
+             * Creates an empty atlas.
+             *
+             * @param slotSize the width and height of a slot, must not exceed PageSize
+             * @param maxPageCount the maximum number of pages
+             */
+            TextureAtlas(size_t slotSize, size_t maxPageCount);
+            ~TextureAtlas();
+
+            size_t slotSize() const;
+
+            /**
+             * Starts a new frame. Slots of textures that were only used in earlier frames may be reused afterwards.
+             */
+            void beginFrame();
+
+            /**
+             * Indicates whether the given texture has been copied into this atlas.
+             */
+            bool contains(const Assets::Texture& texture) const;
+
+            /**
+             * Returns the entry of the given texture and marks it as used in the current frame. If the texture is not
+             * contained in this atlas yet, it is copied into a free slot first.
+             *
+             * Returns an empty optional if the texture has no thumbnail or if every slot is used in the current frame.
+             */
+            std::optional<Entry> entry(const Assets::Texture& texture);
+
+            /**
+             * Creates the pages and uploads the textures that were copied into this atlas since the last call.
+             */
+            void prepare();
+
+            void activatePage(size_t page) const;
+            void deactivatePage() const;
+
+            /**
+             * Removes all textures and releases the pages.
+             */
+            void clear();
+        private:
+            size_t slotsPerRow() const;
+            size_t slotsPerPage() const;
+            std::optional<size_t> allocateSlot();
+            void copyTexture(const Assets::Texture& texture, Slot& slot, size_t slotIndex);
+            GLuint createPage() const;
+            Entry makeEntry(const Slot& slot, size_t slotIndex) const;
+
+            deleteCopyAndMove(TextureAtlas)
+        };
+    }
+}
+
+#endif /* defined(TrenchBroom_TextureAtlas) */
@@ -32,6 +32,8 @@
 
 namespace TrenchBroom {
     namespace Renderer {
+        const size_t TextureFont::MaxCachedGlyphRuns = 4096u;
+
         TextureFont::TextureFont(std::unique_ptr<FontTexture> texture, const std::vector<FontGlyph>& glyphs, const int lineHeight, const unsigned char firstChar, const unsigned char charCount) :
         m_texture(std::move(texture)),
         m_glyphs(glyphs),
@@ -172,6 +174,20 @@ namespace TrenchBroom {
             return measureString.size();
         }
 
+        std::shared_ptr<const TextureFont::GlyphRun> TextureFont::glyphRun(const AttrString& string) const {
+            auto it = m_glyphRunCache.find(string);
+            if (it == std::end(m_glyphRunCache)) {
+                if (m_glyphRunCache.size() >= MaxCachedGlyphRuns) {
+                    // strings that change every frame, such as measurement labels, would otherwise fill the cache
+                    m_glyphRunCache.clear();
+                }
+
+                auto glyphRun = std::make_shared<const GlyphRun>(GlyphRun{quads(string, true), measure(string)});
+                it = m_glyphRunCache.emplace(string, std::move(glyphRun)).first;
+            }
+            return it->second;
+        }
+
         std::vector<vm::vec2f> TextureFont::quads(const std::string& string, const bool clockwise, const vm::vec2f& offset) const {
             std::vector<vm::vec2f> result;
             result.reserve(string.length() * 4 * 2);
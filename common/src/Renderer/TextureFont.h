@@ -21,28 +21,44 @@
 #define TrenchBroom_Font
 
 #include "Macros.h"
+#include "Renderer/AttrString.h"
 
 #include <vecmath/forward.h>
 #include <vecmath/vec.h>
 
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
 
 namespace TrenchBroom {
     namespace Renderer {
-        class AttrString;
         class FontGlyph;
         class FontTexture;
 
         class TextureFont {
+        public:
+            /**
+             * The laid out quads of a string, as returned by quads(string, true), and its size.
+             */
+            struct GlyphRun {
+                std::vector<vm::vec2f> vertices;
+                vm::vec2f size;
+            };
         private:
+            /**
+             * The cache is cleared once it holds this many glyph runs.
+             */
+            static const size_t MaxCachedGlyphRuns;
+
             std::unique_ptr<FontTexture> m_texture;
             std::vector<FontGlyph> m_glyphs;
             int m_lineHeight;
 
             unsigned char m_firstChar;
             unsigned char m_charCount;
+
+            mutable std::map<AttrString, std::shared_ptr<const GlyphRun>> m_glyphRunCache;
         public:
             TextureFont(std::unique_ptr<FontTexture> texture, const std::vector<FontGlyph>& glyphs, int lineHeight, unsigned char firstChar, unsigned char charCount);
             ~TextureFont();
@@ -52,6 +68,12 @@ namespace TrenchBroom {
             std::vector<vm::vec2f> quads(const AttrString& string, bool clockwise, const vm::vec2f& offset = vm::vec2f::zero()) const;
             vm::vec2f measure(const AttrString& string) const;
 
+            /**
+             * Returns the glyph run of the given string. Glyph runs are cached, so a string is laid out only when it
+             * is first rendered with this font.
+             */
+            std::shared_ptr<const GlyphRun> glyphRun(const AttrString& string) const;
+
             std::vector<vm::vec2f> quads(const std::string& string, bool clockwise, const vm::vec2f& offset = vm::vec2f::zero()) const;
             vm::vec2f measure(const std::string& string) const;
 
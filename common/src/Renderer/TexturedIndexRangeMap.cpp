@@ -108,6 +108,14 @@ namespace TrenchBroom {
             }
         }
 
+        TexturedIndexRangeMap TexturedIndexRangeMap::offset(const size_t baseVertex) const {
+            auto result = TexturedIndexRangeMap();
+            for (const auto& entry : *m_data) {
+                result.add(entry.first, entry.second.offset(baseVertex));
+            }
+            return result;
+        }
+
         void TexturedIndexRangeMap::render(VertexArray& vertexArray) {
             DefaultTextureRenderFunc func;
             render(vertexArray, func);
@@ -124,6 +132,22 @@ namespace TrenchBroom {
             }
         }
 
+        void TexturedIndexRangeMap::renderInstances(VertexArray& vertexArray, const size_t instanceCount, InstanceRenderFunc& func) {
+            DefaultTextureRenderFunc textureFunc;
+            for (const auto& entry : *m_data) {
+                const auto* texture = entry.first;
+                const auto& indexArray = entry.second;
+
+                textureFunc.before(texture);
+                for (size_t i = 0; i < instanceCount; ++i) {
+                    func.before(i);
+                    indexArray.render(vertexArray);
+                    func.after(i);
+                }
+                textureFunc.after(texture);
+            }
+        }
+
         void TexturedIndexRangeMap::forEachPrimitive(std::function<void(const Texture*, PrimType, size_t, size_t)> func) const {
             for (const auto& entry : *m_data) {
                 const auto* texture = entry.first;
@@ -30,6 +30,7 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class InstanceRenderFunc;
         class TextureRenderFunc;
         class VertexArray;
 
@@ -151,6 +152,14 @@ namespace TrenchBroom {
              */
             void add(const TexturedIndexRangeMap& other);
 
+            /**
+             * Returns a copy of this index range map where every range starts the given number of vertices later.
+             *
+             * @param baseVertex the number of vertices to offset the ranges by
+             * @return the offset index range map
+             */
+            TexturedIndexRangeMap offset(size_t baseVertex) const;
+
             /**
              * Renders the primitives stored in this index range map using the vertices in the given vertex array.
              * The primitives are batched by their associated textures.
@@ -169,6 +178,18 @@ namespace TrenchBroom {
              */
             void render(VertexArray& vertexArray, TextureRenderFunc& func);
 
+            /**
+             * Renders the primitives stored in this index range map the given number of times using the vertices in
+             * the given vertex array. Every texture is activated once, and all instances are rendered with it before
+             * switching to the next texture. The given render function type provides two callbacks. One is called
+             * before an instance is rendered, and one is called afterwards.
+             *
+             * @param vertexArray the vertex array to render with
+             * @param instanceCount the number of instances to render
+             * @param func the instance callbacks
+             */
+            void renderInstances(VertexArray& vertexArray, size_t instanceCount, InstanceRenderFunc& func);
+
             /**
              * Invokes the given function for each primitive stored in this map.
              *
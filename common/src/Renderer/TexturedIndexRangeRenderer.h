@@ -32,6 +32,7 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class InstanceRenderFunc;
         class VboManager;
         class TextureRenderFunc;
 
@@ -44,6 +45,12 @@ namespace TrenchBroom {
             virtual void prepare(VboManager& vboManager) = 0;
             virtual void render() = 0;
             virtual void render(TextureRenderFunc& func) = 0;
+
+            /**
+             * Renders the given number of instances of this renderer's primitives. The vertices are set up and every
+             * texture is activated only once for all instances.
+             */
+            virtual void renderInstances(size_t instanceCount, InstanceRenderFunc& func) = 0;
         };
 
         class TexturedIndexRangeRenderer : public TexturedRenderer {
@@ -61,6 +68,7 @@ namespace TrenchBroom {
             void prepare(VboManager& vboManager) override;
             void render() override;
             void render(TextureRenderFunc& func) override;
+            void renderInstances(size_t instanceCount, InstanceRenderFunc& func) override;
         };
 
         class MultiTexturedIndexRangeRenderer : public TexturedRenderer {
@@ -75,6 +83,7 @@ namespace TrenchBroom {
             void prepare(VboManager& vboManager) override;
             void render() override;
             void render(TextureRenderFunc& func) override;
+            void renderInstances(size_t instanceCount, InstanceRenderFunc& func) override;
         };
     }
 }
@@ -40,6 +40,7 @@ namespace TrenchBroom {
              */
             GLenum m_type;
             size_t m_capacity;
+            GLenum m_usage;
             GLuint m_bufferId;
 
             /**
@@ -101,6 +102,33 @@ namespace TrenchBroom {
 
                 return size;
             }
+
+            /**
+             * Replaces the entire contents of the VBO block with the given C array, which must fill it exactly.
+             *
+             * Unlike writing to the block, this respecifies the buffer's storage, so the driver can hand out new
+             * storage while the GPU is still reading the old contents instead of waiting for it to finish.
+             *
+             * @tparam T        element type
+             * @param array     elements to write
+             * @param count     number of elements to write
+             * @return          number of bytes written
+             */
+            template <typename T>
+            size_t replaceArray(const T* array, const size_t count) {
+                const size_t size = count * sizeof(T);
+                assert(size == m_capacity);
+
+                static_assert(std::is_trivially_copyable<T>::value);
+                static_assert(std::is_standard_layout<T>::value);
+
+                const GLvoid* ptr = static_cast<const GLvoid*>(array);
+                const GLsizeiptr sizei = static_cast<GLsizeiptr>(size);
+                glAssert(glBindBuffer(m_type, m_bufferId));
+                glAssert(glBufferData(m_type, sizei, ptr, m_usage));
+
+                return size;
+            }
         };
     }
 }
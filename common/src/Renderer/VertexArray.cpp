@@ -27,6 +27,10 @@ namespace TrenchBroom {
     namespace Renderer {
         VertexArray::BaseHolder::~BaseHolder() = default;
 
+        size_t VertexArray::BaseHolder::baseVertex() const {
+            return 0;
+        }
+
         VertexArray::VertexArray() :
         m_prepared(false),
         m_setup(false) {}
@@ -43,6 +47,10 @@ namespace TrenchBroom {
             return m_holder.get() == nullptr ? 0 : m_holder->vertexCount();
         }
 
+        size_t VertexArray::baseVertex() const {
+            return m_holder.get() == nullptr ? 0 : m_holder->baseVertex();
+        }
+
         bool VertexArray::prepared() const {
             return m_prepared;
         }
@@ -75,7 +83,7 @@ namespace TrenchBroom {
         }
 
         void VertexArray::render(const PrimType primType) {
-            render(primType, 0, static_cast<GLsizei>(vertexCount()));
+            render(primType, static_cast<GLint>(baseVertex()), static_cast<GLsizei>(vertexCount()));
         }
 
         void VertexArray::render(const PrimType primType, const GLint index, const GLsizei count) {
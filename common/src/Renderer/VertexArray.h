@@ -37,6 +37,9 @@ namespace TrenchBroom {
     namespace Renderer {
         enum class PrimType;
 
+        template <typename VertexSpec>
+        class SharedVertexBuffer;
+
         /**
          * Represents an array of vertices. Optionally, multiple instances of this class can share the same data.
          * Vertex arrays can be copied around without incurring the cost of copying the actual data.
@@ -46,12 +49,16 @@ namespace TrenchBroom {
          */
         class VertexArray {
         private:
+            template <typename VertexSpec>
+            friend class SharedVertexBuffer;
+
             class BaseHolder {
             public:
                 virtual ~BaseHolder();
 
                 virtual size_t vertexCount() const = 0;
                 virtual size_t sizeInBytes() const = 0;
+                virtual size_t baseVertex() const;
 
                 virtual void prepare(VboManager& vboManager) = 0;
                 virtual void setup() = 0;
@@ -222,6 +229,15 @@ namespace TrenchBroom {
              */
             size_t vertexCount() const;
 
+            /**
+             * Returns the index of the first vertex of this vertex array in the buffer object that stores it. This is
+             * only non-zero for vertex arrays that share a buffer object with other vertex arrays. The indices passed
+             * to the render methods that take explicit indices must be offset by it.
+             *
+             * @return the index of the first vertex of this vertex array in its buffer object
+             */
+            size_t baseVertex() const;
+
             /**
              * Indicates whether this vertex array way prepared. Preparing a vertex array uploads its data into a
              * vertex buffer object.
@@ -261,7 +277,7 @@ namespace TrenchBroom {
              * Renders a sub range of this vertex array as a range of primitives of the given type.
              *
              * @param primType the primitive type to render
-             * @param index the index of the first vertex in this vertex array to render
+             * @param index the index of the first vertex to render, offset by baseVertex()
              * @param count the number of vertices to render
              */
             void render(PrimType primType, GLint index, GLsizei count);
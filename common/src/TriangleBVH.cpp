@@ -0,0 +1,221 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TriangleBVH.h"
+
+#include <vecmath/vec.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace TrenchBroom {
+    struct TriangleBVH::BuildTriangle {
+        vm::vec3f min;
+        vm::vec3f max;
+        vm::vec3f center;
+        size_t index;
+    };
+
+    // the hierarchy is balanced and has less than 2^32 nodes, so the traversal stack never holds more nodes than this
+    static const size_t MaxDepth = 64;
+
+    static bool intersectsNode(const vm::vec3f& min, const vm::vec3f& max, const vm::vec3f& origin, const vm::vec3f& invDirection, const float maxDistance) {
+        auto tMin = 0.0f;
+        auto tMax = maxDistance;
+        for (size_t i = 0; i < 3; ++i) {
+            const auto t1 = (min[i] - origin[i]) * invDirection[i];
+            const auto t2 = (max[i] - origin[i]) * invDirection[i];
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        return tMin <= tMax;
+    }
+
+    TriangleBVH::TriangleBVH(const std::vector<vm::vec3f>& points) :
+    m_triangleCount(points.size() / 3u) {
+        assert(points.size() % 3u == 0u);
+
+        if (m_triangleCount == 0u) {
+            return;
+        }
+
+        auto triangles = std::vector<BuildTriangle>();
+        triangles.reserve(m_triangleCount);
+        for (size_t i = 0; i < m_triangleCount; ++i) {
+            const auto& p1 = points[3u * i + 0u];
+            const auto& p2 = points[3u * i + 1u];
+            const auto& p3 = points[3u * i + 2u];
+
+            const auto min = vm::min(p1, vm::min(p2, p3));
+            const auto max = vm::max(p1, vm::max(p2, p3));
+            triangles.push_back(BuildTriangle{min, max, (min + max) / 2.0f, i});
+        }
+
+        // a binary tree with at most PacketSize triangles per leaf has less than 2 * n / PacketSize nodes
+        m_nodes.reserve(2u * m_triangleCount / PacketSize + 1u);
+        m_packets.reserve(m_triangleCount / PacketSize + 1u);
+        build(triangles, 0u, m_triangleCount, points);
+    }
+
+    bool TriangleBVH::empty() const {
+        return m_nodes.empty();
+    }
+
+    size_t TriangleBVH::triangleCount() const {
+        return m_triangleCount;
+    }
+
+    float TriangleBVH::intersect(const vm::ray3f& ray) const {
+        if (empty()) {
+            return vm::nan<float>();
+        }
+
+        const auto& origin = ray.origin;
+        const auto& direction = ray.direction;
+        const auto invDirection = vm::vec3f(1.0f / direction[0], 1.0f / direction[1], 1.0f / direction[2]);
+
+        auto closestDistance = std::numeric_limits<float>::infinity();
+
+        size_t stack[MaxDepth];
+        size_t stackSize = 0u;
+        stack[stackSize++] = 0u;
+
+        while (stackSize > 0u) {
+            const auto nodeIndex = stack[--stackSize];
+            const auto& node = m_nodes[nodeIndex];
+            if (!intersectsNode(node.min, node.max, origin, invDirection, closestDistance)) {
+                continue;
+            }
+
+            if (node.count == 0u) {
+                // visit the child that is closer to the ray origin first
+                assert(stackSize + 2u <= MaxDepth);
+                if (direction[node.axis] < 0.0f) {
+                    stack[stackSize++] = nodeIndex + 1u;
+                    stack[stackSize++] = node.index;
+                } else {
+                    stack[stackSize++] = node.index;
+                    stack[stackSize++] = nodeIndex + 1u;
+                }
+            } else {
+                // Möller-Trumbore for all triangles of the packet at once, unused slots are degenerate and never hit
+                const auto& packet = m_packets[node.index];
+                float distances[PacketSize];
+                for (size_t i = 0; i < PacketSize; ++i) {
+                    const auto e1x = packet.e1[0][i], e1y = packet.e1[1][i], e1z = packet.e1[2][i];
+                    const auto e2x = packet.e2[0][i], e2y = packet.e2[1][i], e2z = packet.e2[2][i];
+
+                    const auto px = direction[1] * e2z - direction[2] * e2y;
+                    const auto py = direction[2] * e2x - direction[0] * e2z;
+                    const auto pz = direction[0] * e2y - direction[1] * e2x;
+                    const auto det = e1x * px + e1y * py + e1z * pz;
+                    const auto invDet = 1.0f / det;
+
+                    const auto tx = origin[0] - packet.p[0][i];
+                    const auto ty = origin[1] - packet.p[1][i];
+                    const auto tz = origin[2] - packet.p[2][i];
+                    const auto u = (tx * px + ty * py + tz * pz) * invDet;
+
+                    const auto qx = ty * e1z - tz * e1y;
+                    const auto qy = tz * e1x - tx * e1z;
+                    const auto qz = tx * e1y - ty * e1x;
+                    const auto v = (direction[0] * qx + direction[1] * qy + direction[2] * qz) * invDet;
+                    const auto t = (e2x * qx + e2y * qy + e2z * qz) * invDet;
+
+                    const auto hit = std::abs(det) > vm::constants<float>::almost_zero() &&
+                                     u >= 0.0f && v >= 0.0f && u + v <= 1.0f && t >= 0.0f;
+                    distances[i] = hit ? t : std::numeric_limits<float>::infinity();
+                }
+
+                for (size_t i = 0; i < PacketSize; ++i) {
+                    closestDistance = std::min(closestDistance, distances[i]);
+                }
+            }
+        }
+
+        return closestDistance < std::numeric_limits<float>::infinity() ? closestDistance : vm::nan<float>();
+    }
+
+    size_t TriangleBVH::build(std::vector<BuildTriangle>& triangles, const size_t first, const size_t last, const std::vector<vm::vec3f>& points) {
+        assert(first < last);
+
+        auto min = triangles[first].min;
+        auto max = triangles[first].max;
+        auto centerMin = triangles[first].center;
+        auto centerMax = triangles[first].center;
+        for (size_t i = first + 1u; i < last; ++i) {
+            min = vm::min(min, triangles[i].min);
+            max = vm::max(max, triangles[i].max);
+            centerMin = vm::min(centerMin, triangles[i].center);
+            centerMax = vm::max(centerMax, triangles[i].center);
+        }
+
+        const auto nodeIndex = m_nodes.size();
+        m_nodes.push_back(Node{min, max, 0u, 0u, 0u});
+
+        const auto count = last - first;
+        if (count <= PacketSize) {
+            auto packet = Packet{};
+            for (size_t i = 0; i < count; ++i) {
+                const auto index = triangles[first + i].index;
+                const auto& p1 = points[3u * index + 0u];
+                const auto& p2 = points[3u * index + 1u];
+                const auto& p3 = points[3u * index + 2u];
+                for (size_t j = 0; j < 3; ++j) {
+                    packet.p[j][i] = p1[j];
+                    packet.e1[j][i] = p2[j] - p1[j];
+                    packet.e2[j][i] = p3[j] - p1[j];
+                }
+            }
+
+            m_nodes[nodeIndex].index = static_cast<uint32_t>(m_packets.size());
+            m_nodes[nodeIndex].count = static_cast<uint16_t>(count);
+            m_packets.push_back(packet);
+        } else {
+            // split at the median of the triangle centers along the axis where the centers are spread the most
+            const auto extents = centerMax - centerMin;
+            auto axis = size_t(0);
+            if (extents[1] > extents[axis]) {
+                axis = 1u;
+            }
+            if (extents[2] > extents[axis]) {
+                axis = 2u;
+            }
+
+            const auto mid = first + count / 2u;
+            std::nth_element(std::next(std::begin(triangles), static_cast<std::ptrdiff_t>(first)),
+                             std::next(std::begin(triangles), static_cast<std::ptrdiff_t>(mid)),
+                             std::next(std::begin(triangles), static_cast<std::ptrdiff_t>(last)),
+                             [&](const auto& lhs, const auto& rhs) { return lhs.center[axis] < rhs.center[axis]; });
+
+            build(triangles, first, mid, points);
+            const auto secondChild = build(triangles, mid, last, points);
+
+            m_nodes[nodeIndex].index = static_cast<uint32_t>(secondChild);
+            m_nodes[nodeIndex].axis = static_cast<uint16_t>(axis);
+        }
+
+        return nodeIndex;
+    }
+}
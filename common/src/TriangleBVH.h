@@ -0,0 +1,91 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRENCHBROOM_TRIANGLEBVH_H
+#define TRENCHBROOM_TRIANGLEBVH_H
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace TrenchBroom {
+    /**
+     * A bounding volume hierarchy over a fixed set of triangles that allows for quick ray intersection queries.
+     *
+     * Unlike AABBTree, the hierarchy is built at once from all triangles and cannot be modified afterwards. The nodes
+     * are stored in a single array in depth first order. The triangles of a leaf are stored in a packet whose
+     * components are laid out in separate arrays, so that a ray is tested against all triangles of a leaf in one loop
+     * that the compiler can vectorize.
+     */
+    class TriangleBVH {
+    public:
+        /**
+         * The maximum number of triangles in a leaf.
+         */
+        static constexpr size_t PacketSize = 4;
+    private:
+        struct Node {
+            vm::vec3f min;
+            vm::vec3f max;
+            // the packet of a leaf, or the second child of an inner node (the first child follows its parent)
+            uint32_t index;
+            // the number of triangles of a leaf, or 0 for inner nodes
+            uint16_t count;
+            // the axis along which the children of an inner node are split
+            uint16_t axis;
+        };
+
+        struct Packet {
+            // the first point and the two edges of every triangle, one array per component
+            float p[3][PacketSize];
+            float e1[3][PacketSize];
+            float e2[3][PacketSize];
+        };
+
+        struct BuildTriangle;
+
+        std::vector<Node> m_nodes;
+        std::vector<Packet> m_packets;
+        size_t m_triangleCount;
+    public:
+        /**
+         * Builds a hierarchy over the given triangles, where every three consecutive points form a triangle.
+         *
+         * @param points the triangle points, the number of points must be a multiple of 3
+         */
+        explicit TriangleBVH(const std::vector<vm::vec3f>& points);
+
+        bool empty() const;
+        size_t triangleCount() const;
+
+        /**
+         * Intersects the triangles with the given ray.
+         *
+         * @param ray the ray to intersect
+         * @return the distance to the closest point of intersection or NaN if the given ray does not hit any triangle
+         */
+        float intersect(const vm::ray3f& ray) const;
+    private:
+        size_t build(std::vector<BuildTriangle>& triangles, size_t first, size_t last, const std::vector<vm::vec3f>& points);
+    };
+}
+
+#endif //TRENCHBROOM_TRIANGLEBVH_H
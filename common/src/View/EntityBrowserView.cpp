@@ -150,6 +150,8 @@ namespace TrenchBroom {
 
             const Renderer::FontDescriptor font(fontPath, static_cast<size_t>(fontSize));
 
+            loadModels();
+
             if (m_group) {
                 for (const auto& group : m_entityDefinitionManager.groups()) {
                     const auto& definitions = group.definitions(Assets::EntityDefinitionType::PointEntity, m_sortOrder);
@@ -183,6 +185,20 @@ namespace TrenchBroom {
             return prefix + name;
         }
 
+        void EntityBrowserView::loadModels() {
+            // errors are logged when the cells are added to the layout
+            NullLogger logger;
+
+            const auto& definitions = m_entityDefinitionManager.definitions(Assets::EntityDefinitionType::PointEntity, m_sortOrder);
+            const auto specs = kdl::vec_transform(definitions, [&](const auto* definition) {
+                const auto* pointEntityDefinition = static_cast<const Assets::PointEntityDefinition*>(definition);
+                return Assets::safeGetModelSpecification(logger, pointEntityDefinition->name(), [&]() {
+                    return pointEntityDefinition->defaultModel();
+                });
+            });
+            m_entityModelManager.loadModels(specs);
+        }
+
         void EntityBrowserView::addEntityToLayout(Layout& layout, const Assets::PointEntityDefinition* definition, const Renderer::FontDescriptor& font) {
             if ((!m_hideUnused || definition->usageCount() > 0) &&
                 (m_filterText.empty() || kdl::ci::str_contains(definition->name(), m_filterText))) {
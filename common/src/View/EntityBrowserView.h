@@ -100,6 +100,7 @@ namespace TrenchBroom {
             bool dndEnabled() override;
             QString dndData(const Cell& cell) override;
 
+            void loadModels();
             void addEntityToLayout(Layout& layout, const Assets::PointEntityDefinition* definition, const Renderer::FontDescriptor& font);
 
             void doClear() override;
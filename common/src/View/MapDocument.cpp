@@ -27,6 +27,7 @@
 #include "Assets/EntityDefinitionGroup.h"
 #include "Assets/EntityDefinitionManager.h"
 #include "Assets/EntityModelManager.h"
+#include "Assets/ModelDefinition.h"
 #include "Assets/Texture.h"
 #include "Assets/TextureManager.h"
 #include "EL/ELExceptions.h"
@@ -144,6 +145,7 @@
 #include <sstream>
 #include <string>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
@@ -151,6 +153,11 @@ namespace TrenchBroom {
         const vm::bbox3 MapDocument::DefaultWorldBounds(-32768.0, 32768.0);
         const std::string MapDocument::DefaultDocumentName("unnamed.map");
 
+        static size_t textureMemoryBudget() {
+            const auto megabytes = std::max(pref(Preferences::TextureMemoryBudget), 0);
+            return static_cast<size_t>(megabytes) * 1024u * 1024u;
+        }
+
         MapDocument::MapDocument() :
         m_worldBounds(DefaultWorldBounds),
         m_world(nullptr),
@@ -176,6 +183,7 @@ namespace TrenchBroom {
         m_selectionBoundsValid(true),
         m_viewEffectsService(nullptr),
         m_repeatStack(std::make_unique<RepeatStack>()) {
+                m_textureManager->setMemoryBudget(textureMemoryBudget());
                 bindObservers();
         }
 
@@ -1996,6 +2004,11 @@ namespace TrenchBroom {
                 m_world->pick(pickRay, pickResult);
         }
 
+        void MapDocument::pickFirst(const vm::ray3& pickRay, Model::PickResult& pickResult, const Model::HitQuery& query) const {
+            if (m_world != nullptr)
+                m_world->pickFirst(pickRay, pickResult, query);
+        }
+
         std::vector<Model::Node*> MapDocument::findNodesContaining(const vm::vec3& point) const {
             std::vector<Model::Node*> result;
             if (m_world != nullptr) {
@@ -2277,10 +2290,23 @@ namespace TrenchBroom {
         private:
             Logger& m_logger;
             Assets::EntityModelManager& m_manager;
+            std::vector<std::pair<Model::EntityNode*, Assets::ModelSpecification>> m_entities;
         public:
             explicit SetEntityModels(Logger& logger, Assets::EntityModelManager& manager) :
             m_logger(logger),
             m_manager(manager) {}
+
+            /**
+             * Sets the model frames of the visited entities. The models are loaded all at once so that they can be
+             * loaded concurrently.
+             */
+            void apply() {
+                m_manager.loadModels(kdl::vec_transform(m_entities, [](const auto& pair) { return pair.second; }));
+                for (const auto& [entity, modelSpec] : m_entities) {
+                    const auto* frame = m_manager.frame(modelSpec);
+                    entity->setModelFrame(frame);
+                }
+            }
         private:
             void doVisit(Model::WorldNode*) override         {}
             void doVisit(Model::LayerNode*) override         {}
@@ -2289,8 +2315,7 @@ namespace TrenchBroom {
                 const auto modelSpec = Assets::safeGetModelSpecification(m_logger, entity->classname(), [&]() {
                     return entity->modelSpecification();
                 });
-                const auto* frame = m_manager.frame(modelSpec);
-                entity->setModelFrame(frame);
+                m_entities.emplace_back(entity, modelSpec);
             }
             void doVisit(Model::BrushNode*) override         {}
         };
@@ -2307,11 +2332,13 @@ namespace TrenchBroom {
         void MapDocument::setEntityModels() {
             SetEntityModels visitor(*this, *m_entityModelManager);
             m_world->acceptAndRecurse(visitor);
+            visitor.apply();
         }
 
         void MapDocument::setEntityModels(const std::vector<Model::Node*>& nodes) {
             SetEntityModels visitor(*this, *m_entityModelManager);
             Model::Node::acceptAndRecurse(std::begin(nodes), std::end(nodes), visitor);
+            visitor.apply();
         }
 
         void MapDocument::unsetEntityModels() {
@@ -2609,6 +2636,11 @@ namespace TrenchBroom {
                        path == Preferences::TextureMagFilter.path()) {
                 m_entityModelManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
                 m_textureManager->setTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
+            } else if (path == Preferences::TextureMemoryBudget.path()) {
+                m_textureManager->setMemoryBudget(textureMemoryBudget());
+            } else if (path == Preferences::TextureCompression.path()) {
+                reloadTextures();
+                setTextures();
             }
         }
 
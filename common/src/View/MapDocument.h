@@ -58,6 +58,7 @@ namespace TrenchBroom {
         class EditorContext;
         enum class ExportFormat;
         class Game;
+        class HitQuery;
         class Issue;
         enum class MapFormat;
         class PickResult;
@@ -473,6 +474,7 @@ namespace TrenchBroom {
             void commitPendingAssets();
         public: // picking
             void pick(const vm::ray3& pickRay, Model::PickResult& pickResult) const;
+            void pickFirst(const vm::ray3& pickRay, Model::PickResult& pickResult, const Model::HitQuery& query) const;
             std::vector<Model::Node*> findNodesContaining(const vm::vec3& point) const;
         private: // world management
             void createWorld(Model::MapFormat mapFormat, const vm::bbox3& worldBounds, std::shared_ptr<Model::Game> game);
@@ -436,7 +436,10 @@ namespace TrenchBroom {
           Notifier<const std::vector<Model::Node*> &>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
 
           Model::TransformObjectVisitor visitor(m_worldBounds, transform, lockTextures);
-          Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
+          {
+              const Model::WorldNode::DeferNodeTreeUpdates deferNodeTreeUpdates(*m_world);
+              Model::Node::accept(std::begin(nodes), std::end(nodes), visitor);
+          }
 
           invalidateSelectionBounds();
 
@@ -924,7 +927,10 @@ namespace TrenchBroom {
                 Notifier<const std::vector<Model::Node*>&>::NotifyBeforeAndAfter notifyParents(nodesWillChangeNotifier, nodesDidChangeNotifier, parents);
                 Notifier<const std::vector<Model::Node*>&>::NotifyBeforeAndAfter notifyNodes(nodesWillChangeNotifier, nodesDidChangeNotifier, nodes);
 
-                restoreNodesAndLogErrors();
+                {
+                    const Model::WorldNode::DeferNodeTreeUpdates deferNodeTreeUpdates(*m_world);
+                    restoreNodesAndLogErrors();
+                }
 
                 setTextures(m_selectedNodes.nodes());
                 invalidateSelectionBounds();
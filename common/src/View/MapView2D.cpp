@@ -72,7 +72,8 @@ namespace TrenchBroom {
         MapView2D::MapView2D(std::weak_ptr<MapDocument> document, MapViewToolBox& toolBox, Renderer::MapRenderer& renderer,
                              GLContextManager& contextManager, ViewPlane viewPlane, Logger* logger) :
         MapViewBase(logger, document, toolBox, renderer, contextManager),
-        m_camera(std::make_unique<Renderer::OrthographicCamera>()) {
+        m_camera(std::make_unique<Renderer::OrthographicCamera>()),
+        m_gridRenderer(std::make_unique<Renderer::GridRenderer>()) {
             bindObservers();
             initializeCamera(viewPlane);
             initializeToolChain(toolBox);
@@ -367,7 +368,8 @@ namespace TrenchBroom {
 
         void MapView2D::doRenderGrid(Renderer::RenderContext&, Renderer::RenderBatch& renderBatch) {
             auto document = kdl::mem_lock(m_document);
-            renderBatch.addOneShot(new Renderer::GridRenderer(*m_camera, document->worldBounds()));
+            m_gridRenderer->update(*m_camera, document->worldBounds());
+            renderBatch.add(m_gridRenderer.get());
         }
 
         void MapView2D::doRenderMap(Renderer::MapRenderer& renderer, Renderer::RenderContext& renderContext, Renderer::RenderBatch& renderBatch) {
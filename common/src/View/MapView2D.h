@@ -34,6 +34,7 @@ namespace TrenchBroom {
     }
 
     namespace Renderer {
+        class GridRenderer;
         class MapRenderer;
         class OrthographicCamera;
         class RenderBatch;
@@ -52,6 +53,7 @@ namespace TrenchBroom {
             } ViewPlane;
         private:
             std::unique_ptr<Renderer::OrthographicCamera> m_camera;
+            std::unique_ptr<Renderer::GridRenderer> m_gridRenderer;
         public:
             MapView2D(std::weak_ptr<MapDocument> document, MapViewToolBox& toolBox, Renderer::MapRenderer& renderer,
                       GLContextManager& contextManager, ViewPlane viewPlane, Logger* logger);
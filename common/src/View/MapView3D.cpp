@@ -214,8 +214,10 @@ namespace TrenchBroom {
                 const auto& editorContext = document->editorContext();
                 auto pickResult = Model::PickResult::byDistance(editorContext);
 
-                document->pick(pickRay, pickResult);
-                const auto& hit = pickResult.query().pickable().type(Model::BrushNode::BrushHitType).occluded().first();
+                const auto query = pickResult.query().pickable().type(Model::BrushNode::BrushHitType).occluded();
+                document->pickFirst(pickRay, pickResult, query);
+
+                const auto& hit = query.first();
                 if (const auto faceHandle = Model::hitToFaceHandle(hit)) {
                     const auto& face = faceHandle->face();
                     return grid.moveDeltaForBounds(face.boundary(), bounds, document->worldBounds(), pickRay);
@@ -30,6 +30,7 @@
 #include "Renderer/PrimType.h"
 #include "Renderer/Shaders.h"
 #include "Renderer/ShaderManager.h"
+#include "Renderer/TextureAtlas.h"
 #include "Renderer/TextureFont.h"
 #include "Renderer/Transformation.h"
 #include "Renderer/VertexArray.h"
@@ -44,7 +45,11 @@
 #include <vecmath/mat.h>
 #include <vecmath/mat_ext.h>
 
+#include <cmath>
+#include <map>
+#include <optional>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <QTextStream>
@@ -63,7 +68,8 @@ namespace TrenchBroom {
         m_group(false),
         m_hideUnused(false),
         m_sortOrder(TextureSortOrder::Name),
-        m_selectedTexture(nullptr) {
+        m_selectedTexture(nullptr),
+        m_atlasGeneration(0) {
             auto doc = kdl::mem_lock(m_document);
             doc->textureUsageCountsDidChangeNotifier.addObserver(this, &TextureBrowserView::usageCountDidChange);
         }
@@ -74,6 +80,11 @@ namespace TrenchBroom {
                 doc->textureUsageCountsDidChangeNotifier.removeObserver(this, &TextureBrowserView::usageCountDidChange);
             }
             clear();
+
+            // Deleting m_atlas releases its textures, so we need to be current
+            // see: http://doc.qt.io/qt-5/qopenglwidget.html#resource-initialization-and-cleanup
+            makeCurrent();
+            m_atlas.reset();
         }
 
         void TextureBrowserView::setSortOrder(const TextureSortOrder sortOrder) {
@@ -285,6 +296,8 @@ namespace TrenchBroom {
         void TextureBrowserView::doRender(Layout& layout, const float y, const float height) {
             auto doc = kdl::mem_lock(m_document);
             doc->textureManager().commitChanges();
+            validateAtlas();
+            loadVisibleTextures(layout, y, height);
 
             const float viewLeft      = static_cast<float>(0);
             const float viewTop       = static_cast<float>(size().height());
@@ -307,6 +320,74 @@ namespace TrenchBroom {
             return false;
         }
 
+        /**
+         * Returns the size of the atlas slots so that the thumbnails need not be magnified, see doInitLayout. Slots
+         * are never larger than the thumbnails of the textures.
+         */
+        static size_t atlasSlotSize(const float iconSize, const qreal pixelRatio) {
+            static const size_t MinSlotSize = 32u;
+            static const size_t MaxSlotSize = Assets::Texture::ThumbnailSize;
+
+            const auto maxCellSize = static_cast<size_t>(std::ceil(128.0 * static_cast<qreal>(iconSize) * pixelRatio));
+
+            auto slotSize = MinSlotSize;
+            while (slotSize < maxCellSize && slotSize < MaxSlotSize) {
+                slotSize *= 2u;
+            }
+            return slotSize;
+        }
+
+        void TextureBrowserView::validateAtlas() {
+            // 4 pages take 64 MB of GPU memory
+            static const size_t MaxAtlasPages = 4u;
+
+            const auto slotSize = atlasSlotSize(pref(Preferences::TextureBrowserIconSize), devicePixelRatioF());
+            const auto generation = kdl::mem_lock(m_document)->textureManager().generation();
+
+            if (m_atlas == nullptr || m_atlas->slotSize() != slotSize) {
+                m_atlas = std::make_unique<Renderer::TextureAtlas>(slotSize, MaxAtlasPages);
+            } else if (generation != m_atlasGeneration) {
+                // the atlas may refer to textures that were destroyed
+                m_atlas->clear();
+            }
+
+            m_atlasGeneration = generation;
+            m_atlas->beginFrame();
+        }
+
+        /**
+         * Textures with a blend function must be rendered with it, so they are not copied into the atlas.
+         */
+        static bool usesAtlas(const Assets::Texture& texture) {
+            return texture.blendFunc().enable == Assets::TextureBlendFunc::Enable::UseDefault;
+        }
+
+        void TextureBrowserView::loadVisibleTextures(Layout& layout, const float y, const float height) {
+            std::vector<const Assets::Texture*> textures;
+
+            for (size_t i = 0; i < layout.size(); ++i) {
+                const Group& group = layout[i];
+                if (group.intersectsY(y, height)) {
+                    for (size_t j = 0; j < group.size(); ++j) {
+                        const Row& row = group[j];
+                        if (row.intersectsY(y, height)) {
+                            for (size_t k = 0; k < row.size(); ++k) {
+                                // textures that are in the atlas or can be copied into it from their thumbnails
+                                // are not needed for rendering
+                                const auto* texture = cellData(row[k]).texture;
+                                if (!m_atlas->contains(*texture) && !(usesAtlas(*texture) && texture->hasThumbnail())) {
+                                    textures.push_back(texture);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            auto doc = kdl::mem_lock(m_document);
+            doc->textureManager().loadTextures(textures);
+        }
+
         void TextureBrowserView::renderBounds(Layout& layout, const float y, const float height) {
             using BoundsVertex = Renderer::GLVertexTypes::P2C4::Vertex;
             std::vector<BoundsVertex> vertices;
@@ -355,7 +436,9 @@ namespace TrenchBroom {
             shader.set("Texture", 0);
             shader.set("Brightness", pref(Preferences::Brightness));
 
-            size_t num = 0;
+            // the vertices of the textures in the atlas, by page and by whether they are rendered in gray scale
+            std::map<std::pair<size_t, bool>, std::vector<TextureVertex>> atlasVertices;
+            std::vector<const Cell*> remainingCells;
 
             for (size_t i = 0; i < layout.size(); ++i) {
                 const Group& group = layout[i];
@@ -365,30 +448,64 @@ namespace TrenchBroom {
                         if (row.intersectsY(y, height)) {
                             for (size_t k = 0; k < row.size(); ++k) {
                                 const Cell& cell = row[k];
-                                const LayoutBounds& bounds = cell.itemBounds();
                                 const Assets::Texture* texture = cellData(cell).texture;
 
-                                Renderer::VertexArray vertexArray = Renderer::VertexArray::move(std::vector<TextureVertex>({
-                                    TextureVertex(vm::vec2f(bounds.left(),  height - (bounds.top() - y)),    vm::vec2f(0.0f, 0.0f)),
-                                    TextureVertex(vm::vec2f(bounds.left(),  height - (bounds.bottom() - y)), vm::vec2f(0.0f, 1.0f)),
-                                    TextureVertex(vm::vec2f(bounds.right(), height - (bounds.bottom() - y)), vm::vec2f(1.0f, 1.0f)),
-                                    TextureVertex(vm::vec2f(bounds.right(), height - (bounds.top() - y)),    vm::vec2f(1.0f, 0.0f))
-                                }));
+                                const auto entry = usesAtlas(*texture) ? m_atlas->entry(*texture) : std::nullopt;
+                                if (!entry) {
+                                    remainingCells.push_back(&cell);
+                                    continue;
+                                }
 
-                                shader.set("GrayScale", texture->overridden());
-                                texture->activate();
-
-                                vertexArray.prepare(vboManager());
-                                vertexArray.render(Renderer::PrimType::Quads);
-
-                                texture->deactivate();
-
-                                ++num;
+                                const LayoutBounds& bounds = cell.itemBounds();
+                                const auto& min = entry->minTexCoords;
+                                const auto& max = entry->maxTexCoords;
+
+                                auto& vertices = atlasVertices[std::make_pair(entry->page, texture->overridden())];
+                                vertices.emplace_back(vm::vec2f(bounds.left(),  height - (bounds.top() - y)),    vm::vec2f(min.x(), min.y()));
+                                vertices.emplace_back(vm::vec2f(bounds.left(),  height - (bounds.bottom() - y)), vm::vec2f(min.x(), max.y()));
+                                vertices.emplace_back(vm::vec2f(bounds.right(), height - (bounds.bottom() - y)), vm::vec2f(max.x(), max.y()));
+                                vertices.emplace_back(vm::vec2f(bounds.right(), height - (bounds.top() - y)),    vm::vec2f(max.x(), min.y()));
                             }
                         }
                     }
                 }
             }
+
+            m_atlas->prepare();
+            for (auto& [key, vertices] : atlasVertices) {
+                const auto [page, grayScale] = key;
+
+                Renderer::VertexArray vertexArray = Renderer::VertexArray::move(std::move(vertices));
+
+                shader.set("GrayScale", grayScale);
+                m_atlas->activatePage(page);
+
+                vertexArray.prepare(vboManager());
+                vertexArray.render(Renderer::PrimType::Quads);
+
+                m_atlas->deactivatePage();
+            }
+
+            // textures that are not in the atlas are rendered individually
+            for (const Cell* cell : remainingCells) {
+                const LayoutBounds& bounds = cell->itemBounds();
+                const Assets::Texture* texture = cellData(*cell).texture;
+
+                Renderer::VertexArray vertexArray = Renderer::VertexArray::move(std::vector<TextureVertex>({
+                    TextureVertex(vm::vec2f(bounds.left(),  height - (bounds.top() - y)),    vm::vec2f(0.0f, 0.0f)),
+                    TextureVertex(vm::vec2f(bounds.left(),  height - (bounds.bottom() - y)), vm::vec2f(0.0f, 1.0f)),
+                    TextureVertex(vm::vec2f(bounds.right(), height - (bounds.bottom() - y)), vm::vec2f(1.0f, 1.0f)),
+                    TextureVertex(vm::vec2f(bounds.right(), height - (bounds.top() - y)),    vm::vec2f(1.0f, 0.0f))
+                }));
+
+                shader.set("GrayScale", texture->overridden());
+                texture->activate();
+
+                vertexArray.prepare(vboManager());
+                vertexArray.render(Renderer::PrimType::Quads);
+
+                texture->deactivate();
+            }
         }
 
         void TextureBrowserView::renderNames(Layout& layout, const float y, const float height) {
@@ -37,6 +37,10 @@ namespace TrenchBroom {
         class TextureCollection;
     }
 
+    namespace Renderer {
+        class TextureAtlas;
+    }
+
     namespace View {
         class GLContextManager;
         class MapDocument;
@@ -70,6 +74,10 @@ namespace TrenchBroom {
             std::string m_filterText;
 
             const Assets::Texture* m_selectedTexture;
+
+            // holds the thumbnails of the visible textures so that they can be rendered in a few draw calls
+            std::unique_ptr<Renderer::TextureAtlas> m_atlas;
+            size_t m_atlasGeneration;
         public:
             TextureBrowserView(QScrollBar* scrollBar,
                                GLContextManager& contextManager,
@@ -108,6 +116,8 @@ namespace TrenchBroom {
             void doRender(Layout& layout, float y, float height) override;
             bool doShouldRenderFocusIndicator() const override;
 
+            void validateAtlas();
+            void loadVisibleTextures(Layout& layout, float y, float height);
             void renderBounds(Layout& layout, float y, float height);
             const Color& textureColor(const Assets::Texture& texture) const;
             void renderTextures(Layout& layout, float y, float height);
@@ -38,15 +38,15 @@ namespace TrenchBroom {
         const Model::HitType::Type VertexHandleManager::HandleHitType = Model::HitType::freeType();
 
         void VertexHandleManager::pick(const vm::ray3& pickRay, const Renderer::Camera& camera, Model::PickResult& pickResult) const {
-            for (const auto& entry : m_handles) {
-                const auto& position = entry.first;
-                const auto distance = camera.pickPointHandle(pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+            const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+            forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::vec3& position) {
+                const auto distance = camera.pickPointHandle(pickRay, position, handleRadius);
                 if (!vm::is_nan(distance)) {
                     const auto hitPoint = vm::point_at_distance(pickRay, distance);
                     const auto error = vm::squared_distance(pickRay, position).distance;
                     pickResult.addHit(Model::Hit::hit(HandleHitType, distance, hitPoint, position, error));
                 }
-            }
+            });
         }
 
         void VertexHandleManager::addHandles(const Model::BrushNode* brushNode) {
@@ -67,6 +67,14 @@ namespace TrenchBroom {
             return HandleHitType;
         }
 
+        vm::vec3 VertexHandleManager::indexPosition(const Handle& handle) const {
+            return handle;
+        }
+
+        FloatType VertexHandleManager::indexExtent(const Handle& /* handle */) const {
+            return static_cast<FloatType>(0.0);
+        }
+
         bool VertexHandleManager::isIncident(const Handle& handle, const Model::BrushNode* brushNode) const {
             const Model::Brush& brush = brushNode->brush();
             return brush.hasVertex(handle);
@@ -75,31 +83,32 @@ namespace TrenchBroom {
         const Model::HitType::Type EdgeHandleManager::HandleHitType = Model::HitType::freeType();
 
         void EdgeHandleManager::pickGridHandle(const vm::ray3& pickRay, const Renderer::Camera& camera, const Grid& grid, Model::PickResult& pickResult) const {
-            for (const HandleEntry& entry : m_handles) {
-                const vm::segment3& position = entry.first;
-                const FloatType edgeDist = camera.pickLineSegmentHandle(pickRay, position, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+            // the snapped point handles lie on the edge handles, so the spatial index can be used
+            const FloatType handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+            forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::segment3& position) {
+                const FloatType edgeDist = camera.pickLineSegmentHandle(pickRay, position, handleRadius);
                 if (!vm::is_nan(edgeDist)) {
                     const vm::vec3 pointHandle = grid.snap(vm::point_at_distance(pickRay, edgeDist), position);
-                    const FloatType pointDist = camera.pickPointHandle(pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+                    const FloatType pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
                     if (!vm::is_nan(pointDist)) {
                         const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
                         pickResult.addHit(Model::Hit::hit(HandleHitType, pointDist, hitPoint, HitType(position, pointHandle)));
                     }
                 }
-            }
+            });
         }
 
         void EdgeHandleManager::pickCenterHandle(const vm::ray3& pickRay, const Renderer::Camera& camera, Model::PickResult& pickResult) const {
-            for (const HandleEntry& entry : m_handles) {
-                const vm::segment3& position = entry.first;
+            const FloatType handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+            forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::segment3& position) {
                 const vm::vec3 pointHandle = position.center();
 
-                const FloatType pointDist = camera.pickPointHandle(pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+                const FloatType pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
                 if (!vm::is_nan(pointDist)) {
                     const vm::vec3 hitPoint = vm::point_at_distance(pickRay, pointDist);
                     pickResult.addHit(Model::Hit::hit(HandleHitType, pointDist, hitPoint, position));
                 }
-            }
+            });
         }
 
         void EdgeHandleManager::addHandles(const Model::BrushNode* brushNode) {
@@ -120,6 +129,14 @@ namespace TrenchBroom {
             return HandleHitType;
         }
 
+        vm::vec3 EdgeHandleManager::indexPosition(const Handle& handle) const {
+            return handle.center();
+        }
+
+        FloatType EdgeHandleManager::indexExtent(const Handle& handle) const {
+            return vm::length(handle.end() - handle.start()) / static_cast<FloatType>(2.0);
+        }
+
         bool EdgeHandleManager::isIncident(const Handle& handle, const Model::BrushNode* brushNode) const {
             const Model::Brush& brush = brushNode->brush();
             return brush.hasEdge(handle);
@@ -128,38 +145,38 @@ namespace TrenchBroom {
         const Model::HitType::Type FaceHandleManager::HandleHitType = Model::HitType::freeType();
 
         void FaceHandleManager::pickGridHandle(const vm::ray3& pickRay, const Renderer::Camera& camera, const Grid& grid, Model::PickResult& pickResult) const {
-            for (const auto& entry : m_handles) {
-                const auto& position = entry.first;
-
+            // only face handles that the pick ray intersects can yield a hit, so the spatial index can be used
+            const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+            forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::polygon3& position) {
                 const auto [valid, plane] = vm::from_points(std::begin(position), std::end(position));
                 if (!valid) {
-                    continue;
+                    return;
                 }
 
                 const auto distance = vm::intersect_ray_polygon(pickRay, plane, std::begin(position), std::end(position));
                 if (!vm::is_nan(distance)) {
                     const auto pointHandle = grid.snap(vm::point_at_distance(pickRay, distance), plane);
 
-                    const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+                    const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
                     if (!vm::is_nan(pointDist)) {
                         const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
                         pickResult.addHit(Model::Hit::hit(HandleHitType, pointDist, hitPoint, HitType(position, pointHandle)));
                     }
                 }
-            }
+            });
         }
 
         void FaceHandleManager::pickCenterHandle(const vm::ray3& pickRay, const Renderer::Camera& camera, Model::PickResult& pickResult) const {
-            for (const HandleEntry& entry : m_handles) {
-                const auto& position = entry.first;
+            const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+            forEachHandleNearRay(pickRay, camera, handleRadius, [&](const vm::polygon3& position) {
                 const auto pointHandle = position.center();
 
-                const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, static_cast<FloatType>(pref(Preferences::HandleRadius)));
+                const auto pointDist = camera.pickPointHandle(pickRay, pointHandle, handleRadius);
                 if (!vm::is_nan(pointDist)) {
                     const auto hitPoint = vm::point_at_distance(pickRay, pointDist);
                     pickResult.addHit(Model::Hit::hit(HandleHitType, pointDist, hitPoint, position));
                 }
-            }
+            });
         }
 
         void FaceHandleManager::addHandles(const Model::BrushNode* brushNode) {
@@ -180,6 +197,19 @@ namespace TrenchBroom {
             return HandleHitType;
         }
 
+        vm::vec3 FaceHandleManager::indexPosition(const Handle& handle) const {
+            return handle.center();
+        }
+
+        FloatType FaceHandleManager::indexExtent(const Handle& handle) const {
+            const auto center = handle.center();
+            auto result = static_cast<FloatType>(0.0);
+            for (const auto& vertex : handle) {
+                result = vm::max(result, vm::distance(vertex, center));
+            }
+            return result;
+        }
+
         bool FaceHandleManager::isIncident(const Handle& handle, const Model::BrushNode* brushNode) const {
             const Model::Brush& brush = brushNode->brush();
             return brush.hasFace(handle);
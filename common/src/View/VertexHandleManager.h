@@ -29,10 +29,25 @@
 
 #include <kdl/vector_set.h>
 
+#include <vecmath/bbox.h>
+#include <vecmath/intersection.h>
+#include <vecmath/polygon.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
 #include <vecmath/segment.h>
+#include <vecmath/vec.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
 #include <iterator>
+#include <limits>
 #include <map>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
 namespace TrenchBroom {
@@ -170,9 +185,53 @@ namespace TrenchBroom {
              * The total number of selected handles, not counting duplicates.
              */
             size_t m_selectedHandleCount;
+        private:
+            /**
+             * The handles are additionally indexed in a uniform grid of cubic cells so that finding and picking handles
+             * only has to consider the handles in the cells close to the query. Only cells that contain at least one
+             * handle are stored.
+             */
+            static constexpr FloatType CellSize = static_cast<FloatType>(64.0);
+
+            using CellKey = std::array<int64_t, 3>;
+
+            struct CellKeyHash {
+                size_t operator()(const CellKey& key) const {
+                    auto result = static_cast<size_t>(key[0]);
+                    result = result * 73856093u ^ static_cast<size_t>(key[1]);
+                    result = result * 19349663u ^ static_cast<size_t>(key[2]);
+                    return result;
+                }
+            };
+
+            /**
+             * A grid cell. Every handle is stored in the cell that contains its index position. The cell also records
+             * the largest extent of the handles stored in it. The extent is not reduced when handles are removed, so it
+             * is an upper bound only.
+             */
+            struct Cell {
+                std::vector<typename HandleMap::iterator> handles;
+                FloatType maxExtent;
+
+                Cell() :
+                maxExtent(0) {}
+            };
+
+            std::unordered_map<CellKey, Cell, CellKeyHash> m_cells;
+
+            /**
+             * The smallest and largest key of the stored cells in each dimension and the largest extent of all stored
+             * handles. Like the extent of a cell, these are not updated when handles are removed.
+             */
+            CellKey m_minCellKey;
+            CellKey m_maxCellKey;
+            FloatType m_maxExtent;
         public:
             VertexHandleManagerBaseT() :
-            m_selectedHandleCount(0) {}
+            m_selectedHandleCount(0),
+            m_minCellKey({ 0, 0, 0 }),
+            m_maxCellKey({ 0, 0, 0 }),
+            m_maxExtent(0) {}
 
             virtual ~VertexHandleManagerBaseT() {}
         public:
@@ -303,7 +362,12 @@ namespace TrenchBroom {
              * @param handle the handle to add
              */
             void add(const Handle& handle) {
-                m_handles[handle].inc(); // unknown value gets value constructed, which for HandleInfo means its default constructor is called
+                auto it = m_handles.find(handle);
+                if (it == std::end(m_handles)) {
+                    it = m_handles.emplace(handle, HandleInfo()).first;
+                    addToIndex(it);
+                }
+                it->second.inc();
             }
 
             /**
@@ -320,6 +384,7 @@ namespace TrenchBroom {
 
                     if (info.count == 0) {
                         deselect(info);
+                        removeFromIndex(it);
                         m_handles.erase(it);
                     }
                     return true;
@@ -333,6 +398,8 @@ namespace TrenchBroom {
              */
             void clear() {
                 m_handles.clear();
+                m_cells.clear();
+                m_maxExtent = static_cast<FloatType>(0.0);
                 m_selectedHandleCount = 0;
             }
 
@@ -423,13 +490,70 @@ namespace TrenchBroom {
             template <typename F>
             void forEachCloseHandle(const H& handle, F fun) {
                 static const auto epsilon = 0.001 * 0.001;
-                for (auto& entry : m_handles) {
-                    if (compare(handle, entry.first, epsilon) == 0) {
-                        fun(entry.second);
+
+                // handles that are equal up to the epsilon have index positions that are equal up to the epsilon, so
+                // only the cells overlapping a small box around the given handle's index position must be searched
+                const auto position = indexPosition(handle);
+                const auto min = cellKey(position - vm::vec3::fill(2.0 * epsilon));
+                const auto max = cellKey(position + vm::vec3::fill(2.0 * epsilon));
+                for (auto x = min[0]; x <= max[0]; ++x) {
+                    for (auto y = min[1]; y <= max[1]; ++y) {
+                        for (auto z = min[2]; z <= max[2]; ++z) {
+                            const auto cellIt = m_cells.find({ x, y, z });
+                            if (cellIt != std::end(m_cells)) {
+                                for (auto it : cellIt->second.handles) {
+                                    if (compare(handle, it->first, epsilon) == 0) {
+                                        fun(it->second);
+                                    }
+                                }
+                            }
+                        }
                     }
                 }
             }
 
+            static CellKey cellKey(const vm::vec3& position) {
+                return {
+                    static_cast<int64_t>(vm::floor(position.x() / CellSize)),
+                    static_cast<int64_t>(vm::floor(position.y() / CellSize)),
+                    static_cast<int64_t>(vm::floor(position.z() / CellSize))
+                };
+            }
+
+            static vm::vec3 cellOrigin(const CellKey& key) {
+                return vm::vec3(static_cast<FloatType>(key[0]), static_cast<FloatType>(key[1]), static_cast<FloatType>(key[2])) * CellSize;
+            }
+
+            void addToIndex(const typename HandleMap::iterator it) {
+                const auto key = cellKey(indexPosition(it->first));
+                const auto extent = indexExtent(it->first);
+
+                if (m_cells.empty()) {
+                    m_minCellKey = m_maxCellKey = key;
+                } else {
+                    for (size_t i = 0u; i < 3u; ++i) {
+                        m_minCellKey[i] = std::min(m_minCellKey[i], key[i]);
+                        m_maxCellKey[i] = std::max(m_maxCellKey[i], key[i]);
+                    }
+                }
+                m_maxExtent = vm::max(m_maxExtent, extent);
+
+                auto& cell = m_cells[key];
+                cell.handles.push_back(it);
+                cell.maxExtent = vm::max(cell.maxExtent, extent);
+            }
+
+            void removeFromIndex(const typename HandleMap::iterator it) {
+                const auto cellIt = m_cells.find(cellKey(indexPosition(it->first)));
+                assert(cellIt != std::end(m_cells));
+
+                auto& handles = cellIt->second.handles;
+                handles.erase(std::find(std::begin(handles), std::end(handles), it));
+                if (handles.empty()) {
+                    m_cells.erase(cellIt);
+                }
+            }
+
             void select(HandleInfo& info) {
                 if (info.select()) {
                     assert(selectedHandleCount() < totalHandleCount());
@@ -471,6 +595,178 @@ namespace TrenchBroom {
                     }
                 }
             }
+        protected:
+            /**
+             * Calls the given function for every handle that might be hit by the given pick ray. A handle might be hit
+             * if the pick ray passes a point of the handle at a distance that is less than the handle radius scaled for
+             * the given camera at that point.
+             *
+             * The ray is followed through the grid cell by cell, and only the cells close enough to the part of the ray
+             * within a cell are searched. If the ray passes so many cells that this would take longer than checking
+             * every stored cell, the stored cells are checked instead.
+             *
+             * @tparam F the type of the function to call, must accept a const Handle&
+             * @param pickRay the pick ray
+             * @param camera the camera
+             * @param handleRadius the handle radius
+             * @param fun the function to call
+             */
+            template <typename F>
+            void forEachHandleNearRay(const vm::ray3& pickRay, const Renderer::Camera& camera, const FloatType handleRadius, F fun) const {
+                if (m_cells.empty()) {
+                    return;
+                }
+
+                // every point of every handle lies within these bounds
+                const auto bounds = vm::bbox3(
+                    cellOrigin(m_minCellKey) - vm::vec3::fill(m_maxExtent),
+                    cellOrigin(m_maxCellKey) + vm::vec3::fill(CellSize + m_maxExtent));
+                const auto maxPickRadius = pickRadius(camera, handleRadius, bounds);
+
+                const auto range = intersectRayWithBounds(pickRay, grow(bounds, maxPickRadius));
+                if (!range) {
+                    return;
+                }
+
+                const auto [rangeStart, rangeEnd] = *range;
+                const auto& origin = pickRay.origin;
+                const auto& direction = pickRay.direction;
+
+                // estimate the number of cell lookups needed to follow the ray and compare it to the number of cells
+                auto stepCount = static_cast<FloatType>(1.0);
+                for (size_t i = 0u; i < 3u; ++i) {
+                    stepCount += std::ceil(vm::abs(direction[i]) * (rangeEnd - rangeStart) / CellSize) + static_cast<FloatType>(1.0);
+                }
+                const auto cellsPerStep = std::ceil(static_cast<FloatType>(2.0) * (maxPickRadius + m_maxExtent) / CellSize) + static_cast<FloatType>(2.0);
+                if (stepCount * cellsPerStep * cellsPerStep * cellsPerStep >= static_cast<FloatType>(m_cells.size())) {
+                    forEachHandleInCellsNearRay(pickRay, camera, handleRadius, fun);
+                    return;
+                }
+
+                // 3D DDA: for every axis, track the distance at which the ray crosses the next cell boundary
+                const auto startKey = cellKey(vm::point_at_distance(pickRay, rangeStart));
+                vm::vec3 nextCrossing, crossingDelta;
+                for (size_t i = 0u; i < 3u; ++i) {
+                    if (direction[i] > static_cast<FloatType>(0.0)) {
+                        nextCrossing[i] = (static_cast<FloatType>(startKey[i] + 1) * CellSize - origin[i]) / direction[i];
+                        crossingDelta[i] = CellSize / direction[i];
+                    } else if (direction[i] < static_cast<FloatType>(0.0)) {
+                        nextCrossing[i] = (static_cast<FloatType>(startKey[i]) * CellSize - origin[i]) / direction[i];
+                        crossingDelta[i] = -CellSize / direction[i];
+                    } else {
+                        nextCrossing[i] = std::numeric_limits<FloatType>::max();
+                        crossingDelta[i] = static_cast<FloatType>(0.0);
+                    }
+                }
+
+                std::unordered_set<CellKey, CellKeyHash> visitedCells;
+                auto distance = rangeStart;
+                while (distance < rangeEnd) {
+                    auto axis = size_t(0);
+                    if (nextCrossing[1] < nextCrossing[axis]) {
+                        axis = 1u;
+                    }
+                    if (nextCrossing[2] < nextCrossing[axis]) {
+                        axis = 2u;
+                    }
+                    const auto nextDistance = vm::max(distance, vm::min(nextCrossing[axis], rangeEnd));
+                    nextCrossing[axis] += crossingDelta[axis];
+
+                    // A handle point that is hit lies within the pick radius of this part of the ray, and the pick
+                    // radius is evaluated at the handle point. The radius computed for all handles bounds the region
+                    // where such a point can be, and the radius within that region bounds the distance to the ray.
+                    const auto start = vm::point_at_distance(pickRay, distance);
+                    const auto end = vm::point_at_distance(pickRay, nextDistance);
+                    const auto segmentBounds = vm::bbox3(vm::min(start, end), vm::max(start, end));
+                    const auto region = vm::intersect(grow(segmentBounds, maxPickRadius), bounds);
+                    const auto radius = pickRadius(camera, handleRadius, region) + m_maxExtent;
+
+                    const auto minKey = cellKey(segmentBounds.min - vm::vec3::fill(radius));
+                    const auto maxKey = cellKey(segmentBounds.max + vm::vec3::fill(radius));
+                    for (auto x = minKey[0]; x <= maxKey[0]; ++x) {
+                        for (auto y = minKey[1]; y <= maxKey[1]; ++y) {
+                            for (auto z = minKey[2]; z <= maxKey[2]; ++z) {
+                                const auto key = CellKey{ x, y, z };
+                                if (visitedCells.insert(key).second) {
+                                    const auto cellIt = m_cells.find(key);
+                                    if (cellIt != std::end(m_cells)) {
+                                        for (const auto it : cellIt->second.handles) {
+                                            fun(it->first);
+                                        }
+                                    }
+                                }
+                            }
+                        }
+                    }
+
+                    distance = nextDistance;
+                    if (nextCrossing[axis] >= std::numeric_limits<FloatType>::max()) {
+                        break;
+                    }
+                }
+            }
+        private:
+            template <typename F>
+            void forEachHandleInCellsNearRay(const vm::ray3& pickRay, const Renderer::Camera& camera, const FloatType handleRadius, F fun) const {
+                for (const auto& [key, cell] : m_cells) {
+                    // every point of a handle in this cell lies within the cell bounds grown by the cell's extent
+                    const auto cellBounds = vm::bbox3(
+                        cellOrigin(key) - vm::vec3::fill(cell.maxExtent),
+                        cellOrigin(key) + vm::vec3::fill(CellSize + cell.maxExtent));
+                    const auto bounds = grow(cellBounds, pickRadius(camera, handleRadius, cellBounds));
+                    if (bounds.contains(pickRay.origin) || !vm::is_nan(vm::intersect_ray_bbox(pickRay, bounds))) {
+                        for (const auto it : cell.handles) {
+                            fun(it->first);
+                        }
+                    }
+                }
+            }
+
+            static vm::bbox3 grow(const vm::bbox3& bounds, const FloatType delta) {
+                return vm::bbox3(bounds.min - vm::vec3::fill(delta), bounds.max + vm::vec3::fill(delta));
+            }
+
+            /**
+             * Returns the largest pick radius of a handle point within the given bounds.
+             */
+            static FloatType pickRadius(const Renderer::Camera& camera, const FloatType handleRadius, const vm::bbox3& bounds) {
+                // the scaling is linear in the distance from the camera plane, so its magnitude is largest at a corner
+                auto maxScaling = static_cast<FloatType>(0.0);
+                for (size_t i = 0u; i < 8u; ++i) {
+                    const auto corner = vm::vec3(
+                        (i & 1u) ? bounds.max.x() : bounds.min.x(),
+                        (i & 2u) ? bounds.max.y() : bounds.min.y(),
+                        (i & 4u) ? bounds.max.z() : bounds.min.z());
+                    maxScaling = vm::max(maxScaling, vm::abs(static_cast<FloatType>(camera.perspectiveScalingFactor(vm::vec3f(corner)))));
+                }
+                return static_cast<FloatType>(2.0) * handleRadius * maxScaling;
+            }
+
+            /**
+             * Returns the distances at which the given ray enters and leaves the given bounds, where the entry distance
+             * is 0 if the ray starts within the bounds, or nothing if the ray misses the bounds.
+             */
+            static std::optional<std::pair<FloatType, FloatType>> intersectRayWithBounds(const vm::ray3& ray, const vm::bbox3& bounds) {
+                auto entry = static_cast<FloatType>(0.0);
+                auto exit = std::numeric_limits<FloatType>::max();
+                for (size_t i = 0u; i < 3u; ++i) {
+                    if (ray.direction[i] == static_cast<FloatType>(0.0)) {
+                        if (ray.origin[i] < bounds.min[i] || ray.origin[i] > bounds.max[i]) {
+                            return std::nullopt;
+                        }
+                    } else {
+                        const auto d1 = (bounds.min[i] - ray.origin[i]) / ray.direction[i];
+                        const auto d2 = (bounds.max[i] - ray.origin[i]) / ray.direction[i];
+                        entry = vm::max(entry, vm::min(d1, d2));
+                        exit = vm::min(exit, vm::max(d1, d2));
+                    }
+                }
+
+                if (entry > exit) {
+                    return std::nullopt;
+                }
+                return std::make_pair(entry, exit);
+            }
         public:
             /**
              * Finds and returns all brushes in the given range which are incident to the given handle.
@@ -528,6 +824,23 @@ namespace TrenchBroom {
                 }
             }
         private:
+            /**
+             * Returns the position by which the given handle is indexed. Handles that are equal up to a small epsilon
+             * must have index positions that are equal up to the same epsilon.
+             *
+             * @param handle the handle
+             * @return the index position of the given handle
+             */
+            virtual vm::vec3 indexPosition(const Handle& handle) const = 0;
+
+            /**
+             * Returns the largest distance of any point of the given handle from its index position.
+             *
+             * @param handle the handle
+             * @return the extent of the given handle
+             */
+            virtual FloatType indexExtent(const Handle& handle) const = 0;
+
             /**
              * Checks whether the given brush is incident to the given handle.
              *
@@ -563,6 +876,8 @@ namespace TrenchBroom {
 
             Model::HitType::Type hitType() const override;
         private:
+            vm::vec3 indexPosition(const Handle& handle) const override;
+            FloatType indexExtent(const Handle& handle) const override;
             bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
         };
 
@@ -608,6 +923,8 @@ namespace TrenchBroom {
 
             Model::HitType::Type hitType() const override;
         private:
+            vm::vec3 indexPosition(const Handle& handle) const override;
+            FloatType indexExtent(const Handle& handle) const override;
             bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
         };
 
@@ -654,6 +971,8 @@ namespace TrenchBroom {
 
             Model::HitType::Type hitType() const override;
         private:
+            vm::vec3 indexPosition(const Handle& handle) const override;
+            FloatType indexExtent(const Handle& handle) const override;
             bool isIncident(const Handle& handle, const Model::BrushNode* brushNode) const override;
         };
     }
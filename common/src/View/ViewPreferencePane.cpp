@@ -134,6 +134,9 @@ namespace TrenchBroom {
                 m_textureModeCombo->addItem(QString::fromStdString(textureMode.name));
             }
 
+            m_textureCompression = new QCheckBox();
+            m_textureCompression->setToolTip("Store image textures compressed in video memory. This reduces the memory they use to a fourth or less at a slight loss of quality.");
+
             m_backgroundColorButton = new ColorButton();
             m_backgroundColorButton->setToolTip("Sets the background color of the editing views.");
             m_gridColorButton = new ColorButton();
@@ -173,6 +176,7 @@ namespace TrenchBroom {
             layout->addRow("FOV", m_fovSlider);
             layout->addRow("Show axes", m_showAxes);
             layout->addRow("Texture mode", m_textureModeCombo);
+            layout->addRow("Compress textures", m_textureCompression);
 
             layout->addSection("Colors");
             layout->addRow("Background", m_backgroundColorButton);
@@ -202,6 +206,7 @@ namespace TrenchBroom {
             connect(m_edgeColorButton, &ColorButton::colorChanged, this, &ViewPreferencePane::edgeColorChanged);
             connect(m_themeCombo, QOverload<int>::of(&QComboBox::activated), this, &ViewPreferencePane::themeChanged);
             connect(m_textureModeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ViewPreferencePane::textureModeChanged);
+            connect(m_textureCompression, &QCheckBox::stateChanged, this, &ViewPreferencePane::textureCompressionChanged);
             connect(m_textureBrowserIconSizeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &ViewPreferencePane::textureBrowserIconSizeChanged);
             connect(m_rendererFontSizeCombo, &QComboBox::currentTextChanged, this, &ViewPreferencePane::rendererFontSizeChanged);
         }
@@ -219,6 +224,7 @@ namespace TrenchBroom {
             prefs.resetToDefault(Preferences::ShowAxes);
             prefs.resetToDefault(Preferences::TextureMinFilter);
             prefs.resetToDefault(Preferences::TextureMagFilter);
+            prefs.resetToDefault(Preferences::TextureCompression);
             prefs.resetToDefault(Preferences::BackgroundColor);
             prefs.resetToDefault(Preferences::GridColor2D);
             prefs.resetToDefault(Preferences::EdgeColor);
@@ -235,6 +241,7 @@ namespace TrenchBroom {
 
             const auto textureModeIndex = findTextureMode(pref(Preferences::TextureMinFilter), pref(Preferences::TextureMagFilter));
             m_textureModeCombo->setCurrentIndex(int(textureModeIndex));
+            m_textureCompression->setChecked(pref(Preferences::TextureCompression));
 
             m_showAxes->setChecked(pref(Preferences::ShowAxes));
 
@@ -326,6 +333,12 @@ namespace TrenchBroom {
             prefs.set(Preferences::TextureMagFilter, magFilter);
         }
 
+        void ViewPreferencePane::textureCompressionChanged(const int state) {
+            const auto value = state == Qt::Checked;
+            auto& prefs = PreferenceManager::instance();
+            prefs.set(Preferences::TextureCompression, value);
+        }
+
         void ViewPreferencePane::backgroundColorChanged(const QColor& color) {
             const auto value = Color(fromQColor(color), 1.0f);
             auto& prefs = PreferenceManager::instance();
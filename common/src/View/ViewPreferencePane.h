@@ -39,6 +39,7 @@ namespace TrenchBroom {
             SliderWithLabel* m_fovSlider;
             QCheckBox* m_showAxes;
             QComboBox* m_textureModeCombo;
+            QCheckBox* m_textureCompression;
             ColorButton* m_backgroundColorButton;
             ColorButton* m_gridColorButton;
             ColorButton* m_edgeColorButton;
@@ -67,6 +68,7 @@ namespace TrenchBroom {
             void fovChanged(int value);
             void showAxesChanged(int state);
             void textureModeChanged(int index);
+            void textureCompressionChanged(int state);
             void backgroundColorChanged(const QColor& color);
             void gridColorChanged(const QColor& color);
             void edgeColorChanged(const QColor& color);
@@ -20,10 +20,12 @@
 #include "AABBTree.h"
 
 #include <vecmath/vec.h>
+#include <vecmath/bbox.h>
 #include <vecmath/ray.h>
 
 #include <set>
 #include <sstream>
+#include <vector>
 
 #include "Catch2.h"
 #include "GTestCompat.h"
@@ -440,6 +442,102 @@ L [ ( -1 -1 -1 ) ( 1 1 1 ) ]: 1
     }
 
 
+    TEST_CASE("AABBTreeTest.batchUpdateRefitsCoherentMotion", "[AABBTreeTest]") {
+        std::vector<BOX> bounds({
+            BOX(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0)),
+            BOX(VEC(-2.0, -2.0, -2.0), VEC(2.0, 2.0, 2.0)),
+            BOX(VEC(3.0, -1.0, -1.0), VEC(5.0, 1.0, 1.0))
+        });
+
+        AABB tree;
+        tree.insert(bounds[0], 0u);
+        tree.insert(bounds[1], 1u);
+        tree.insert(bounds[2], 2u);
+
+        assertTree(R"(
+O [ ( -2 -2 -2 ) ( 5 2 2 ) ]
+  O [ ( -1 -1 -1 ) ( 5 1 1 ) ]
+    L [ ( -1 -1 -1 ) ( 1 1 1 ) ]: 0
+    L [ ( 3 -1 -1 ) ( 5 1 1 ) ]: 2
+  L [ ( -2 -2 -2 ) ( 2 2 2 ) ]: 1
+)" , tree);
+
+        // translating nodes 0 and 2 by the same offset keeps the structure of the tree
+        const auto offset = VEC(0.0, 0.0, 1.0);
+        bounds[0] = BOX(bounds[0].min + offset, bounds[0].max + offset);
+        bounds[2] = BOX(bounds[2].min + offset, bounds[2].max + offset);
+
+        const std::vector<size_t> data({ 0u, 2u });
+        tree.batchUpdate(data, [&](const size_t d) { return bounds[d]; });
+
+        assertTree(R"(
+O [ ( -2 -2 -2 ) ( 5 2 2 ) ]
+  O [ ( -1 -1 0 ) ( 5 1 2 ) ]
+    L [ ( -1 -1 0 ) ( 1 1 2 ) ]: 0
+    L [ ( 3 -1 0 ) ( 5 1 2 ) ]: 2
+  L [ ( -2 -2 -2 ) ( 2 2 2 ) ]: 1
+)" , tree);
+
+        for (size_t i = 0u; i < bounds.size(); ++i) {
+            assertTreeContains(tree, bounds[i], i);
+        }
+    }
+
+    TEST_CASE("AABBTreeTest.batchUpdateRestructuresIncoherentMotion", "[AABBTreeTest]") {
+        AABB tree;
+        std::vector<BOX> bounds;
+        std::vector<size_t> data;
+        for (size_t i = 0u; i < 64u; ++i) {
+            const auto x = static_cast<double>(i) * 4.0;
+            bounds.emplace_back(VEC(x, -1.0, -1.0), VEC(x + 2.0, 1.0, 1.0));
+            data.push_back(i);
+            tree.insert(bounds.back(), i);
+        }
+
+        // scatter every other node far away along the y axis
+        std::vector<size_t> changed;
+        for (size_t i = 0u; i < 64u; i += 2u) {
+            const auto y = static_cast<double>(i + 1u) * 64.0;
+            bounds[i] = BOX(bounds[i].min + VEC(0.0, y, 0.0), bounds[i].max + VEC(0.0, y, 0.0));
+            changed.push_back(i);
+        }
+
+        tree.batchUpdate(changed, [&](const size_t d) { return bounds[d]; });
+
+        BOX expectedBounds = bounds.front();
+        for (size_t i = 0u; i < 64u; ++i) {
+            assertTreeContains(tree, bounds[i], i);
+            expectedBounds = vm::merge(expectedBounds, bounds[i]);
+        }
+        ASSERT_EQ(expectedBounds, tree.bounds());
+
+        // a ray along the original row only hits the nodes that were not moved
+        std::set<size_t> unchanged;
+        for (size_t i = 1u; i < 64u; i += 2u) {
+            unchanged.insert(i);
+        }
+        std::set<size_t> actual;
+        tree.findIntersectors(RAY(VEC(-1.0, 0.0, 0.0), VEC::pos_x()), std::inserter(actual, std::end(actual)));
+        ASSERT_EQ(unchanged, actual);
+    }
+
+    TEST_CASE("AABBTreeTest.batchUpdateMissingNode", "[AABBTreeTest]") {
+        const BOX bounds1(VEC(-1.0, -1.0, -1.0), VEC(1.0, 1.0, 1.0));
+        const BOX bounds2(VEC(3.0, -1.0, -1.0), VEC(5.0, 1.0, 1.0));
+
+        AABB tree;
+        tree.insert(bounds1, 1u);
+        tree.insert(bounds2, 2u);
+
+        const std::vector<size_t> data({ 1u, 3u });
+        ASSERT_THROW(tree.batchUpdate(data, [](const size_t) { return BOX(VEC(8.0, 8.0, 8.0), VEC(9.0, 9.0, 9.0)); }), NodeTreeException);
+
+        // the tree is unchanged
+        assertTreeContains(tree, bounds1, 1u);
+        assertTreeContains(tree, bounds2, 2u);
+        ASSERT_EQ(vm::merge(bounds1, bounds2), tree.bounds());
+    }
+
     template <typename K>
     BOX makeBounds(const K min, const K max) {
         return BOX(VEC(static_cast<double>(min), -1.0, -1.0), VEC(static_cast<double>(max), 1.0, 1.0));
@@ -489,6 +587,34 @@ L [ ( -1 -1 -1 ) ( 1 1 1 ) ]: 1
         assertIntersectors(tree, RAY(VEC(0.0,  0.0,  0.0), VEC::pos_x()), { 2u });
     }
 
+    TEST_CASE("AABBTreeTest.findIntersectorsInOrder", "[AABBTreeTest]") {
+        AABB tree;
+        tree.insert(BOX(VEC(+5.0, -1.0, -1.0), VEC(+6.0, +1.0, +1.0)), 1u);
+        tree.insert(BOX(VEC(-4.0, -1.0, -1.0), VEC(-3.0, +1.0, +1.0)), 2u);
+        tree.insert(BOX(VEC(+1.0, -1.0, -1.0), VEC(+2.0, +1.0, +1.0)), 3u);
+        tree.insert(BOX(VEC(+3.0, +2.0, -1.0), VEC(+4.0, +3.0, +1.0)), 4u);
+        tree.insert(BOX(VEC(-1.0, -1.0, -1.0), VEC(+1.0, +1.0, +1.0)), 5u);
+
+        std::vector<size_t> data;
+        std::vector<double> distances;
+        tree.findIntersectorsInOrder(RAY(VEC(0.0, 0.0, 0.0), VEC::pos_x()), [&](const size_t d, const double distance) {
+            data.push_back(d);
+            distances.push_back(distance);
+            return true;
+        });
+
+        ASSERT_EQ(std::vector<size_t>({ 5u, 3u, 1u }), data);
+        ASSERT_EQ(std::vector<double>({ 0.0, 1.0, 5.0 }), distances);
+
+        data.clear();
+        tree.findIntersectorsInOrder(RAY(VEC(-8.0, 0.0, 0.0), VEC::pos_x()), [&](const size_t d, const double) {
+            data.push_back(d);
+            return data.size() < 2u;
+        });
+
+        ASSERT_EQ(std::vector<size_t>({ 2u, 5u }), data);
+    }
+
     void assertTree(const std::string& exp, const AABB& actual) {
         std::stringstream str;
         actual.print(str);
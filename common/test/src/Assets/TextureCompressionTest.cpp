@@ -0,0 +1,134 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "GTestCompat.h"
+
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureCompression.h"
+#include "Renderer/GL.h"
+
+#include <cstdlib>
+
+#include "Catch2.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        static TextureBufferList makeGradient(const size_t width, const size_t height, const size_t mipLevels) {
+            auto buffers = TextureBufferList();
+            setMipBufferSize(buffers, mipLevels, width, height, GL_RGBA);
+            for (auto& buffer : buffers) {
+                for (size_t i = 0u; i < buffer.size(); ++i) {
+                    // red increases and blue decreases along the pixels, alpha is opaque
+                    const auto pixel = i / 4u;
+                    const auto channel = i % 4u;
+                    const auto value = channel == 0u ? pixel * 16u : channel == 2u ? 255u - pixel * 16u : 255u;
+                    buffer.data()[i] = static_cast<unsigned char>(value & 0xFF);
+                }
+            }
+            return buffers;
+        }
+
+        TEST_CASE("TextureCompressionTest.compressedImageSize", "[TextureCompressionTest]") {
+            ASSERT_EQ(8u, compressedImageSize(1u, 1u, GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+            ASSERT_EQ(8u, compressedImageSize(4u, 4u, GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+            ASSERT_EQ(32u, compressedImageSize(5u, 8u, GL_COMPRESSED_RGB_S3TC_DXT1_EXT));
+            ASSERT_EQ(64u, compressedImageSize(5u, 8u, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+        }
+
+        TEST_CASE("TextureCompressionTest.compressMipLevels", "[TextureCompressionTest]") {
+            auto buffers = makeGradient(8u, 4u, 4u);
+
+            ASSERT_EQ(static_cast<GLenum>(GL_COMPRESSED_RGB_S3TC_DXT1_EXT), compressTextureBuffers(buffers, 8u, 4u, GL_RGBA, false));
+            ASSERT_EQ(4u, buffers.size());
+            ASSERT_EQ(16u, buffers[0].size());
+            ASSERT_EQ(8u, buffers[1].size());
+            ASSERT_EQ(8u, buffers[2].size());
+            ASSERT_EQ(8u, buffers[3].size());
+        }
+
+        TEST_CASE("TextureCompressionTest.compressGradient", "[TextureCompressionTest]") {
+            auto buffers = makeGradient(4u, 1u, 1u);
+
+            ASSERT_EQ(static_cast<GLenum>(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT), compressTextureBuffers(buffers, 4u, 1u, GL_RGBA, true));
+            ASSERT_EQ(16u, buffers[0].size());
+
+            const auto* block = buffers[0].data();
+
+            // the alpha block is constant
+            ASSERT_EQ(255u, block[0]);
+            ASSERT_EQ(255u, block[1]);
+
+            // the end points of the color block are the first and the last pixel of the gradient
+            const auto color0 = static_cast<unsigned int>(block[8] | block[9] << 8);
+            const auto color1 = static_cast<unsigned int>(block[10] | block[11] << 8);
+            ASSERT_NE(color0, color1);
+            ASSERT_TRUE(color0 > color1);
+
+            // the pixels of the first row use the end points at their ends and the interpolated colors in between
+            const auto firstIndex = static_cast<unsigned int>(block[12] & 0x3);
+            const auto lastIndex = static_cast<unsigned int>((block[12] >> 6) & 0x3);
+            ASSERT_NE(firstIndex, lastIndex);
+            ASSERT_TRUE(firstIndex <= 1u);
+            ASSERT_TRUE(lastIndex <= 1u);
+        }
+
+        static TextureBufferList makeSmoothGradient(const size_t width, const size_t height, const size_t mipLevels) {
+            auto buffers = TextureBufferList();
+            setMipBufferSize(buffers, mipLevels, width, height, GL_RGBA);
+            for (size_t level = 0u; level < buffers.size(); ++level) {
+                // a gradient that the end points of every block can represent well
+                const auto mipWidth = sizeAtMipLevel(width, height, level).x();
+                auto* data = buffers[level].data();
+                for (size_t i = 0u; i < buffers[level].size() / 4u; ++i) {
+                    data[4u * i + 0u] = static_cast<unsigned char>(8u * (i % mipWidth));
+                    data[4u * i + 1u] = static_cast<unsigned char>(4u * (i / mipWidth));
+                    data[4u * i + 2u] = 128u;
+                    data[4u * i + 3u] = 255u;
+                }
+            }
+            return buffers;
+        }
+
+        TEST_CASE("TextureCompressionTest.decompressGradient", "[TextureCompressionTest]") {
+            const auto original = makeSmoothGradient(6u, 3u, 2u);
+
+            for (const auto withAlpha : { false, true }) {
+                auto buffers = makeSmoothGradient(6u, 3u, 2u);
+                const auto format = compressTextureBuffers(buffers, 6u, 3u, GL_RGBA, withAlpha);
+                ASSERT_EQ(static_cast<GLenum>(GL_RGBA), decompressTextureBuffers(buffers, 6u, 3u, format));
+                ASSERT_EQ(original.size(), buffers.size());
+
+                for (size_t level = 0u; level < buffers.size(); ++level) {
+                    ASSERT_EQ(original[level].size(), buffers[level].size());
+
+                    // the decoded pixels are close to the original ones, and opaque pixels remain opaque
+                    for (size_t i = 0u; i < buffers[level].size(); ++i) {
+                        const auto expected = static_cast<int>(original[level].data()[i]);
+                        const auto actual = static_cast<int>(buffers[level].data()[i]);
+                        if (i % 4u == 3u) {
+                            ASSERT_EQ(expected, actual);
+                        } else {
+                            ASSERT_TRUE(std::abs(expected - actual) <= 16);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,157 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Exceptions.h"
+#include "Logger.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureCollection.h"
+#include "Assets/TextureManager.h"
+#include "Renderer/GL.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        using DecodeCounts = std::map<std::string, size_t>;
+
+        static Texture makeDeferredTexture(const std::string& name, DecodeCounts& decodeCounts) {
+            auto texture = Texture(name, 16u, 16u);
+            texture.setDecoder([=, &decodeCounts](Logger&) {
+                ++decodeCounts[name];
+
+                auto buffers = TextureBufferList();
+                setMipBufferSize(buffers, 1u, 16u, 16u, GL_RGBA);
+                return Texture(name, 16u, 16u, Color(), std::move(buffers), GL_RGBA, TextureType::Opaque);
+            });
+            return texture;
+        }
+
+        /**
+         * Creates a texture collection that is never prepared, so that the textures can be loaded without an OpenGL
+         * context.
+         */
+        static TextureCollection makeCollection(const std::vector<std::string>& names, DecodeCounts& decodeCounts) {
+            auto textures = std::vector<Texture>();
+            for (const auto& name : names) {
+                textures.push_back(makeDeferredTexture(name, decodeCounts));
+            }
+            return TextureCollection(std::move(textures));
+        }
+
+        TEST_CASE("TextureManagerTest.loadTextures", "[TextureManagerTest]") {
+            NullLogger logger;
+            auto decodeCounts = DecodeCounts();
+
+            TextureManager manager(GL_NEAREST, GL_NEAREST, logger);
+            auto collections = std::vector<TextureCollection>();
+            collections.push_back(makeCollection({ "a", "b", "c" }, decodeCounts));
+            manager.setTextureCollections(std::move(collections));
+
+            manager.loadTextures({ manager.texture("a"), manager.texture("b") });
+            ASSERT_EQ((DecodeCounts{ { "a", 1u }, { "b", 1u } }), decodeCounts);
+            ASSERT_FALSE(manager.texture("a")->needsLoading());
+            ASSERT_TRUE(manager.texture("c")->needsLoading());
+
+            // loaded textures are not decoded again
+            manager.loadTextures({ manager.texture("a"), manager.texture("b"), manager.texture("c") });
+            ASSERT_EQ((DecodeCounts{ { "a", 1u }, { "b", 1u }, { "c", 1u } }), decodeCounts);
+        }
+
+        TEST_CASE("TextureManagerTest.loadTexturesWithError", "[TextureManagerTest]") {
+            NullLogger logger;
+
+            auto texture = Texture("a", 16u, 16u);
+            texture.setDecoder([](Logger&) -> Texture { throw AssetException("could not decode"); });
+
+            auto textures = std::vector<Texture>();
+            textures.push_back(std::move(texture));
+
+            TextureManager manager(GL_NEAREST, GL_NEAREST, logger);
+            auto collections = std::vector<TextureCollection>();
+            collections.push_back(TextureCollection(std::move(textures)));
+            manager.setTextureCollections(std::move(collections));
+
+            // the texture is not loaded again after an error
+            manager.loadTextures({ manager.texture("a") });
+            ASSERT_FALSE(manager.texture("a")->deferred());
+            ASSERT_FALSE(manager.texture("a")->needsLoading());
+        }
+
+        TEST_CASE("TextureManagerTest.commitChangesLoadsUsedTextures", "[TextureManagerTest]") {
+            NullLogger logger;
+            auto decodeCounts = DecodeCounts();
+
+            TextureManager manager(GL_NEAREST, GL_NEAREST, logger);
+            manager.setMemoryBudget(1u);
+            auto collections = std::vector<TextureCollection>();
+            collections.push_back(makeCollection({ "a", "b", "c" }, decodeCounts));
+            manager.setTextureCollections(std::move(collections));
+
+            manager.commitChanges();
+            ASSERT_TRUE(decodeCounts.empty());
+
+            manager.texture("b")->incUsageCount();
+            manager.commitChanges();
+            ASSERT_EQ((DecodeCounts{ { "b", 1u } }), decodeCounts);
+
+            // used textures are not evicted even though the budget is exceeded
+            manager.commitChanges();
+            ASSERT_FALSE(manager.texture("b")->needsLoading());
+            ASSERT_EQ((DecodeCounts{ { "b", 1u } }), decodeCounts);
+
+            manager.texture("c")->incUsageCount();
+            manager.commitChanges();
+            ASSERT_EQ((DecodeCounts{ { "b", 1u }, { "c", 1u } }), decodeCounts);
+            ASSERT_TRUE(manager.texture("a")->needsLoading());
+
+            manager.texture("b")->decUsageCount();
+            manager.texture("c")->decUsageCount();
+        }
+
+        TEST_CASE("TextureManagerTest.generation", "[TextureManagerTest]") {
+            NullLogger logger;
+            auto decodeCounts = DecodeCounts();
+
+            TextureManager manager(GL_NEAREST, GL_NEAREST, logger);
+            const auto initialGeneration = manager.generation();
+
+            auto collections = std::vector<TextureCollection>();
+            collections.push_back(makeCollection({ "a" }, decodeCounts));
+            manager.setTextureCollections(std::move(collections));
+            ASSERT_NE(initialGeneration, manager.generation());
+
+            // loading textures does not invalidate them
+            const auto generation = manager.generation();
+            manager.loadTextures({ manager.texture("a") });
+            manager.commitChanges();
+            ASSERT_EQ(generation, manager.generation());
+
+            manager.clear();
+            ASSERT_NE(generation, manager.generation());
+            ASSERT_EQ(nullptr, manager.texture("a"));
+        }
+    }
+}
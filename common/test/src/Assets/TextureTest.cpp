@@ -0,0 +1,200 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Logger.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Assets/TextureCompression.h"
+#include "Renderer/GL.h"
+
+#include <algorithm>
+#include <string>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Assets {
+        static Texture makeDecodedTexture(const std::string& name, const size_t width, const size_t height) {
+            auto buffers = TextureBufferList();
+            setMipBufferSize(buffers, 1u, width, height, GL_RGBA);
+            return Texture(name, width, height, Color(), std::move(buffers), GL_RGBA, TextureType::Opaque);
+        }
+
+        static Texture makeDeferredTexture(const std::string& name, const size_t width, const size_t height, size_t& decodeCount) {
+            auto texture = Texture(name, width, height);
+            texture.setDecoder([=, &decodeCount](Logger&) {
+                ++decodeCount;
+                return makeDecodedTexture(name, width, height);
+            });
+            return texture;
+        }
+
+        TEST_CASE("TextureTest.loadDecodedTexture", "[TextureTest]") {
+            NullLogger logger;
+            auto decodeCount = size_t(0);
+            auto texture = makeDeferredTexture("texture", 16u, 16u, decodeCount);
+
+            ASSERT_TRUE(texture.deferred());
+            ASSERT_TRUE(texture.needsLoading());
+            ASSERT_FALSE(texture.hasThumbnail());
+            ASSERT_EQ(0u, decodeCount);
+
+            texture.load(texture.decode(logger));
+            ASSERT_EQ(1u, decodeCount);
+            ASSERT_TRUE(texture.hasThumbnail());
+
+            // the pixel data is kept until the texture is uploaded, and the texture can still be evicted later
+            ASSERT_FALSE(texture.needsLoading());
+            ASSERT_TRUE(texture.deferred());
+            ASSERT_FALSE(texture.isPrepared());
+        }
+
+        TEST_CASE("TextureTest.loadTextureWithDifferentSize", "[TextureTest]") {
+            auto decodeCount = size_t(0);
+            auto texture = makeDeferredTexture("texture", 16u, 16u, decodeCount);
+
+            // loading again would yield the same texture, so the decoder is dropped
+            texture.load(makeDecodedTexture("texture", 8u, 8u));
+            ASSERT_FALSE(texture.deferred());
+            ASSERT_FALSE(texture.needsLoading());
+        }
+
+        TEST_CASE("TextureTest.loadEmptyTexture", "[TextureTest]") {
+            auto decodeCount = size_t(0);
+            auto texture = makeDeferredTexture("texture", 16u, 16u, decodeCount);
+
+            // decoding failed, the texture is not loaded again
+            texture.load(Texture("texture", 16u, 16u));
+            ASSERT_FALSE(texture.deferred());
+            ASSERT_FALSE(texture.needsLoading());
+        }
+
+        TEST_CASE("TextureTest.evictUnpreparedTexture", "[TextureTest]") {
+            NullLogger logger;
+            auto decodeCount = size_t(0);
+            auto texture = makeDeferredTexture("texture", 16u, 16u, decodeCount);
+            texture.load(texture.decode(logger));
+
+            // a texture that was not uploaded has nothing to evict
+            texture.evict();
+            ASSERT_FALSE(texture.needsLoading());
+            ASSERT_EQ(0u, texture.uploadedSize());
+            ASSERT_EQ(0u, texture.mipLevelCount());
+        }
+
+        TEST_CASE("TextureTest.createThumbnailFromMipLevel", "[TextureTest]") {
+            auto buffers = TextureBufferList();
+            setMipBufferSize(buffers, fullMipLevelCount(512u, 256u), 512u, 256u, GL_RGB);
+            for (size_t i = 0u; i < buffers[1].size(); i += 3u) {
+                buffers[1].data()[i + 0u] = 1u;
+                buffers[1].data()[i + 1u] = 2u;
+                buffers[1].data()[i + 2u] = 3u;
+            }
+
+            // the thumbnail is copied from the largest mip level that fits
+            const auto texture = Texture("texture", 512u, 256u, Color(), std::move(buffers), GL_RGB, TextureType::Opaque);
+            ASSERT_TRUE(texture.hasThumbnail());
+            ASSERT_EQ(Texture::ThumbnailSize, texture.thumbnailWidth());
+            ASSERT_EQ(Texture::ThumbnailSize / 2u, texture.thumbnailHeight());
+
+            const auto thumbnail = texture.readThumbnail();
+            ASSERT_EQ(4u * 256u * 128u, thumbnail.size());
+            ASSERT_EQ(1u, thumbnail.data()[0]);
+            ASSERT_EQ(2u, thumbnail.data()[1]);
+            ASSERT_EQ(3u, thumbnail.data()[2]);
+            ASSERT_EQ(0xFFu, thumbnail.data()[3]);
+        }
+
+        TEST_CASE("TextureTest.createThumbnailWithoutMipLevels", "[TextureTest]") {
+            auto buffers = TextureBufferList();
+            setMipBufferSize(buffers, 1u, 1024u, 512u, GL_BGRA);
+            for (size_t i = 0u; i < buffers[0].size(); i += 4u) {
+                buffers[0].data()[i + 0u] = 10u;
+                buffers[0].data()[i + 1u] = 20u;
+                buffers[0].data()[i + 2u] = 30u;
+                buffers[0].data()[i + 3u] = 40u;
+            }
+
+            // masked textures are decoded without mip levels, so the thumbnail is scaled down from the first level
+            const auto texture = Texture("texture", 1024u, 512u, Color(), std::move(buffers), GL_BGRA, TextureType::Masked);
+            ASSERT_EQ(Texture::ThumbnailSize, texture.thumbnailWidth());
+            ASSERT_EQ(Texture::ThumbnailSize / 2u, texture.thumbnailHeight());
+
+            const auto thumbnail = texture.readThumbnail();
+            ASSERT_EQ(4u * 256u * 128u, thumbnail.size());
+            ASSERT_EQ(30u, thumbnail.data()[0]);
+            ASSERT_EQ(20u, thumbnail.data()[1]);
+            ASSERT_EQ(10u, thumbnail.data()[2]);
+            ASSERT_EQ(40u, thumbnail.data()[3]);
+        }
+
+        TEST_CASE("TextureTest.keepThumbnailWithoutPixelData", "[TextureTest]") {
+            NullLogger logger;
+            auto decodeCount = size_t(0);
+            auto texture = makeDeferredTexture("texture", 16u, 16u, decodeCount);
+            texture.load(texture.decode(logger));
+
+            texture.evict();
+            ASSERT_TRUE(texture.hasThumbnail());
+            ASSERT_EQ(16u, texture.thumbnailWidth());
+            ASSERT_EQ(16u, texture.thumbnailHeight());
+
+            // textures without pixel data have no thumbnail
+            ASSERT_FALSE(Texture("texture", 16u, 16u).hasThumbnail());
+        }
+
+        TEST_CASE("TextureTest.createCompressedTexture", "[TextureTest]") {
+            const auto format = GLenum(GL_COMPRESSED_RGB_S3TC_DXT1_EXT);
+
+            auto buffers = TextureBufferList();
+            for (size_t level = 0u; level < fullMipLevelCount(8u, 8u); ++level) {
+                const auto mipSize = sizeAtMipLevel(8u, 8u, level);
+                auto& buffer = buffers.emplace_back(compressedImageSize(mipSize.x(), mipSize.y(), format));
+                std::fill_n(buffer.data(), buffer.size(), 0u);
+            }
+
+            // compressed mip levels have no size per pixel
+            const auto texture = Texture("texture", 8u, 8u, Color(), std::move(buffers), format, TextureType::Opaque);
+            ASSERT_EQ(format, texture.format());
+            ASSERT_EQ(4u, texture.buffersIfUnprepared().size());
+
+            // the thumbnail is decompressed when it is read
+            ASSERT_EQ(8u, texture.thumbnailWidth());
+            ASSERT_EQ(4u * 8u * 8u, texture.readThumbnail().size());
+        }
+
+        TEST_CASE("TextureTest.usageChangeCount", "[TextureTest]") {
+            auto texture = Texture("texture", 16u, 16u);
+            const auto initialCount = Texture::usageChangeCount();
+
+            texture.incUsageCount();
+            ASSERT_EQ(initialCount + 1u, Texture::usageChangeCount());
+
+            // only becoming used or unused counts as a change
+            texture.incUsageCount();
+            texture.decUsageCount();
+            ASSERT_EQ(initialCount + 1u, Texture::usageChangeCount());
+
+            texture.decUsageCount();
+            ASSERT_EQ(initialCount + 2u, Texture::usageChangeCount());
+        }
+    }
+}
@@ -0,0 +1,198 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "IO/DecodedTextureCache.h"
+#include "IO/DiskIO.h"
+#include "IO/File.h"
+#include "IO/Path.h"
+#include "IO/PathQt.h"
+#include "IO/TestEnvironment.h"
+#include "Renderer/GL.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QtGlobal>
+
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        TEST_CASE("DecodedTextureCacheTest.storeAndLoad", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+            env.createFile(Path("texture.png"), "some image data");
+            env.createFile(Path("other.png"), "other image data");
+
+            const DecodedTextureCache cache(env.dir() + Path("cache"));
+            const auto file = Disk::openFile(env.dir() + Path("texture.png"));
+            const auto key = DecodedTextureCache::key(*file, "test 1");
+
+            ASSERT_NE(key, DecodedTextureCache::key(*file, "test 2"));
+            ASSERT_NE(key, DecodedTextureCache::key(*Disk::openFile(env.dir() + Path("other.png")), "test 1"));
+            ASSERT_FALSE(cache.load(key).has_value());
+
+            auto buffers = Assets::TextureBufferList(2u);
+            Assets::setMipBufferSize(buffers, 2u, 2u, 2u, GL_RGBA);
+            for (auto& buffer : buffers) {
+                std::memset(buffer.data(), 0x7f, buffer.size());
+            }
+
+            const auto texture = DecodedTexture{2u, 2u, GL_RGBA, Assets::TextureType::Masked, Color(0.5f, 0.5f, 0.5f, 0.5f), std::move(buffers)};
+            cache.store(key, texture);
+
+            const auto loaded = cache.load(key);
+            ASSERT_TRUE(loaded.has_value());
+            ASSERT_EQ(2u, loaded->width);
+            ASSERT_EQ(2u, loaded->height);
+            ASSERT_EQ(static_cast<GLenum>(GL_RGBA), loaded->format);
+            ASSERT_EQ(Assets::TextureType::Masked, loaded->type);
+            ASSERT_EQ(Color(0.5f, 0.5f, 0.5f, 0.5f), loaded->averageColor);
+            ASSERT_EQ(texture.buffers.size(), loaded->buffers.size());
+            for (size_t i = 0u; i < texture.buffers.size(); ++i) {
+                ASSERT_EQ(texture.buffers[i].size(), loaded->buffers[i].size());
+                ASSERT_EQ(0, std::memcmp(texture.buffers[i].data(), loaded->buffers[i].data(), texture.buffers[i].size()));
+            }
+        }
+
+        TEST_CASE("DecodedTextureCacheTest.keyIdentifiesFileLocation", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+            env.createFile(Path("texture.png"), "some image data");
+
+            const auto file = Disk::openFile(env.dir() + Path("texture.png"));
+            const auto key = DecodedTextureCache::key(*file, "test");
+
+            // a file is identified by where it is stored on the disk and not by its path in the game file system
+            ASSERT_EQ(key, DecodedTextureCache::key(FileView(Path("textures/texture.png"), file, 0u, file->size()), "test"));
+            ASSERT_NE(DecodedTextureCache::key(FileView(Path("texture.png"), file, 0u, 4u), "test"),
+                      DecodedTextureCache::key(FileView(Path("texture.png"), file, 4u, 4u), "test"));
+
+            // files that are not stored on the disk are identified by their contents
+            const auto contents = std::string("some image data");
+            const auto otherContents = std::string("some other data");
+            ASSERT_NE(DecodedTextureCache::key(NonOwningBufferFile(Path("texture.png"), contents.data(), contents.data() + contents.size()), "test"),
+                      DecodedTextureCache::key(NonOwningBufferFile(Path("texture.png"), otherContents.data(), otherContents.data() + otherContents.size()), "test"));
+        }
+
+        static DecodedTexture makeTexture(const size_t size) {
+            auto buffers = Assets::TextureBufferList(1u);
+            buffers.front() = Assets::TextureBuffer(size);
+            std::memset(buffers.front().data(), 0x7f, size);
+            return DecodedTexture{1u, 1u, GL_RGBA, Assets::TextureType::Opaque, Color(0.5f, 0.5f, 0.5f, 1.0f), std::move(buffers)};
+        }
+
+        TEST_CASE("DecodedTextureCacheTest.pruneOldEntries", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+
+            // every entry takes a little more than 1000 bytes, so at most three entries fit into the cache
+            const DecodedTextureCache cache(env.dir() + Path("cache"), 4000u);
+            const auto texture = makeTexture(1000u);
+
+            for (uint64_t key = 1u; key <= 10u; ++key) {
+                cache.store(key, texture);
+
+                // the entry that was just stored is never removed
+                ASSERT_TRUE(cache.load(key).has_value());
+
+                auto entryCount = size_t(0);
+                for (uint64_t other = 1u; other <= key; ++other) {
+                    if (cache.load(other).has_value()) {
+                        ++entryCount;
+                    }
+                }
+                ASSERT_LE(entryCount, 3u);
+            }
+        }
+
+#if QT_VERSION >= QT_VERSION_CHECK(5, 10, 0)
+        static void setModificationTime(const Path& path, const QDateTime& time) {
+            QFile file(pathAsQString(path));
+            ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+            ASSERT_TRUE(file.setFileTime(time, QFileDevice::FileModificationTime));
+        }
+
+        static Path entryPath(const Path& directory, const uint64_t key) {
+            std::stringstream str;
+            str << std::hex << std::setw(16) << std::setfill('0') << key << ".tbtex";
+            return directory + Path(str.str());
+        }
+
+        TEST_CASE("DecodedTextureCacheTest.keyChangesWithModificationTime", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+            env.createFile(Path("texture.png"), "some image data");
+
+            const auto file = Disk::openFile(env.dir() + Path("texture.png"));
+            const auto key = DecodedTextureCache::key(*file, "test");
+
+            setModificationTime(env.dir() + Path("texture.png"), QDateTime::currentDateTime().addSecs(-60 * 60));
+            ASSERT_NE(key, DecodedTextureCache::key(*file, "test"));
+        }
+
+        TEST_CASE("DecodedTextureCacheTest.pruneLeastRecentlyUsedEntries", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+
+            // every entry takes a little more than 1000 bytes, so at most three entries fit into the cache
+            const auto directory = env.dir() + Path("cache");
+            const DecodedTextureCache cache(directory, 4000u);
+            const auto texture = makeTexture(1000u);
+
+            // the first entry is the oldest
+            const auto now = QDateTime::currentDateTime();
+            for (uint64_t key = 1u; key <= 3u; ++key) {
+                cache.store(key, texture);
+                setModificationTime(entryPath(directory, key), now.addSecs(-static_cast<qint64>(5u - key) * 60 * 60));
+            }
+
+            // loading the first entry makes it the most recently used one
+            ASSERT_TRUE(cache.load(1u).has_value());
+
+            cache.store(4u, texture);
+            ASSERT_TRUE(cache.load(1u).has_value());
+            ASSERT_FALSE(cache.load(2u).has_value());
+            ASSERT_TRUE(cache.load(4u).has_value());
+        }
+#endif
+
+        TEST_CASE("DecodedTextureCacheTest.clear", "[DecodedTextureCacheTest]") {
+            TestEnvironment env("texturecachetest");
+
+            const DecodedTextureCache cache(env.dir() + Path("cache"));
+            const auto texture = makeTexture(16u);
+            cache.store(1u, texture);
+            cache.store(2u, texture);
+            ASSERT_TRUE(cache.load(1u).has_value());
+            ASSERT_TRUE(cache.load(2u).has_value());
+
+            cache.clear();
+            ASSERT_FALSE(cache.load(1u).has_value());
+            ASSERT_FALSE(cache.load(2u).has_value());
+
+            // the cache can be used after it was cleared
+            cache.store(1u, texture);
+            ASSERT_TRUE(cache.load(1u).has_value());
+        }
+    }
+}
@@ -0,0 +1,95 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Logger.h"
+#include "Assets/EntityModel.h"
+#include "IO/EntityModelParser.h"
+#include "IO/File.h"
+#include "IO/Path.h"
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <cstring>
+#include <memory>
+#include <string>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace IO {
+        class TestModelParser : public EntityModelParser {
+        public:
+            static size_t liveParsers;
+        public:
+            TestModelParser() {
+                ++liveParsers;
+            }
+
+            ~TestModelParser() override {
+                --liveParsers;
+            }
+        private:
+            std::unique_ptr<Assets::EntityModel> doInitializeModel(Logger& /* logger */) override {
+                auto model = std::make_unique<Assets::EntityModel>("test", Assets::PitchType::Normal);
+                model->addFrames(2);
+                return model;
+            }
+
+            void doLoadFrame(const size_t frameIndex, Assets::EntityModel& model, Logger& /* logger */) override {
+                model.loadFrame(frameIndex, "frame" + std::to_string(frameIndex), vm::bbox3f(vm::vec3f(-1.0f, -1.0f, -1.0f), vm::vec3f(1.0f, 1.0f, 1.0f)));
+            }
+        };
+
+        size_t TestModelParser::liveParsers = 0u;
+
+        TEST_CASE("EntityModelParserTest.loadFrameReleasesData", "[EntityModelParserTest]") {
+            NullLogger logger;
+
+            const auto contents = std::string("model data");
+            auto buffer = std::make_unique<char[]>(contents.size());
+            std::memcpy(buffer.get(), contents.data(), contents.size());
+
+            auto file = std::make_shared<OwningBufferFile>(Path("test.mdl"), std::move(buffer), contents.size());
+            const auto weakFile = std::weak_ptr<File>(file);
+
+            auto model = initializeModel(std::move(file), [](const char* /* begin */, const char* /* end */) {
+                return std::make_unique<TestModelParser>();
+            }, logger);
+
+            // no parser is kept, only the file
+            ASSERT_EQ(0u, TestModelParser::liveParsers);
+            ASSERT_FALSE(weakFile.expired());
+            ASSERT_TRUE(model->hasFrameLoader());
+
+            model->loadFrame(0u, logger);
+            ASSERT_EQ(0u, TestModelParser::liveParsers);
+            ASSERT_FALSE(weakFile.expired());
+            ASSERT_TRUE(model->frame(0u)->loaded());
+            ASSERT_FALSE(model->frame(1u)->loaded());
+
+            // the file is released once all frames are loaded
+            model->loadFrame(1u, logger);
+            ASSERT_EQ(0u, TestModelParser::liveParsers);
+            ASSERT_TRUE(weakFile.expired());
+            ASSERT_TRUE(model->frame(1u)->loaded());
+        }
+    }
+}
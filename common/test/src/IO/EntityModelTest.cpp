@@ -36,6 +36,9 @@
 #include <vecmath/intersection.h>
 #include <vecmath/ray.h>
 
+#include <thread>
+#include <vector>
+
 #include "Catch2.h"
 #include "GTestCompat.h"
 
@@ -87,5 +90,49 @@ namespace TrenchBroom {
             CHECK(vm::is_nan(frame->intersect(missRay)));
             CHECK(vm::is_nan(vm::intersect_ray_bbox(missRay, box)));
         }
+
+        TEST_CASE("BSP model concurrent intersection test", "[EntityModelTest]") {
+            TestLogger logger;
+
+            const auto configPath = IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/games/Quake/GameConfig.cfg");
+            const auto gamePath = IO::Disk::getCurrentWorkingDir() + IO::Path("fixture/test/Model/Game/Quake");
+            const auto configStr = IO::Disk::readFile(configPath);
+            auto configParser = IO::GameConfigParser(configStr, configPath);
+            Model::GameConfig config = configParser.parse();
+
+            auto game = Model::GameImpl(config, gamePath, logger);
+
+            const auto path = IO::Path("cube.bsp");
+
+            std::unique_ptr<Assets::EntityModel> model = game.initializeModel(path, logger);
+            game.loadFrame(path, 0, *model, logger);
+
+            const Assets::EntityModelFrame* frame = model->frames().at(0);
+            const auto box = vm::bbox3f(vm::vec3f::fill(-32), vm::vec3f::fill(32));
+
+            // all threads pick the frame before its hierarchy is built, so they race to build it
+            const auto threadCount = size_t(8);
+            std::vector<std::vector<float>> distances(threadCount);
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&, i]() {
+                    for (int x = -45; x <= 45; x += 15) {
+                        const auto ray = vm::ray3f(vm::vec3f(static_cast<float>(x), -45.0f, 45.0f), vm::normalize(-vm::vec3f(static_cast<float>(x), -45.0f, 45.0f)));
+                        distances[i].push_back(frame->intersect(ray));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t i = 0; i < threadCount; ++i) {
+                auto j = size_t(0);
+                for (int x = -45; x <= 45; x += 15, ++j) {
+                    const auto ray = vm::ray3f(vm::vec3f(static_cast<float>(x), -45.0f, 45.0f), vm::normalize(-vm::vec3f(static_cast<float>(x), -45.0f, 45.0f)));
+                    CHECK(vm::intersect_ray_bbox(ray, box) == Approx(distances[i][j]));
+                }
+            }
+        }
     }
 }
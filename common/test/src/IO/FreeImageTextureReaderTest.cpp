@@ -87,10 +87,16 @@ namespace TrenchBroom {
 
             ASSERT_EQ(w, texture.width());
             ASSERT_EQ(h, texture.height());
-            ASSERT_EQ(1u, texture.buffersIfUnprepared().size());
             ASSERT_TRUE((GL_BGRA == texture.format() || GL_RGBA == texture.format()));
             ASSERT_EQ(Assets::TextureType::Opaque, texture.type());
 
+            // the full mipmap chain down to 1x1
+            const auto& buffers = texture.buffersIfUnprepared();
+            ASSERT_EQ(7u, buffers.size());
+            for (std::size_t level = 0; level < buffers.size(); ++level) {
+                ASSERT_EQ((w >> level) * (h >> level) * 4u, buffers[level].size());
+            }
+
             for (std::size_t y = 0; y < h; ++y) {
                 for (std::size_t x = 0; x < w; ++x) {
                     if (x == 0 && y == 0) {
@@ -25,12 +25,16 @@
 #include "Assets/TextureCollection.h"
 #include "IO/DiskFileSystem.h"
 #include "IO/DiskIO.h"
+#include "IO/FileMatcher.h"
 #include "IO/IdMipTextureReader.h"
 #include "IO/Path.h"
 #include "IO/TextureReader.h"
 #include "IO/WadFileSystem.h"
 
+#include <algorithm>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Catch2.h"
 #include "GTestCompat.h"
@@ -78,5 +82,90 @@ namespace TrenchBroom {
             assertTexture("blowjob_machine",   128, 128, wadFS, textureLoader);
             assertTexture("lasthopeofhuman",   128, 128, wadFS, textureLoader);
         }
+
+        TEST_CASE("IdMipTextureReaderTest.testLoadWadHeaders", "[IdMipTextureReaderTest]") {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("fixture/test/palette.lmp"));
+
+            TextureReader::TextureNameStrategy nameStrategy;
+            NullLogger logger;
+            IdMipTextureReader textureLoader(nameStrategy, fs, logger, palette);
+
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath, logger);
+
+            const auto path = Path("cr8_czg_3.D");
+            auto texture = textureLoader.readTextureHeader(wadFS.openFile(path), logger);
+            ASSERT_EQ("cr8_czg_3", texture.name());
+            ASSERT_EQ(64u, texture.width());
+            ASSERT_EQ(128u, texture.height());
+            ASSERT_TRUE(texture.buffersIfUnprepared().empty());
+
+            texture.setDecoder([&](Logger& decoderLogger) {
+                return textureLoader.readTexture(wadFS.openFile(path), decoderLogger);
+            });
+            ASSERT_TRUE(texture.deferred());
+            ASSERT_TRUE(texture.needsLoading());
+
+            texture.load(texture.decode(logger));
+            ASSERT_TRUE(texture.deferred());
+            ASSERT_FALSE(texture.needsLoading());
+            ASSERT_EQ(4u, texture.buffersIfUnprepared().size());
+        }
+        static bool equalTextures(const Assets::Texture& lhs, const Assets::Texture& rhs) {
+            if (lhs.name() != rhs.name() || lhs.width() != rhs.width() || lhs.height() != rhs.height()) {
+                return false;
+            }
+
+            const auto& lhsBuffers = lhs.buffersIfUnprepared();
+            const auto& rhsBuffers = rhs.buffersIfUnprepared();
+            return std::equal(std::begin(lhsBuffers), std::end(lhsBuffers), std::begin(rhsBuffers), std::end(rhsBuffers), [](const auto& lhsBuffer, const auto& rhsBuffer) {
+                return std::equal(lhsBuffer.data(), lhsBuffer.data() + lhsBuffer.size(), rhsBuffer.data(), rhsBuffer.data() + rhsBuffer.size());
+            });
+        }
+
+        TEST_CASE("IdMipTextureReaderTest.testLoadWadConcurrently", "[IdMipTextureReaderTest]") {
+            DiskFileSystem fs(IO::Disk::getCurrentWorkingDir());
+            const Assets::Palette palette = Assets::Palette::loadFile(fs, Path("fixture/test/palette.lmp"));
+
+            TextureReader::TextureNameStrategy nameStrategy;
+            NullLogger logger;
+            IdMipTextureReader textureLoader(nameStrategy, fs, logger, palette);
+
+            const Path wadPath = Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Wad/cr8_czg.wad");
+            WadFileSystem wadFS(wadPath, logger);
+
+            const auto paths = wadFS.findItems(Path(""), FileExtensionMatcher("D"));
+            ASSERT_EQ(21u, paths.size());
+
+            std::vector<Assets::Texture> expected;
+            for (const auto& path : paths) {
+                expected.push_back(textureLoader.readTexture(wadFS.openFile(path), logger));
+            }
+
+            // all textures share the file of the wad, which every thread reads from at the same time
+            const size_t threadCount = 4u;
+            std::vector<std::vector<Assets::Texture>> actual(threadCount);
+            std::vector<std::thread> threads;
+            for (size_t i = 0u; i < threadCount; ++i) {
+                threads.emplace_back([&, i]() {
+                    NullLogger threadLogger;
+                    for (size_t j = 0u; j < paths.size(); ++j) {
+                        // every thread starts with a different texture
+                        const auto& path = paths[(i * 5u + j) % paths.size()];
+                        actual[i].push_back(textureLoader.readTexture(wadFS.openFile(path), threadLogger));
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t i = 0u; i < threadCount; ++i) {
+                for (size_t j = 0u; j < paths.size(); ++j) {
+                    ASSERT_TRUE(equalTextures(expected[(i * 5u + j) % paths.size()], actual[i][j]));
+                }
+            }
+        }
     }
 }
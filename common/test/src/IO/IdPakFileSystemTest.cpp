@@ -19,10 +19,15 @@
 
 #include "Exceptions.h"
 #include "IO/DiskIO.h"
+#include "IO/File.h"
 #include "IO/FileMatcher.h"
 #include "IO/IdPakFileSystem.h"
+#include "IO/Reader.h"
 
 #include <algorithm>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "Catch2.h"
 #include "GTestCompat.h"
@@ -139,5 +144,48 @@ namespace TrenchBroom {
 
             ASSERT_TRUE(fs.openFile(Path("amnet.cfg")) != nullptr);
         }
+
+        static std::string readContents(const File& file) {
+            // buffers the entry, which reads from the file shared by all entries of the pak file
+            const auto reader = file.reader().buffer();
+            return std::string(reader.begin(), reader.end());
+        }
+
+        TEST_CASE("IdPakFileSystemTest.bufferFilesConcurrently", "[IdPakFileSystemTest]") {
+            const Path pakPath = Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Pak/pak1.pak");
+
+            const IdPakFileSystem fs(pakPath);
+            const auto paths = fs.findItemsRecursively(Path("textures"), FileExtensionMatcher("wal"));
+            ASSERT_EQ(7u, paths.size());
+
+            std::vector<std::string> expected;
+            for (const auto& path : paths) {
+                expected.push_back(readContents(*fs.openFile(path)));
+            }
+
+            // every thread buffers all entries, so the reads of the shared file interleave
+            const auto threadCount = size_t(4);
+            std::vector<std::vector<std::string>> actual(threadCount);
+            std::vector<std::thread> threads;
+            for (size_t i = 0; i < threadCount; ++i) {
+                threads.emplace_back([&, i]() {
+                    for (size_t j = 0; j < 20; ++j) {
+                        for (const auto& path : paths) {
+                            actual[i].push_back(readContents(*fs.openFile(path)));
+                        }
+                    }
+                });
+            }
+            for (auto& thread : threads) {
+                thread.join();
+            }
+
+            for (size_t i = 0; i < threadCount; ++i) {
+                ASSERT_EQ(20u * expected.size(), actual[i].size());
+                for (size_t j = 0; j < actual[i].size(); ++j) {
+                    ASSERT_EQ(expected[j % expected.size()], actual[i][j]);
+                }
+            }
+        }
     }
 }
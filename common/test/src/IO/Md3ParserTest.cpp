@@ -17,6 +17,7 @@
  along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include "Exceptions.h"
 #include "Logger.h"
 #include "Assets/EntityModel.h"
 #include "IO/DiskFileSystem.h"
@@ -107,5 +108,41 @@ namespace TrenchBroom {
                 ASSERT_NO_THROW(parser.loadFrame(i, *model, logger));
             }
         }
+
+        TEST_CASE("Md3ParserTest.loadFramesInAnyOrder", "[Md3ParserTest]") {
+            NullLogger logger;
+            const auto shaderSearchPath = Path("scripts");
+            const auto textureSearchPaths = std::vector<Path> { Path("models") };
+            std::shared_ptr<FileSystem> fs = std::make_shared<DiskFileSystem>(IO::Disk::getCurrentWorkingDir() + Path("fixture/test/IO/Md3/armor"));
+            fs = std::make_shared<Quake3ShaderFileSystem>(fs, shaderSearchPath, textureSearchPaths, logger);
+
+            const auto md3Path = IO::Path("models/armor_red.md3");
+            const auto md3File = fs->openFile(md3Path);
+            ASSERT_NE(nullptr, md3File);
+
+            auto reader = md3File->reader().buffer();
+
+            // one parser loads all frames backwards, reusing its frame table
+            auto parser = Md3Parser("armor_red", std::begin(reader), std::end(reader), *fs);
+            auto model = parser.initializeModel(logger);
+            for (size_t i = model->frameCount(); i > 0u; --i) {
+                parser.loadFrame(i - 1u, *model, logger);
+            }
+
+            // every frame is loaded by a separate parser
+            for (size_t i = 0; i < model->frameCount(); ++i) {
+                auto expectedParser = Md3Parser("armor_red", std::begin(reader), std::end(reader), *fs);
+                auto expectedModel = expectedParser.initializeModel(logger);
+                expectedParser.loadFrame(i, *expectedModel, logger);
+
+                const auto* frame = model->frame(i);
+                const auto* expectedFrame = expectedModel->frame(i);
+                ASSERT_TRUE(frame->loaded());
+                ASSERT_EQ(expectedFrame->name(), frame->name());
+                ASSERT_EQ(expectedFrame->bounds(), frame->bounds());
+            }
+
+            EXPECT_THROW(parser.loadFrame(model->frameCount(), *model, logger), AssetException);
+        }
     }
 }
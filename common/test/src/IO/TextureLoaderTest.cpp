@@ -26,6 +26,7 @@
 #include "IO/TextureLoader.h"
 #include "Model/GameConfig.h"
 
+#include <memory>
 #include <string>
 
 #include "Catch2.h"
@@ -51,7 +52,7 @@ namespace TrenchBroom {
 
             const IO::Path root = IO::Disk::getCurrentWorkingDir();
             const std::vector<IO::Path> fileSearchPaths{ root };
-            const IO::DiskFileSystem fileSystem(root, true);
+            const auto fileSystem = std::make_shared<IO::DiskFileSystem>(root, true);
 
             const Model::TextureConfig textureConfig(
                 Model::TexturePackageConfig(
@@ -96,7 +97,7 @@ namespace TrenchBroom {
 
             const IO::Path root = IO::Disk::getCurrentWorkingDir();
             const std::vector<IO::Path> fileSearchPaths{ root };
-            const IO::DiskFileSystem fileSystem(root, true);
+            const auto fileSystem = std::make_shared<IO::DiskFileSystem>(root, true);
 
             const Model::TextureConfig textureConfig(
                 Model::TexturePackageConfig(
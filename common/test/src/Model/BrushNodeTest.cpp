@@ -37,12 +37,18 @@
 #include <kdl/vector_utils.h>
 
 #include <vecmath/vec.h>
+#include <vecmath/mat.h>
+#include <vecmath/mat_ext.h>
+#include <vecmath/scalar.h>
 #include <vecmath/segment.h>
 #include <vecmath/polygon.h>
 #include <vecmath/ray.h>
 
+#include <cmath>
 #include <memory>
+#include <optional>
 #include <string>
+#include <tuple>
 #include <vector>
 
 #include "Catch2.h"
@@ -380,6 +386,73 @@ namespace TrenchBroom {
             ASSERT_TRUE(hits2.empty());
         }
 
+        TEST_CASE("BrushNodeTest.pickManyFaces", "[BrushNodeTest]") {
+            const vm::bbox3 worldBounds(4096.0);
+            WorldNode world(MapFormat::Standard);
+            const BrushBuilder builder(&world, worldBounds);
+
+            // build a 24 sided prism around the z axis
+            std::vector<vm::vec3> points;
+            for (size_t i = 0u; i < 24u; ++i) {
+                const auto angle = vm::to_radians(static_cast<FloatType>(i) * 15.0);
+                const auto x = vm::round(std::cos(angle) * 128.0);
+                const auto y = vm::round(std::sin(angle) * 128.0);
+                points.emplace_back(x, y, -32.0);
+                points.emplace_back(x, y, +32.0);
+            }
+
+            BrushNode brushNode(builder.createBrush(points, "texture").value());
+            const Brush& brush = brushNode.brush();
+
+            const auto findFaceHit = [&](const vm::ray3& ray) -> std::optional<std::tuple<FloatType, size_t>> {
+                for (size_t i = 0u; i < brush.faceCount(); ++i) {
+                    const auto distance = brush.face(i).intersectWithRay(ray);
+                    if (!vm::is_nan(distance)) {
+                        return std::make_tuple(distance, i);
+                    }
+                }
+                return std::nullopt;
+            };
+
+            for (size_t i = 0u; i < 72u; ++i) {
+                const auto angle = vm::to_radians(static_cast<FloatType>(i) * 5.0 + 1.0);
+                const auto origin = vm::vec3(std::cos(angle) * 512.0, std::sin(angle) * 512.0, 8.0);
+                const auto target = vm::vec3(0.0, static_cast<FloatType>(i) - 36.0, -8.0);
+                const auto ray = vm::ray3(origin, vm::normalize(target - origin));
+
+                PickResult pickResult;
+                brushNode.pick(ray, pickResult);
+
+                const auto expected = findFaceHit(ray);
+                REQUIRE(expected);
+                REQUIRE(pickResult.size() == 1u);
+
+                const auto& hit = pickResult.all().front();
+                const auto [expectedDistance, expectedFaceIndex] = *expected;
+                EXPECT_DOUBLE_EQ(expectedDistance, hit.distance());
+                CHECK(hitToFaceHandle(hit)->faceIndex() == expectedFaceIndex);
+            }
+
+            // rays that miss the brush or start inside of it don't hit anything
+            PickResult missResult;
+            brushNode.pick(vm::ray3(vm::vec3(0.0, 0.0, 64.0), vm::vec3::pos_x()), missResult);
+            brushNode.pick(vm::ray3(vm::vec3(0.0, 0.0, 0.0), vm::vec3::pos_x()), missResult);
+            brushNode.pick(vm::ray3(vm::vec3(-512.0, 0.0, 0.0), vm::vec3::neg_x()), missResult);
+            CHECK(missResult.empty());
+
+            // moving the brush updates the cached face polygons
+            REQUIRE(brushNode.transform(worldBounds, vm::translation_matrix(vm::vec3(0.0, 0.0, 1024.0)), false).is_success());
+
+            PickResult movedResult;
+            brushNode.pick(vm::ray3(vm::vec3(-512.0, 0.0, 1024.0), vm::vec3::pos_x()), movedResult);
+            REQUIRE(movedResult.size() == 1u);
+            EXPECT_DOUBLE_EQ(384.0, movedResult.all().front().distance());
+
+            PickResult oldPositionResult;
+            brushNode.pick(vm::ray3(vm::vec3(-512.0, 0.0, 0.0), vm::vec3::pos_x()), oldPositionResult);
+            CHECK(oldPositionResult.empty());
+        }
+
         TEST_CASE("BrushNodeTest.clone", "[BrushNodeTest]") {
             const vm::bbox3 worldBounds(4096.0);
 
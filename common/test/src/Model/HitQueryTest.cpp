@@ -0,0 +1,133 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/EditorContext.h"
+#include "Model/EntityNode.h"
+#include "Model/Hit.h"
+#include "Model/HitQuery.h"
+#include "Model/HitType.h"
+#include "Model/VisibilityState.h"
+
+#include <vecmath/vec.h>
+
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static const auto MatchType = HitType::freeType();
+        static const auto OccluderType = HitType::freeType();
+
+        static Hit makeHit(const HitType::Type type, const FloatType distance, const FloatType error = 0.0) {
+            return Hit(type, distance, vm::vec3::zero(), 0, error);
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalWithoutHits", "[HitQueryTest]") {
+            const auto hits = std::vector<Hit>();
+            const auto query = HitQuery(hits).type(MatchType);
+
+            ASSERT_FALSE(query.firstIsFinal(1000.0));
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalWithOccluder", "[HitQueryTest]") {
+            const auto hits = std::vector<Hit>{
+                makeHit(MatchType, 1.0, 0.5),
+                makeHit(OccluderType, 2.0)
+            };
+            const auto query = HitQuery(hits).type(MatchType);
+
+            // further hits at the occluder's distance join its group and could still change the result
+            ASSERT_FALSE(query.firstIsFinal(1.5));
+            ASSERT_FALSE(query.firstIsFinal(2.0));
+            ASSERT_TRUE(query.firstIsFinal(2.5));
+
+            // without the occluder, a later match with less error could still replace the first one
+            const auto matchesOnly = std::vector<Hit>{ hits.front() };
+            ASSERT_FALSE(HitQuery(matchesOnly).type(MatchType).firstIsFinal(1000.0));
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalWithExcludedOccluder", "[HitQueryTest]") {
+            const auto hits = std::vector<Hit>{
+                makeHit(MatchType, 1.0, 0.5),
+                makeHit(OccluderType, 2.0)
+            };
+
+            // hits of the excluded type do not occlude anything
+            const auto query = HitQuery(hits).type(MatchType).occluded(OccluderType);
+            ASSERT_FALSE(query.firstIsFinal(1000.0));
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalWithZeroErrorMatch", "[HitQueryTest]") {
+            const auto hits = std::vector<Hit>{
+                makeHit(MatchType, 1.0, 0.5),
+                makeHit(MatchType, 2.0, 0.0)
+            };
+            const auto query = HitQuery(hits).type(MatchType);
+
+            // the match without error cannot be replaced by any later hit
+            ASSERT_FALSE(query.firstIsFinal(2.0));
+            ASSERT_TRUE(query.firstIsFinal(2.5));
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalWithEqualDistanceGroup", "[HitQueryTest]") {
+            const auto hits = std::vector<Hit>{
+                makeHit(MatchType, 1.0, 0.5),
+                makeHit(OccluderType, 1.0),
+                makeHit(MatchType, 1.0, 0.25)
+            };
+            const auto query = HitQuery(hits).type(MatchType);
+
+            // the group straddles the remaining distance as long as they are almost equal
+            ASSERT_FALSE(query.firstIsFinal(1.0));
+            ASSERT_FALSE(query.firstIsFinal(1.0 + vm::C::almost_zero() / 2.0));
+            ASSERT_TRUE(query.firstIsFinal(1.0 + 2.0 * vm::C::almost_zero()));
+
+            // a hit added to the group could still change the result while the group is not final
+            auto moreHits = hits;
+            moreHits.push_back(makeHit(MatchType, 1.0, 0.0));
+            ASSERT_EQ(0.0, HitQuery(moreHits).type(MatchType).first().error());
+        }
+
+        TEST_CASE("HitQueryTest.firstIsFinalIgnoresHiddenHits", "[HitQueryTest]") {
+            EditorContext editorContext;
+
+            EntityNode hiddenEntity;
+            hiddenEntity.setVisibilityState(VisibilityState::Visibility_Hidden);
+            EntityNode visibleEntity;
+
+            const auto hiddenOccluder = Hit(EntityNode::EntityHitType, 1.0, vm::vec3::zero(), static_cast<EntityNode*>(&hiddenEntity));
+            const auto visibleOccluder = Hit(EntityNode::EntityHitType, 3.0, vm::vec3::zero(), static_cast<EntityNode*>(&visibleEntity), 1.0);
+
+            const auto hits = std::vector<Hit>{
+                hiddenOccluder,
+                makeHit(MatchType, 2.0, 0.5),
+                visibleOccluder
+            };
+            const auto query = HitQuery(hits, editorContext).type(MatchType);
+
+            // the hidden occluder is skipped, so the result is only final after the visible occluder
+            ASSERT_FALSE(query.firstIsFinal(2.5));
+            ASSERT_TRUE(query.firstIsFinal(3.5));
+            ASSERT_EQ(2.0, query.first().distance());
+        }
+    }
+}
@@ -140,7 +140,7 @@ namespace TrenchBroom {
 
             const IO::Path root = IO::Disk::getCurrentWorkingDir();
             const std::vector<IO::Path> fileSearchPaths{ root };
-            const IO::DiskFileSystem fileSystem(root, true);
+            const auto fileSystem = std::make_shared<IO::DiskFileSystem>(root, true);
 
             const Model::TextureConfig textureConfig(
                 Model::TexturePackageConfig(
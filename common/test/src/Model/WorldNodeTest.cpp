@@ -0,0 +1,223 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "Model/Brush.h"
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/EditorContext.h"
+#include "Model/EntityAttributes.h"
+#include "Model/EntityNode.h"
+#include "Model/Hit.h"
+#include "Model/HitAdapter.h"
+#include "Model/HitQuery.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/PickResult.h"
+#include "Model/VisibilityState.h"
+#include "Model/WorldNode.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+#include <vecmath/ray.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Model {
+        static std::vector<Node*> pickNodes(WorldNode& world, const vm::ray3& ray) {
+            PickResult pickResult;
+            world.pick(ray, pickResult);
+
+            std::vector<Node*> result;
+            for (const auto& hit : pickResult.all()) {
+                result.push_back(hitToNode(hit));
+            }
+            return result;
+        }
+
+        TEST_CASE("WorldNodeTest.deferNodeTreeUpdates", "[WorldNodeTest]") {
+            WorldNode world(MapFormat::Standard);
+
+            auto* entity = new EntityNode();
+            world.defaultLayer()->addChild(entity);
+
+            auto* removedEntity = new EntityNode();
+            removedEntity->setAttributes({EntityAttribute("origin", "0 128 0")});
+            world.defaultLayer()->addChild(removedEntity);
+
+            const auto oldRay = vm::ray3(vm::vec3(0.0, 0.0, 256.0), vm::vec3::neg_z());
+            const auto newRay = vm::ray3(vm::vec3(256.0, 0.0, 256.0), vm::vec3::neg_z());
+            const auto removedRay = vm::ray3(vm::vec3(0.0, 128.0, 256.0), vm::vec3::neg_z());
+
+            {
+                const WorldNode::DeferNodeTreeUpdates deferNodeTreeUpdates(world);
+                entity->setAttributes({EntityAttribute("origin", "256 0 0")});
+
+                // the removed entity's update was collected, but it must be skipped when the updates are applied
+                removedEntity->setAttributes({EntityAttribute("origin", "0 128 64")});
+                world.defaultLayer()->removeChild(removedEntity);
+                delete removedEntity;
+
+                // the node tree is not updated yet
+                CHECK(pickNodes(world, oldRay) == std::vector<Node*>{ entity });
+                CHECK(pickNodes(world, newRay).empty());
+            }
+
+            CHECK(pickNodes(world, oldRay).empty());
+            CHECK(pickNodes(world, newRay) == std::vector<Node*>{ entity });
+            CHECK(pickNodes(world, removedRay).empty());
+        }
+
+        TEST_CASE("WorldNodeTest.deferNodeTreeUpdatesAppliesUpdatesOnException", "[WorldNodeTest]") {
+            WorldNode world(MapFormat::Standard);
+
+            auto* entity = new EntityNode();
+            world.defaultLayer()->addChild(entity);
+
+            try {
+                const WorldNode::DeferNodeTreeUpdates deferNodeTreeUpdates(world);
+                entity->setAttributes({EntityAttribute("origin", "256 0 0")});
+                throw std::runtime_error("error");
+            } catch (const std::runtime_error&) {}
+
+            const auto newRay = vm::ray3(vm::vec3(256.0, 0.0, 256.0), vm::vec3::neg_z());
+            CHECK(pickNodes(world, newRay) == std::vector<Node*>{ entity });
+        }
+
+        TEST_CASE("WorldNodeTest.pickManyCandidates", "[WorldNodeTest]") {
+            const vm::bbox3 worldBounds(8192.0);
+            WorldNode world(MapFormat::Standard);
+            BrushBuilder builder(&world, worldBounds);
+
+            // enough nodes along the ray to pick them on several threads
+            std::vector<Node*> nodes;
+            for (size_t i = 0; i < 200; ++i) {
+                const auto z = static_cast<FloatType>(i) * 32.0;
+                if (i % 4u == 0u) {
+                    auto* entity = new EntityNode();
+                    entity->setAttributes({EntityAttribute("origin", "0 0 " + std::to_string(static_cast<int>(z)))});
+                    world.defaultLayer()->addChild(entity);
+                    nodes.push_back(entity);
+                } else {
+                    auto* brush = world.createBrush(builder.createCuboid(vm::bbox3(vm::vec3(-8.0, -8.0, z - 8.0), vm::vec3(8.0, 8.0, z + 8.0)), "texture").value());
+                    world.defaultLayer()->addChild(brush);
+                    nodes.push_back(brush);
+                }
+            }
+
+            const auto ray = vm::ray3(vm::vec3(0.0, 0.0, 8000.0), vm::vec3::neg_z());
+
+            PickResult expected;
+            for (auto* node : nodes) {
+                node->pick(ray, expected);
+            }
+            REQUIRE(expected.size() == nodes.size());
+
+            // picking the nodes concurrently yields the same hits in the same order as picking them one by one
+            for (size_t i = 0; i < 10; ++i) {
+                PickResult actual;
+                world.pick(ray, actual);
+
+                REQUIRE(actual.size() == expected.size());
+                for (size_t j = 0; j < expected.size(); ++j) {
+                    CHECK(hitToNode(actual.all()[j]) == hitToNode(expected.all()[j]));
+                    CHECK(actual.all()[j].distance() == expected.all()[j].distance());
+                }
+            }
+        }
+
+        TEST_CASE("WorldNodeTest.pickFirstMatchesPick", "[WorldNodeTest]") {
+            const vm::bbox3 worldBounds(8192.0);
+            WorldNode world(MapFormat::Standard);
+            BrushBuilder builder(&world, worldBounds);
+            EditorContext editorContext;
+
+            // brushes of different sizes and entities stacked along the z axis, some of them hidden
+            for (size_t i = 0; i < 40; ++i) {
+                const auto z = static_cast<FloatType>(i) * 32.0;
+                Node* node;
+                if (i % 3u == 0u) {
+                    auto* entity = new EntityNode();
+                    entity->setAttributes({EntityAttribute("origin", "0 0 " + std::to_string(static_cast<int>(z)))});
+                    node = entity;
+                } else {
+                    const auto size = i % 2u == 0u ? 8.0 : 16.0;
+                    node = world.createBrush(builder.createCuboid(vm::bbox3(vm::vec3(-size, -size, z - 8.0), vm::vec3(size, size, z + 8.0)), "texture").value());
+                }
+                if (i % 5u == 1u) {
+                    node->setVisibilityState(VisibilityState::Visibility_Hidden);
+                }
+                world.defaultLayer()->addChild(node);
+            }
+
+            const auto makeQueries = [&](const PickResult& pickResult) {
+                return std::vector<HitQuery>{
+                    pickResult.query().pickable().type(BrushNode::BrushHitType),
+                    pickResult.query().pickable().type(BrushNode::BrushHitType).occluded(EntityNode::EntityHitType),
+                    pickResult.query().pickable().type(EntityNode::EntityHitType),
+                    pickResult.query().type(EntityNode::EntityHitType).minDistance(100.0)
+                };
+            };
+
+            const auto rays = std::vector<vm::ray3>{
+                vm::ray3(vm::vec3(0.0, 0.0, 2000.0), vm::vec3::neg_z()),
+                vm::ray3(vm::vec3(0.0, 0.0, -100.0), vm::vec3::pos_z()),
+                vm::ray3(vm::vec3(12.0, 0.0, 2000.0), vm::vec3::neg_z()),
+                vm::ray3(vm::vec3(-12.0, 4.0, -100.0), vm::vec3::pos_z())
+            };
+
+            auto earlyOuts = size_t(0);
+            for (const auto& ray : rays) {
+                auto expected = PickResult::byDistance(editorContext);
+                world.pick(ray, expected);
+                const auto expectedQueries = makeQueries(expected);
+
+                for (size_t i = 0; i < expectedQueries.size(); ++i) {
+                    // the query refers to the hits of the pick result, so it sees the hits added by pickFirst
+                    auto actual = PickResult::byDistance(editorContext);
+                    const auto actualQuery = makeQueries(actual)[i];
+                    world.pickFirst(ray, actual, actualQuery);
+
+                    const auto& expectedHit = expectedQueries[i].first();
+                    const auto& actualHit = actualQuery.first();
+                    CHECK(actualHit.isMatch() == expectedHit.isMatch());
+                    if (expectedHit.isMatch() && actualHit.isMatch()) {
+                        CHECK(hitToNode(actualHit) == hitToNode(expectedHit));
+                        CHECK(actualHit.distance() == expectedHit.distance());
+                    }
+
+                    if (actual.size() < expected.size()) {
+                        ++earlyOuts;
+                    }
+                }
+            }
+
+            // most queries are decided long before all nodes are picked
+            CHECK(earlyOuts > 0u);
+        }
+    }
+}
@@ -246,6 +246,102 @@ namespace TrenchBroom {
             }
         }
 
+        TEST_CASE("AllocationTrackerTest.compact", "[AllocationTrackerTest]") {
+            AllocationTracker t(500);
+
+            AllocationTracker::Block* blocks[5];
+            for (size_t i = 0; i < 5; ++i) {
+                blocks[i] = t.allocate(100);
+            }
+
+            t.free(blocks[0]);
+            t.free(blocks[2]);
+            EXPECT_EQ(300u, t.usedSize());
+            EXPECT_FALSE(t.compacted());
+
+            const auto moves = t.compact(1000);
+            ASSERT_EQ(3u, moves.size());
+            EXPECT_EQ(blocks[1], moves[0].block);
+            EXPECT_EQ(100u, moves[0].oldPos);
+            EXPECT_EQ(blocks[3], moves[1].block);
+            EXPECT_EQ(300u, moves[1].oldPos);
+            EXPECT_EQ(blocks[4], moves[2].block);
+            EXPECT_EQ(400u, moves[2].oldPos);
+
+            EXPECT_EQ(0u, blocks[1]->pos);
+            EXPECT_EQ(100u, blocks[3]->pos);
+            EXPECT_EQ(200u, blocks[4]->pos);
+
+            EXPECT_TRUE(t.compacted());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{0, 100}, {100, 100}, {200, 100}}), t.usedBlocks());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{300, 200}}), t.freeBlocks());
+            EXPECT_EQ(200u, t.largestPossibleAllocation());
+            EXPECT_EQ(300u, t.usedSize());
+
+            EXPECT_TRUE(t.compact(1000).empty());
+        }
+
+        TEST_CASE("AllocationTrackerTest.compactIncrementally", "[AllocationTrackerTest]") {
+            AllocationTracker t(400);
+
+            AllocationTracker::Block* blocks[4];
+            for (size_t i = 0; i < 4; ++i) {
+                blocks[i] = t.allocate(100);
+            }
+
+            t.free(blocks[0]);
+
+            // stops after the first block because its size reaches the limit
+            const auto firstMoves = t.compact(50);
+            ASSERT_EQ(1u, firstMoves.size());
+            EXPECT_EQ(blocks[1], firstMoves[0].block);
+            EXPECT_FALSE(t.compacted());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{0, 100}, {200, 100}, {300, 100}}), t.usedBlocks());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{100, 100}}), t.freeBlocks());
+
+            const auto secondMoves = t.compact(200);
+            ASSERT_EQ(2u, secondMoves.size());
+            EXPECT_EQ(blocks[2], secondMoves[0].block);
+            EXPECT_EQ(blocks[3], secondMoves[1].block);
+            EXPECT_TRUE(t.compacted());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{300, 100}}), t.freeBlocks());
+
+            // freed space can be allocated again
+            AllocationTracker::Block* newBlock = t.allocate(100);
+            ASSERT_NE(nullptr, newBlock);
+            EXPECT_EQ(300u, newBlock->pos);
+        }
+
+        TEST_CASE("AllocationTrackerTest.shrink", "[AllocationTrackerTest]") {
+            AllocationTracker t(400);
+
+            AllocationTracker::Block* blocks[2];
+            blocks[0] = t.allocate(100);
+            blocks[1] = t.allocate(100);
+
+            EXPECT_THROW(t.shrink(150), std::invalid_argument);
+            EXPECT_THROW(t.shrink(500), std::invalid_argument);
+
+            t.shrink(300);
+            EXPECT_EQ(300u, t.capacity());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{200, 100}}), t.freeBlocks());
+
+            t.shrink(200);
+            EXPECT_EQ(200u, t.capacity());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{}), t.freeBlocks());
+            EXPECT_EQ((std::vector<AllocationTracker::Range>{{0, 100}, {100, 100}}), t.usedBlocks());
+            EXPECT_EQ(nullptr, t.allocate(1));
+
+            t.free(blocks[0]);
+            t.free(blocks[1]);
+            t.shrink(0);
+            EXPECT_EQ(0u, t.capacity());
+            EXPECT_FALSE(t.hasAllocations());
+
+            t.expand(100);
+            EXPECT_NE(nullptr, t.allocate(100));
+        }
+
         static constexpr size_t NumBrushes = 64'000;
 
         // between 12 and 140, inclusive.
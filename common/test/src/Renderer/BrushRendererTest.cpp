@@ -0,0 +1,90 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Model/BrushBuilder.h"
+#include "Model/BrushNode.h"
+#include "Model/LayerNode.h"
+#include "Model/MapFormat.h"
+#include "Model/WorldNode.h"
+#include "Renderer/BrushRenderer.h"
+#include "Renderer/FontManager.h"
+#include "Renderer/OrthographicCamera.h"
+#include "Renderer/RenderBatch.h"
+#include "Renderer/RenderContext.h"
+#include "Renderer/ShaderManager.h"
+#include "Renderer/VboManager.h"
+
+#include <kdl/result.h>
+
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        TEST_CASE("BrushRendererTest.alternateVisibleChunks", "[BrushRendererTest]") {
+            const auto worldBounds = vm::bbox3(8192.0);
+            Model::WorldNode world(Model::MapFormat::Standard);
+            Model::BrushBuilder builder(&world, worldBounds);
+
+            // the brushes are far enough apart to be added to different chunks
+            auto* leftBrush = new Model::BrushNode(builder.createCuboid(vm::bbox3(vm::vec3(-2080.0, -32.0, -32.0), vm::vec3(-2016.0, 32.0, 32.0)), "texture").value());
+            auto* rightBrush = new Model::BrushNode(builder.createCuboid(vm::bbox3(vm::vec3(2016.0, -32.0, -32.0), vm::vec3(2080.0, 32.0, 32.0)), "texture").value());
+            world.defaultLayer()->addChild(leftBrush);
+            world.defaultLayer()->addChild(rightBrush);
+
+            BrushRenderer renderer;
+            renderer.addBrushes({ leftBrush, rightBrush });
+
+            FontManager fontManager;
+            ShaderManager shaderManager;
+            VboManager vboManager(&shaderManager);
+
+            // each camera only sees one of the brushes
+            const auto viewport = Camera::Viewport(0, 0, 256, 256);
+            const auto leftCamera = OrthographicCamera(1.0f, 8192.0f, viewport, vm::vec3f(-2048.0f, 0.0f, 1024.0f), vm::vec3f::neg_z(), vm::vec3f::pos_y());
+            const auto rightCamera = OrthographicCamera(1.0f, 8192.0f, viewport, vm::vec3f(2048.0f, 0.0f, 1024.0f), vm::vec3f::neg_z(), vm::vec3f::pos_y());
+            ASSERT_FALSE(leftCamera.intersectsFrustum(vm::bbox3f(rightBrush->logicalBounds())));
+            ASSERT_FALSE(rightCamera.intersectsFrustum(vm::bbox3f(leftBrush->logicalBounds())));
+
+            const auto render = [&](const Camera& camera) {
+                RenderContext renderContext(RenderMode::Render2D, camera, fontManager, shaderManager);
+                RenderBatch renderBatch(vboManager);
+                renderer.render(renderContext, renderBatch);
+            };
+
+            render(leftCamera);
+            const auto mergeCount = renderer.mergeCount();
+            ASSERT_NE(0u, mergeCount);
+
+            // the views only draw different ranges of the merged faces
+            render(rightCamera);
+            render(leftCamera);
+            render(rightCamera);
+            ASSERT_EQ(mergeCount, renderer.mergeCount());
+
+            // changing a brush merges its faces again
+            renderer.invalidateBrushes({ leftBrush });
+            render(rightCamera);
+            ASSERT_LT(mergeCount, renderer.mergeCount());
+        }
+    }
+}
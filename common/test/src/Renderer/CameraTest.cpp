@@ -18,8 +18,14 @@
  */
 
 #include "Renderer/Camera.h"
+#include "Renderer/OrthographicCamera.h"
 #include "Renderer/PerspectiveCamera.h"
 
+#include <vecmath/bbox.h>
+#include <vecmath/vec.h>
+
+#include <limits>
+
 #include "Catch2.h"
 #include "GTestCompat.h"
 
@@ -66,5 +72,64 @@ namespace TrenchBroom {
             ASSERT_FALSE(vm::is_nan(c.right()));
             ASSERT_FALSE(vm::is_nan(c.up()));
         }
+
+        TEST_CASE("CameraTest.perspectiveCameraIntersectsFrustum", "[CameraTest]") {
+            // at a distance of x, the camera sees 0.75 * x units up and down and x units to the sides
+            const auto c = PerspectiveCamera(90.0f, 1.0f, 8000.0f, Camera::Viewport(0, 0, 1024, 768), vm::vec3f::zero(), vm::vec3f::pos_x(), vm::vec3f::pos_z());
+
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(110.0f, 5.0f, 5.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(-10.0f, -10.0f, -10.0f), vm::vec3f(10.0f, 10.0f, 10.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, 50.0f, -5.0f), vm::vec3f(110.0f, 150.0f, 5.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, 70.0f), vm::vec3f(110.0f, 5.0f, 120.0f))));
+
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(-110.0f, -5.0f, -5.0f), vm::vec3f(-100.0f, 5.0f, 5.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, 500.0f, -5.0f), vm::vec3f(110.0f, 510.0f, 5.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -510.0f, -5.0f), vm::vec3f(110.0f, -500.0f, 5.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, 90.0f), vm::vec3f(110.0f, 5.0f, 100.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -100.0f), vm::vec3f(110.0f, 5.0f, -90.0f))));
+        }
+
+        TEST_CASE("CameraTest.orthographicCameraIntersectsFrustum", "[CameraTest]") {
+            // the camera sees 512 units to the sides and 384 units up and down
+            const auto c = OrthographicCamera(1.0f, 8000.0f, Camera::Viewport(0, 0, 1024, 768), vm::vec3f::zero(), vm::vec3f::pos_x(), vm::vec3f::pos_z());
+
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(110.0f, 5.0f, 5.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, 500.0f, -5.0f), vm::vec3f(110.0f, 510.0f, 5.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, 380.0f), vm::vec3f(110.0f, 5.0f, 390.0f))));
+            ASSERT_TRUE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(-1000.0f, -1000.0f, -1000.0f), vm::vec3f(1000.0f, 1000.0f, 1000.0f))));
+
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, 520.0f, -5.0f), vm::vec3f(110.0f, 530.0f, 5.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -530.0f, -5.0f), vm::vec3f(110.0f, -520.0f, 5.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, 390.0f), vm::vec3f(110.0f, 5.0f, 400.0f))));
+            ASSERT_FALSE(c.intersectsFrustum(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -400.0f), vm::vec3f(110.0f, 5.0f, -390.0f))));
+        }
+        TEST_CASE("CameraTest.perspectiveCameraMaxProjectedSize", "[CameraTest]") {
+            // at a distance of 384 units, one unit appears with a size of one pixel
+            const auto c = PerspectiveCamera(90.0f, 1.0f, 8000.0f, Camera::Viewport(0, 0, 1024, 768), vm::vec3f::zero(), vm::vec3f::pos_x(), vm::vec3f::pos_z());
+
+            ASSERT_FLOAT_EQ(10.0f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(384.0f, -5.0f, -5.0f), vm::vec3f(394.0f, 5.0f, 5.0f)), 10.0f));
+            ASSERT_FLOAT_EQ(38.4f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(110.0f, 5.0f, 5.0f)), 10.0f));
+
+            // the size does not depend on the lateral position
+            ASSERT_FLOAT_EQ(38.4f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(100.0f, 200.0f, -5.0f), vm::vec3f(110.0f, 210.0f, 5.0f)), 10.0f));
+
+            // detail placed anywhere within large bounds can appear as large as at their closest point
+            ASSERT_FLOAT_EQ(38.4f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(1000.0f, 5.0f, 5.0f)), 10.0f));
+
+            // bounds that reach the plane of the camera position can appear arbitrarily large
+            ASSERT_EQ(std::numeric_limits<float>::max(), c.maxProjectedSize(vm::bbox3f(vm::vec3f(-10.0f, -5.0f, -5.0f), vm::vec3f(10.0f, 5.0f, 5.0f)), 10.0f));
+            ASSERT_EQ(std::numeric_limits<float>::max(), c.maxProjectedSize(vm::bbox3f(vm::vec3f(-110.0f, -5.0f, -5.0f), vm::vec3f(-100.0f, 5.0f, 5.0f)), 10.0f));
+        }
+
+        TEST_CASE("CameraTest.orthographicCameraMaxProjectedSize", "[CameraTest]") {
+            auto c = OrthographicCamera(1.0f, 8000.0f, Camera::Viewport(0, 0, 1024, 768), vm::vec3f::zero(), vm::vec3f::pos_x(), vm::vec3f::pos_z());
+
+            // the size does not depend on the distance
+            ASSERT_FLOAT_EQ(10.0f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(110.0f, 5.0f, 5.0f)), 10.0f));
+            ASSERT_FLOAT_EQ(10.0f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(1000.0f, -5.0f, -5.0f), vm::vec3f(1010.0f, 5.0f, 5.0f)), 10.0f));
+
+            c.setZoom(2.0f);
+            ASSERT_FLOAT_EQ(20.0f, c.maxProjectedSize(vm::bbox3f(vm::vec3f(100.0f, -5.0f, -5.0f), vm::vec3f(110.0f, 5.0f, 5.0f)), 10.0f));
+        }
     }
 }
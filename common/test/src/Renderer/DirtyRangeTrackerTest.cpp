@@ -0,0 +1,96 @@
+/*
+ Copyright (C) 2020 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Renderer/BrushRendererArrays.h"
+
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        using Range = DirtyRangeTracker::Range;
+
+        TEST_CASE("DirtyRangeTrackerTest.initiallyClean", "[DirtyRangeTrackerTest]") {
+            DirtyRangeTracker t(10000);
+            EXPECT_TRUE(t.clean());
+            EXPECT_EQ(0u, t.dirtySize());
+            EXPECT_EQ(std::vector<Range>{}, t.dirtyRanges());
+        }
+
+        TEST_CASE("DirtyRangeTrackerTest.markDirty", "[DirtyRangeTrackerTest]") {
+            DirtyRangeTracker t(10000);
+
+            t.markDirty(5000, 10);
+            EXPECT_FALSE(t.clean());
+            EXPECT_EQ(10u, t.dirtySize());
+            EXPECT_EQ(std::vector<Range>({{5000, 10}}), t.dirtyRanges());
+
+            t.markDirty(1000, 10);
+            EXPECT_EQ(20u, t.dirtySize());
+            EXPECT_EQ(std::vector<Range>({{1000, 10}, {5000, 10}}), t.dirtyRanges());
+
+            t.markDirty(0, 0);
+            EXPECT_EQ(std::vector<Range>({{1000, 10}, {5000, 10}}), t.dirtyRanges());
+
+            EXPECT_ANY_THROW(t.markDirty(9995, 10));
+        }
+
+        TEST_CASE("DirtyRangeTrackerTest.mergeCloseRanges", "[DirtyRangeTrackerTest]") {
+            DirtyRangeTracker t(10000);
+
+            t.markDirty(1000, 10);
+            t.markDirty(2000, 10);
+            t.markDirty(1010 + DirtyRangeTracker::MaxGap, 10);
+            EXPECT_EQ(std::vector<Range>({{1000, 20 + DirtyRangeTracker::MaxGap}, {2000, 10}}), t.dirtyRanges());
+            EXPECT_EQ(20u + DirtyRangeTracker::MaxGap + 10u, t.dirtySize());
+
+            // overlaps both ranges
+            t.markDirty(1005, 1000);
+            EXPECT_EQ(std::vector<Range>({{1000, 1010}}), t.dirtyRanges());
+            EXPECT_EQ(1010u, t.dirtySize());
+        }
+
+        TEST_CASE("DirtyRangeTrackerTest.limitRangeCount", "[DirtyRangeTrackerTest]") {
+            const auto spacing = 2u * DirtyRangeTracker::MaxGap;
+            DirtyRangeTracker t((DirtyRangeTracker::MaxRangeCount + 1u) * spacing);
+
+            for (size_t i = 0u; i < DirtyRangeTracker::MaxRangeCount; ++i) {
+                t.markDirty(i * spacing, 1);
+            }
+            EXPECT_EQ(DirtyRangeTracker::MaxRangeCount, t.dirtyRanges().size());
+
+            // the new range is closest to the last range
+            t.markDirty((DirtyRangeTracker::MaxRangeCount - 1u) * spacing + DirtyRangeTracker::MaxGap + 2u, 1);
+            EXPECT_EQ(DirtyRangeTracker::MaxRangeCount, t.dirtyRanges().size());
+            EXPECT_EQ((Range{(DirtyRangeTracker::MaxRangeCount - 1u) * spacing, DirtyRangeTracker::MaxGap + 3u}), t.dirtyRanges().back());
+            EXPECT_EQ(DirtyRangeTracker::MaxRangeCount - 1u + DirtyRangeTracker::MaxGap + 3u, t.dirtySize());
+        }
+
+        TEST_CASE("DirtyRangeTrackerTest.expand", "[DirtyRangeTrackerTest]") {
+            DirtyRangeTracker t(100);
+            t.expand(10000);
+            EXPECT_EQ(10000u, t.capacity());
+            EXPECT_EQ(std::vector<Range>({{100, 9900}}), t.dirtyRanges());
+
+            EXPECT_ANY_THROW(t.expand(100));
+        }
+    }
+}
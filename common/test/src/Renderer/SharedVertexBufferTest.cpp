@@ -0,0 +1,124 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Renderer/GLVertexType.h"
+#include "Renderer/IndexRangeMap.h"
+#include "Renderer/PrimType.h"
+#include "Renderer/SharedVertexBuffer.h"
+#include "Renderer/VertexArray.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        using VertexBuffer = SharedVertexBuffer<GLVertexTypes::P3T2>;
+        using Vertex = VertexBuffer::Vertex;
+
+        static std::vector<Vertex> makeVertices(const size_t count) {
+            auto result = std::vector<Vertex>();
+            for (size_t i = 0; i < count; ++i) {
+                const auto f = static_cast<float>(i);
+                result.emplace_back(vm::vec3f(f, f, f), vm::vec2f(f, f));
+            }
+            return result;
+        }
+
+        TEST_CASE("SharedVertexBufferTest.insertVertices", "[SharedVertexBufferTest]") {
+            auto buffer = std::make_shared<VertexBuffer>();
+
+            const auto array1 = buffer->insertVertices(makeVertices(3));
+            const auto array2 = buffer->insertVertices(makeVertices(5));
+
+            ASSERT_EQ(3u, array1.vertexCount());
+            ASSERT_EQ(5u, array2.vertexCount());
+            ASSERT_EQ(8u, buffer->vertexCount());
+            ASSERT_LE(8u, buffer->capacity());
+        }
+
+        TEST_CASE("SharedVertexBufferTest.baseVertex", "[SharedVertexBufferTest]") {
+            auto buffer = std::make_shared<VertexBuffer>();
+
+            const auto array1 = buffer->insertVertices(makeVertices(3));
+            const auto array2 = buffer->insertVertices(makeVertices(5));
+            ASSERT_EQ(0u, array1.baseVertex());
+            ASSERT_EQ(3u, array2.baseVertex());
+
+            // the ranges rendered with a vertex array are offset by its base vertex
+            auto indices = IndexRangeMap();
+            indices.add(PrimType::Triangles, 0, 3);
+            indices.add(PrimType::TriangleFan, 1, 4);
+
+            auto offsetRanges = std::vector<std::tuple<PrimType, size_t, size_t>>();
+            indices.offset(array2.baseVertex()).forEachPrimitive([&](const PrimType primType, const size_t index, const size_t count) {
+                offsetRanges.emplace_back(primType, index, count);
+            });
+            ASSERT_EQ((std::vector<std::tuple<PrimType, size_t, size_t>>{
+                { PrimType::Triangles, 3, 3 },
+                { PrimType::TriangleFan, 4, 4 }
+            }), offsetRanges);
+        }
+
+        TEST_CASE("SharedVertexBufferTest.insertNoVertices", "[SharedVertexBufferTest]") {
+            auto buffer = std::make_shared<VertexBuffer>();
+
+            const auto array = buffer->insertVertices({});
+            ASSERT_TRUE(array.empty());
+            ASSERT_EQ(0u, buffer->vertexCount());
+        }
+
+        TEST_CASE("SharedVertexBufferTest.releaseVertices", "[SharedVertexBufferTest]") {
+            auto buffer = std::make_shared<VertexBuffer>();
+
+            auto array1 = buffer->insertVertices(makeVertices(3));
+            {
+                // copies share the range
+                const auto copy = array1;
+                array1 = VertexArray();
+                ASSERT_EQ(3u, buffer->vertexCount());
+            }
+            ASSERT_EQ(0u, buffer->vertexCount());
+
+            // released ranges are reused
+            const auto capacity = buffer->capacity();
+            const auto array2 = buffer->insertVertices(makeVertices(3));
+            ASSERT_EQ(3u, buffer->vertexCount());
+            ASSERT_EQ(capacity, buffer->capacity());
+        }
+
+        TEST_CASE("SharedVertexBufferTest.arraysKeepBufferAlive", "[SharedVertexBufferTest]") {
+            auto buffer = std::make_shared<VertexBuffer>();
+            const auto weakBuffer = std::weak_ptr<VertexBuffer>(buffer);
+
+            auto array = buffer->insertVertices(makeVertices(3));
+            buffer.reset();
+            ASSERT_FALSE(weakBuffer.expired());
+
+            array = VertexArray();
+            ASSERT_TRUE(weakBuffer.expired());
+        }
+    }
+}
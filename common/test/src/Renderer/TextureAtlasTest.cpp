@@ -0,0 +1,154 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "Color.h"
+#include "Assets/Texture.h"
+#include "Assets/TextureBuffer.h"
+#include "Renderer/GL.h"
+#include "Renderer/TextureAtlas.h"
+
+#include <vecmath/forward.h>
+#include <vecmath/vec.h>
+
+#include <string>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace Renderer {
+        static std::vector<Assets::Texture> makeTextures(const size_t count, const size_t width, const size_t height) {
+            auto result = std::vector<Assets::Texture>();
+            result.reserve(count);
+            for (size_t i = 0; i < count; ++i) {
+                auto buffers = Assets::TextureBufferList();
+                Assets::setMipBufferSize(buffers, 1u, width, height, GL_RGBA);
+                result.emplace_back("texture" + std::to_string(i), width, height, Color(), std::move(buffers), GL_RGBA, Assets::TextureType::Opaque);
+            }
+            return result;
+        }
+
+        static vm::vec2f slotCorner(const size_t x, const size_t y) {
+            const auto pageSize = static_cast<float>(TextureAtlas::PageSize);
+            return vm::vec2f(static_cast<float>(x) + 0.5f, static_cast<float>(y) + 0.5f) / pageSize;
+        }
+
+        TEST_CASE("TextureAtlasTest.packTextures", "[TextureAtlasTest]") {
+            // two slots per row and four slots per page
+            auto atlas = TextureAtlas(TextureAtlas::PageSize / 2u, 2u);
+            const auto textures = makeTextures(5u, 16u, 8u);
+
+            auto entries = std::vector<TextureAtlas::Entry>();
+            for (const auto& texture : textures) {
+                const auto entry = atlas.entry(texture);
+                ASSERT_TRUE(entry.has_value());
+                ASSERT_TRUE(atlas.contains(texture));
+                entries.push_back(*entry);
+            }
+
+            ASSERT_EQ(0u, entries[0].page);
+            ASSERT_EQ(slotCorner(0u, 0u), entries[0].minTexCoords);
+            ASSERT_EQ(slotCorner(15u, 7u), entries[0].maxTexCoords);
+
+            ASSERT_EQ(0u, entries[1].page);
+            ASSERT_EQ(slotCorner(1024u, 0u), entries[1].minTexCoords);
+
+            ASSERT_EQ(0u, entries[2].page);
+            ASSERT_EQ(slotCorner(0u, 1024u), entries[2].minTexCoords);
+
+            ASSERT_EQ(0u, entries[3].page);
+            ASSERT_EQ(slotCorner(1024u, 1024u), entries[3].minTexCoords);
+
+            ASSERT_EQ(1u, entries[4].page);
+            ASSERT_EQ(slotCorner(0u, 0u), entries[4].minTexCoords);
+
+            // the entry of a texture does not change once it is contained
+            const auto entry = atlas.entry(textures[2]);
+            ASSERT_EQ(entries[2].page, entry->page);
+            ASSERT_EQ(entries[2].minTexCoords, entry->minTexCoords);
+        }
+
+        TEST_CASE("TextureAtlasTest.scaleTextures", "[TextureAtlasTest]") {
+            auto atlas = TextureAtlas(32u, 1u);
+            const auto textures = makeTextures(1u, 128u, 64u);
+
+            // the thumbnail is scaled down until it fits into a slot
+            const auto entry = atlas.entry(textures[0]);
+            ASSERT_TRUE(entry.has_value());
+            ASSERT_EQ(slotCorner(0u, 0u), entry->minTexCoords);
+            ASSERT_EQ(slotCorner(31u, 15u), entry->maxTexCoords);
+        }
+
+        TEST_CASE("TextureAtlasTest.evictLeastRecentlyUsed", "[TextureAtlasTest]") {
+            // four slots in total
+            auto atlas = TextureAtlas(TextureAtlas::PageSize / 2u, 1u);
+            const auto textures = makeTextures(6u, 16u, 16u);
+
+            for (size_t i = 0u; i < 4u; ++i) {
+                ASSERT_TRUE(atlas.entry(textures[i]).has_value());
+            }
+
+            // slots that were used in the current frame are not reused
+            ASSERT_FALSE(atlas.entry(textures[4]).has_value());
+            ASSERT_FALSE(atlas.contains(textures[4]));
+
+            atlas.beginFrame();
+            const auto firstEntry = atlas.entry(textures[0]);
+            for (size_t i = 2u; i < 4u; ++i) {
+                ASSERT_TRUE(atlas.entry(textures[i]).has_value());
+            }
+
+            // the second texture was not used in this frame
+            const auto entry = atlas.entry(textures[4]);
+            ASSERT_TRUE(entry.has_value());
+            ASSERT_EQ(slotCorner(1024u, 0u), entry->minTexCoords);
+            ASSERT_FALSE(atlas.contains(textures[1]));
+            ASSERT_TRUE(atlas.contains(textures[4]));
+
+            ASSERT_FALSE(atlas.entry(textures[5]).has_value());
+
+            // the least recently used slot is reused first
+            atlas.beginFrame();
+            for (size_t i = 2u; i < 5u; ++i) {
+                ASSERT_TRUE(atlas.entry(textures[i]).has_value());
+            }
+            ASSERT_TRUE(atlas.entry(textures[5]).has_value());
+            ASSERT_FALSE(atlas.contains(textures[0]));
+            ASSERT_EQ(firstEntry->minTexCoords, atlas.entry(textures[5])->minTexCoords);
+        }
+
+        TEST_CASE("TextureAtlasTest.textureWithoutThumbnail", "[TextureAtlasTest]") {
+            auto atlas = TextureAtlas(TextureAtlas::PageSize / 2u, 1u);
+            const auto texture = Assets::Texture("texture", 16u, 16u);
+
+            ASSERT_FALSE(atlas.entry(texture).has_value());
+            ASSERT_FALSE(atlas.contains(texture));
+        }
+
+        TEST_CASE("TextureAtlasTest.clear", "[TextureAtlasTest]") {
+            auto atlas = TextureAtlas(TextureAtlas::PageSize / 2u, 1u);
+            const auto textures = makeTextures(1u, 16u, 16u);
+            ASSERT_TRUE(atlas.entry(textures[0]).has_value());
+
+            atlas.clear();
+            ASSERT_FALSE(atlas.contains(textures[0]));
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "TriangleBVH.h"
+
+#include <vecmath/vec.h>
+#include <vecmath/ray.h>
+#include <vecmath/intersection.h>
+#include <vecmath/scalar.h>
+
+#include <random>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    TEST_CASE("TriangleBVHTest.emptyHierarchy", "[TriangleBVHTest]") {
+        const auto bvh = TriangleBVH(std::vector<vm::vec3f>());
+
+        ASSERT_TRUE(bvh.empty());
+        ASSERT_EQ(0u, bvh.triangleCount());
+        ASSERT_TRUE(vm::is_nan(bvh.intersect(vm::ray3f(vm::vec3f(0.0f, 0.0f, 0.0f), vm::vec3f(0.0f, 0.0f, 1.0f)))));
+    }
+
+    TEST_CASE("TriangleBVHTest.intersectSingleTriangle", "[TriangleBVHTest]") {
+        const auto bvh = TriangleBVH(std::vector<vm::vec3f>{
+            vm::vec3f(0.0f, 0.0f, 0.0f),
+            vm::vec3f(1.0f, 0.0f, 0.0f),
+            vm::vec3f(0.0f, 1.0f, 0.0f)
+        });
+
+        ASSERT_FALSE(bvh.empty());
+        ASSERT_EQ(1u, bvh.triangleCount());
+
+        // both sides of the triangle are hit
+        EXPECT_FLOAT_EQ(2.0f, bvh.intersect(vm::ray3f(vm::vec3f(0.25f, 0.25f, 2.0f), vm::vec3f(0.0f, 0.0f, -1.0f))));
+        EXPECT_FLOAT_EQ(3.0f, bvh.intersect(vm::ray3f(vm::vec3f(0.25f, 0.25f, -3.0f), vm::vec3f(0.0f, 0.0f, 1.0f))));
+
+        EXPECT_TRUE(vm::is_nan(bvh.intersect(vm::ray3f(vm::vec3f(0.75f, 0.75f, 2.0f), vm::vec3f(0.0f, 0.0f, -1.0f)))));
+        EXPECT_TRUE(vm::is_nan(bvh.intersect(vm::ray3f(vm::vec3f(0.25f, 0.25f, 2.0f), vm::vec3f(0.0f, 0.0f, 1.0f)))));
+        EXPECT_TRUE(vm::is_nan(bvh.intersect(vm::ray3f(vm::vec3f(0.25f, 0.25f, 2.0f), vm::vec3f(1.0f, 0.0f, 0.0f)))));
+    }
+
+    TEST_CASE("TriangleBVHTest.intersectReturnsClosestTriangle", "[TriangleBVHTest]") {
+        auto points = std::vector<vm::vec3f>();
+        for (size_t i = 0; i < 10; ++i) {
+            const auto z = static_cast<float>(i);
+            points.emplace_back(-1.0f, -1.0f, z);
+            points.emplace_back( 1.0f, -1.0f, z);
+            points.emplace_back( 0.0f,  1.0f, z);
+        }
+
+        const auto bvh = TriangleBVH(points);
+        EXPECT_FLOAT_EQ(1.0f, bvh.intersect(vm::ray3f(vm::vec3f(0.0f, 0.0f, -1.0f), vm::vec3f(0.0f, 0.0f, 1.0f))));
+        EXPECT_FLOAT_EQ(1.5f, bvh.intersect(vm::ray3f(vm::vec3f(0.0f, 0.0f, 10.5f), vm::vec3f(0.0f, 0.0f, -1.0f))));
+        EXPECT_FLOAT_EQ(0.5f, bvh.intersect(vm::ray3f(vm::vec3f(0.0f, 0.0f, 4.5f), vm::vec3f(0.0f, 0.0f, 1.0f))));
+    }
+
+    TEST_CASE("TriangleBVHTest.intersectMatchesBruteForce", "[TriangleBVHTest]") {
+        std::mt19937 randEngine;
+        std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> offset(-10.0f, 10.0f);
+
+        auto points = std::vector<vm::vec3f>();
+        for (size_t i = 0; i < 1000; ++i) {
+            const auto p = vm::vec3f(position(randEngine), position(randEngine), position(randEngine));
+            points.push_back(p);
+            points.push_back(p + vm::vec3f(offset(randEngine), offset(randEngine), offset(randEngine)));
+            points.push_back(p + vm::vec3f(offset(randEngine), offset(randEngine), offset(randEngine)));
+        }
+
+        const auto bvh = TriangleBVH(points);
+        ASSERT_EQ(1000u, bvh.triangleCount());
+
+        auto hits = size_t(0);
+        for (size_t i = 0; i < 1000; ++i) {
+            // aim at the center of a triangle so that most rays hit something
+            const auto target = (points[3u * i] + points[3u * i + 1u] + points[3u * i + 2u]) / 3.0f;
+            const auto origin = vm::vec3f(position(randEngine), position(randEngine), position(randEngine));
+            const auto ray = vm::ray3f(origin, vm::normalize(target - origin));
+
+            auto expected = vm::nan<float>();
+            for (size_t j = 0; j < points.size(); j += 3u) {
+                expected = vm::safe_min(expected, vm::intersect_ray_triangle(ray, points[j], points[j + 1u], points[j + 2u]));
+            }
+
+            const auto actual = bvh.intersect(ray);
+            if (vm::is_nan(expected)) {
+                EXPECT_TRUE(vm::is_nan(actual));
+            } else {
+                EXPECT_FLOAT_EQ(expected, actual);
+                ++hits;
+            }
+        }
+
+        EXPECT_GT(hits, 0u);
+    }
+}
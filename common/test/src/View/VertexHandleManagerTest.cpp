@@ -0,0 +1,215 @@
+/*
+ Copyright (C) 2010-2017 Kristian Duske
+
+ This file is part of TrenchBroom.
+
+ TrenchBroom is free software: you can redistribute it and/or modify
+ it under the terms of the GNU General Public License as published by
+ the Free Software Foundation, either version 3 of the License, or
+ (at your option) any later version.
+
+ TrenchBroom is distributed in the hope that it will be useful,
+ but WITHOUT ANY WARRANTY; without even the implied warranty of
+ MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ GNU General Public License for more details.
+
+ You should have received a copy of the GNU General Public License
+ along with TrenchBroom. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FloatType.h"
+#include "PreferenceManager.h"
+#include "Preferences.h"
+#include "Model/Hit.h"
+#include "Model/PickResult.h"
+#include "Renderer/Camera.h"
+#include "Renderer/OrthographicCamera.h"
+#include "Renderer/PerspectiveCamera.h"
+#include "View/Grid.h"
+#include "View/VertexHandleManager.h"
+
+#include <vecmath/polygon.h>
+#include <vecmath/ray.h>
+#include <vecmath/scalar.h>
+#include <vecmath/vec.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "Catch2.h"
+#include "GTestCompat.h"
+
+namespace TrenchBroom {
+    namespace View {
+        static std::vector<vm::vec3> pickVertexHandles(const VertexHandleManager& manager, const vm::ray3& pickRay, const Renderer::Camera& camera) {
+            Model::PickResult pickResult;
+            manager.pick(pickRay, camera, pickResult);
+
+            std::vector<vm::vec3> result;
+            for (const auto& hit : pickResult.all()) {
+                result.push_back(hit.target<vm::vec3>());
+            }
+            std::sort(std::begin(result), std::end(result));
+            return result;
+        }
+
+        static std::vector<vm::vec3> pickVertexHandlesExhaustively(const VertexHandleManager& manager, const vm::ray3& pickRay, const Renderer::Camera& camera) {
+            const auto handleRadius = static_cast<FloatType>(pref(Preferences::HandleRadius));
+
+            std::vector<vm::vec3> result;
+            for (const auto& handle : manager.allHandles()) {
+                if (!vm::is_nan(camera.pickPointHandle(pickRay, handle, handleRadius))) {
+                    result.push_back(handle);
+                }
+            }
+            std::sort(std::begin(result), std::end(result));
+            return result;
+        }
+
+        TEST_CASE("VertexHandleManagerTest.addAndRemoveHandles", "[VertexHandleManagerTest]") {
+            VertexHandleManager manager;
+
+            const auto h1 = vm::vec3(0.0, 0.0, 0.0);
+            const auto h2 = vm::vec3(63.0, 0.0, 0.0);
+            const auto h3 = vm::vec3(64.0, 0.0, 0.0);
+            const auto h4 = vm::vec3(-1000.0, 2000.0, -3000.0);
+
+            manager.add(h1);
+            manager.add(h2);
+            manager.add(h3);
+            manager.add(h4);
+            manager.add(h4);
+            ASSERT_EQ(4u, manager.totalHandleCount());
+            ASSERT_TRUE(manager.contains(h3));
+
+            // a handle that was added twice must be removed twice
+            ASSERT_TRUE(manager.remove(h4));
+            ASSERT_TRUE(manager.contains(h4));
+            ASSERT_TRUE(manager.remove(h4));
+            ASSERT_FALSE(manager.contains(h4));
+            ASSERT_FALSE(manager.remove(h4));
+
+            ASSERT_TRUE(manager.remove(h2));
+            ASSERT_EQ(2u, manager.totalHandleCount());
+
+            const auto camera = Renderer::PerspectiveCamera(90.0f, 1.0f, 8000.0f, Renderer::Camera::Viewport(0, 0, 1024, 768), vm::vec3f(0.0f, 0.0f, 256.0f), vm::vec3f::neg_z(), vm::vec3f::pos_y());
+            ASSERT_EQ(std::vector<vm::vec3>{ h1 }, pickVertexHandles(manager, vm::ray3(vm::vec3(0.0, 0.0, 256.0), vm::vec3::neg_z()), camera));
+            ASSERT_TRUE(pickVertexHandles(manager, vm::ray3(vm::vec3(63.0, 0.0, 256.0), vm::vec3::neg_z()), camera).empty());
+
+            manager.clear();
+            ASSERT_EQ(0u, manager.totalHandleCount());
+            ASSERT_TRUE(pickVertexHandles(manager, vm::ray3(vm::vec3(0.0, 0.0, 256.0), vm::vec3::neg_z()), camera).empty());
+        }
+
+        TEST_CASE("VertexHandleManagerTest.moveHandle", "[VertexHandleManagerTest]") {
+            VertexHandleManager manager;
+
+            const auto oldPosition = vm::vec3(32.0, 32.0, 0.0);
+            const auto newPosition = vm::vec3(544.0, 32.0, 0.0);
+            manager.add(oldPosition);
+            manager.select(oldPosition);
+
+            // handles are moved by removing them at their old position and adding them at their new position
+            ASSERT_TRUE(manager.remove(oldPosition));
+            manager.add(newPosition);
+            ASSERT_EQ(0u, manager.selectedHandleCount());
+
+            const auto camera = Renderer::PerspectiveCamera(90.0f, 1.0f, 8000.0f, Renderer::Camera::Viewport(0, 0, 1024, 768), vm::vec3f(0.0f, 0.0f, 256.0f), vm::vec3f::neg_z(), vm::vec3f::pos_y());
+            ASSERT_TRUE(pickVertexHandles(manager, vm::ray3(vm::vec3(32.0, 32.0, 256.0), vm::vec3::neg_z()), camera).empty());
+            ASSERT_EQ(std::vector<vm::vec3>{ newPosition }, pickVertexHandles(manager, vm::ray3(vm::vec3(544.0, 32.0, 256.0), vm::vec3::neg_z()), camera));
+
+            manager.select(newPosition);
+            ASSERT_TRUE(manager.selected(newPosition));
+        }
+
+        TEST_CASE("VertexHandleManagerTest.selectCloseHandles", "[VertexHandleManagerTest]") {
+            VertexHandleManager manager;
+
+            // the handles lie in different grid cells, but are considered equal when selecting handles
+            const auto handle = vm::vec3(64.0, -64.0, 128.0);
+            const auto closeHandle = vm::vec3(64.0 - 0.0000001, -64.0 - 0.0000001, 128.0 - 0.0000001);
+            const auto otherHandle = vm::vec3(64.0, -64.0, 128.1);
+            manager.add(handle);
+            manager.add(otherHandle);
+
+            manager.select(closeHandle);
+            ASSERT_TRUE(manager.selected(handle));
+            ASSERT_FALSE(manager.selected(otherHandle));
+            ASSERT_EQ(1u, manager.selectedHandleCount());
+
+            manager.deselect(closeHandle);
+            ASSERT_FALSE(manager.selected(handle));
+            ASSERT_EQ(0u, manager.selectedHandleCount());
+        }
+
+        TEST_CASE("VertexHandleManagerTest.pickMatchesExhaustivePick", "[VertexHandleManagerTest]") {
+            std::mt19937 randEngine;
+            std::uniform_real_distribution<FloatType> position(-2048.0, 2048.0);
+
+            // enough handles that the pick ray is followed through the grid
+            VertexHandleManager manager;
+            for (size_t i = 0u; i < 20000u; ++i) {
+                manager.add(vm::vec3(position(randEngine), position(randEngine), position(randEngine)));
+            }
+            const auto handles = manager.allHandles();
+
+            const auto viewport = Renderer::Camera::Viewport(0, 0, 1024, 768);
+            const auto cameraPosition = vm::vec3f(-2500.0f, -2500.0f, 2500.0f);
+            const auto cameraDirection = vm::normalize(vm::vec3f(1.0f, 1.0f, -1.0f));
+            const auto cameraUp = vm::normalize(vm::cross(vm::cross(cameraDirection, vm::vec3f::pos_z()), cameraDirection));
+
+            const auto perspectiveCamera = Renderer::PerspectiveCamera(90.0f, 1.0f, 8000.0f, viewport, cameraPosition, cameraDirection, cameraUp);
+            const auto orthographicCamera = Renderer::OrthographicCamera(1.0f, 8000.0f, viewport, cameraPosition, cameraDirection, cameraUp);
+
+            for (const Renderer::Camera* camera : { static_cast<const Renderer::Camera*>(&perspectiveCamera), static_cast<const Renderer::Camera*>(&orthographicCamera) }) {
+                auto hits = size_t(0);
+                for (size_t i = 0u; i < 200u; ++i) {
+                    // aim close to a handle so that most rays hit something
+                    const auto& target = handles[i * handles.size() / 200u];
+                    const auto screenPoint = camera->project(vm::vec3f(target));
+                    const auto pickRay = vm::ray3(camera->pickRay(camera->unproject(screenPoint.x() + 1.0f, screenPoint.y(), 0.5f)));
+
+                    const auto expected = pickVertexHandlesExhaustively(manager, pickRay, *camera);
+                    ASSERT_EQ(expected, pickVertexHandles(manager, pickRay, *camera));
+                    hits += expected.size();
+                }
+                ASSERT_TRUE(hits > 0u);
+            }
+        }
+
+        TEST_CASE("VertexHandleManagerTest.pickFaceGridHandle", "[VertexHandleManagerTest]") {
+            FaceHandleManager manager;
+
+            // a large face whose center is far from the pick ray
+            const auto face = vm::polygon3(std::vector<vm::vec3>{
+                vm::vec3(-512.0, -512.0, 0.0),
+                vm::vec3(-512.0,  512.0, 0.0),
+                vm::vec3( 512.0,  512.0, 0.0),
+                vm::vec3( 512.0, -512.0, 0.0)
+            });
+            manager.add(face);
+
+            for (size_t i = 0u; i < 100u; ++i) {
+                const auto x = static_cast<FloatType>(i) * 64.0 + 2048.0;
+                manager.add(vm::polygon3(std::vector<vm::vec3>{
+                    vm::vec3(x,       0.0, 0.0),
+                    vm::vec3(x,      16.0, 0.0),
+                    vm::vec3(x + 16.0, 16.0, 0.0)
+                }));
+            }
+
+            const auto grid = Grid(4);
+            const auto camera = Renderer::PerspectiveCamera(90.0f, 1.0f, 8000.0f, Renderer::Camera::Viewport(0, 0, 1024, 768), vm::vec3f(400.0f, 400.0f, 256.0f), vm::vec3f::neg_z(), vm::vec3f::pos_y());
+
+            Model::PickResult pickResult;
+            manager.pickGridHandle(vm::ray3(vm::vec3(400.0, 400.0, 256.0), vm::vec3::neg_z()), camera, grid, pickResult);
+            ASSERT_EQ(1u, pickResult.size());
+
+            const auto [hitFace, hitPoint] = pickResult.all().front().target<FaceHandleManager::HitType>();
+            ASSERT_EQ(face, hitFace);
+            ASSERT_EQ(vm::vec3(400.0, 400.0, 0.0), hitPoint);
+        }
+    }
+}
@@ -0,0 +1,230 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef KDL_PARALLEL_H
+#define KDL_PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace kdl {
+    /**
+     * Returns the number of threads that can run concurrently on this machine, but at least 1.
+     */
+    inline std::size_t hardware_thread_count() {
+        return std::max(static_cast<std::size_t>(std::thread::hardware_concurrency()), std::size_t(1));
+    }
+
+    /**
+     * A fixed number of worker threads that run posted tasks in the order in which they were posted. The threads are
+     * started when the pool is created and run until it is destroyed, so posting a task never creates a thread.
+     */
+    class thread_pool {
+    private:
+        std::vector<std::thread> m_threads;
+        std::deque<std::function<void()>> m_tasks;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        bool m_stopped;
+    public:
+        /**
+         * Creates a pool with the given number of worker threads.
+         */
+        explicit thread_pool(const std::size_t thread_count) :
+        m_stopped(false) {
+            m_threads.reserve(thread_count);
+            for (std::size_t i = 0u; i < thread_count; ++i) {
+                m_threads.emplace_back([this]() { run(); });
+            }
+        }
+
+        /**
+         * Waits for all posted tasks to finish and stops the worker threads.
+         */
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_stopped = true;
+            }
+            m_condition.notify_all();
+            for (auto& thread : m_threads) {
+                thread.join();
+            }
+        }
+
+        thread_pool(const thread_pool&) = delete;
+        thread_pool& operator=(const thread_pool&) = delete;
+
+        std::size_t thread_count() const {
+            return m_threads.size();
+        }
+
+        /**
+         * Posts the given task to be run by one of the worker threads. The task must not throw.
+         */
+        void post(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_tasks.push_back(std::move(task));
+            }
+            m_condition.notify_one();
+        }
+    private:
+        void run() {
+            while (true) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(m_mutex);
+                    m_condition.wait(lock, [this]() { return m_stopped || !m_tasks.empty(); });
+                    if (m_tasks.empty()) {
+                        return;
+                    }
+                    task = std::move(m_tasks.front());
+                    m_tasks.pop_front();
+                }
+                task();
+            }
+        }
+    };
+
+    /**
+     * Returns the pool used by parallel_for. It is created on first use and has one thread less than the hardware
+     * supports, since the thread that calls parallel_for takes part in the work.
+     */
+    inline thread_pool& default_thread_pool() {
+        static thread_pool pool(hardware_thread_count() - 1u);
+        return pool;
+    }
+
+    /**
+     * Calls the given function for every index in [0, count), distributing the calls over up to the given number of
+     * threads. The calling thread is one of these threads, the others are taken from the default thread pool. Indices
+     * are handed out in increasing order, but calls for different indices may run concurrently and finish in any order.
+     *
+     * The calling thread processes indices until none are left, so the pool only speeds up the work and nested calls
+     * cannot deadlock even if all pool threads are busy.
+     *
+     * Blocks until all calls have returned. If any call throws an exception, the remaining indices are still processed
+     * and one of the thrown exceptions is rethrown once all calls have finished.
+     *
+     * @tparam F the type of the function to call, must be callable with a std::size_t
+     * @param count the number of indices
+     * @param f the function to call
+     * @param threadCount the maximum number of threads to use
+     */
+    template <typename F>
+    void parallel_for(const std::size_t count, F&& f, const std::size_t threadCount = hardware_thread_count()) {
+        auto& pool = default_thread_pool();
+        const auto helperCount = std::max(std::min({ threadCount, count, pool.thread_count() + 1u }), std::size_t(1)) - 1u;
+
+        // Helpers that start after all indices were handed out return without calling f, so only the shared state must
+        // outlive this call, but f and the local variables need not.
+        struct state {
+            std::atomic<std::size_t> next_index{0u};
+            std::size_t active_helpers{0u};
+            std::exception_ptr exception;
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+
+        auto shared_state = std::make_shared<state>();
+        const auto call = std::function<void(std::size_t)>(std::ref(f));
+
+        const auto work = [count](state& s, const std::function<void(std::size_t)>& g) {
+            for (auto i = s.next_index++; i < count; i = s.next_index++) {
+                try {
+                    g(i);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    if (!s.exception) {
+                        s.exception = std::current_exception();
+                    }
+                }
+            }
+        };
+
+        for (std::size_t i = 0u; i < helperCount; ++i) {
+            pool.post([shared_state, work, &call]() {
+                auto& s = *shared_state;
+                {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    ++s.active_helpers;
+                }
+                // if all indices are handed out already, call is never used, it may have been destroyed already
+                work(s, call);
+                {
+                    std::lock_guard<std::mutex> lock(s.mutex);
+                    --s.active_helpers;
+                }
+                s.done.notify_all();
+            });
+        }
+
+        work(*shared_state, call);
+
+        // all indices are handed out, wait for the helpers that are still calling f
+        std::unique_lock<std::mutex> lock(shared_state->mutex);
+        shared_state->done.wait(lock, [&]() { return shared_state->active_helpers == 0u; });
+
+        if (shared_state->exception) {
+            std::rethrow_exception(shared_state->exception);
+        }
+    }
+
+    /**
+     * Applies the given transformation to every element of the given vector and returns a vector containing the
+     * results in the order of the given elements. The transformation is applied concurrently on up to the given number
+     * of threads, so it must be safe to call it for different elements at the same time.
+     *
+     * @tparam T the type of the vector elements
+     * @tparam A the vector's allocator type
+     * @tparam L the type of the transformation, must be callable with a const T&
+     * @param v the vector
+     * @param transform the transformation
+     * @param threadCount the maximum number of threads to use
+     * @return a vector containing the transformed elements
+     */
+    template <typename T, typename A, typename L>
+    auto vec_parallel_transform(const std::vector<T, A>& v, L&& transform, const std::size_t threadCount = hardware_thread_count()) {
+        using ResultType = std::decay_t<std::invoke_result_t<L, const T&>>;
+
+        std::vector<std::optional<ResultType>> transformed(v.size());
+        parallel_for(v.size(), [&](const std::size_t i) {
+            transformed[i] = transform(v[i]);
+        }, threadCount);
+
+        std::vector<ResultType> result;
+        result.reserve(transformed.size());
+        for (auto& element : transformed) {
+            result.push_back(std::move(*element));
+        }
+        return result;
+    }
+}
+
+#endif //KDL_PARALLEL_H
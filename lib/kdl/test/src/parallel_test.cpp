@@ -0,0 +1,117 @@
+/*
+ Copyright 2010-2019 Kristian Duske
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ documentation files (the "Software"), to deal in the Software without restriction, including without limitation the
+ rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software, and to permit
+ persons to whom the Software is furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in all copies or substantial portions of the
+ Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+ WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+ COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <catch2/catch.hpp>
+
+#include "GTestCompat.h"
+
+#include "kdl/parallel.h"
+
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace kdl {
+    TEST_CASE("parallel_test.parallel_for", "[parallel_test]") {
+        for (const std::size_t threadCount : { 1u, 2u, 8u }) {
+            std::vector<std::atomic<int>> calls(100u);
+            parallel_for(calls.size(), [&](const std::size_t i) {
+                ++calls[i];
+            }, threadCount);
+
+            for (const auto& count : calls) {
+                ASSERT_EQ(1, count.load());
+            }
+        }
+
+        std::atomic<int> calls(0);
+        parallel_for(0u, [&](const std::size_t) { ++calls; });
+        ASSERT_EQ(0, calls.load());
+    }
+
+    TEST_CASE("parallel_test.parallel_for_exception", "[parallel_test]") {
+        std::atomic<int> calls(0);
+        ASSERT_THROW(parallel_for(100u, [&](const std::size_t i) {
+            ++calls;
+            if (i == 50u) {
+                throw std::runtime_error("error");
+            }
+        }, 4u), std::runtime_error);
+
+        // all other indices are still processed
+        ASSERT_EQ(100, calls.load());
+    }
+
+    TEST_CASE("parallel_test.parallel_for_reuses_threads", "[parallel_test]") {
+        std::mutex mutex;
+        std::set<std::thread::id> threadIds;
+        for (std::size_t i = 0u; i < 100u; ++i) {
+            parallel_for(16u, [&](const std::size_t) {
+                std::lock_guard<std::mutex> lock(mutex);
+                threadIds.insert(std::this_thread::get_id());
+            });
+        }
+
+        // the calling thread and the threads of the default pool, no new threads are created per call
+        ASSERT_TRUE(threadIds.size() <= default_thread_pool().thread_count() + 1u);
+    }
+
+    TEST_CASE("parallel_test.parallel_for_nested", "[parallel_test]") {
+        std::vector<std::atomic<int>> calls(32u * 32u);
+        parallel_for(32u, [&](const std::size_t i) {
+            parallel_for(32u, [&](const std::size_t j) {
+                ++calls[i * 32u + j];
+            });
+        });
+
+        for (const auto& count : calls) {
+            ASSERT_EQ(1, count.load());
+        }
+    }
+
+    TEST_CASE("parallel_test.thread_pool", "[parallel_test]") {
+        std::atomic<int> calls(0);
+        {
+            thread_pool pool(4u);
+            ASSERT_EQ(4u, pool.thread_count());
+            for (int i = 0; i < 100; ++i) {
+                pool.post([&]() { ++calls; });
+            }
+        }
+
+        // the pool runs all posted tasks before it is destroyed
+        ASSERT_EQ(100, calls.load());
+    }
+
+    TEST_CASE("parallel_test.vec_parallel_transform", "[parallel_test]") {
+        ASSERT_EQ(std::vector<std::string>({}), vec_parallel_transform(std::vector<int>({}), [](const int i) { return std::to_string(i); }));
+
+        std::vector<int> v;
+        std::vector<std::string> expected;
+        for (int i = 0; i < 1000; ++i) {
+            v.push_back(i);
+            expected.push_back(std::to_string(i * 2));
+        }
+
+        ASSERT_EQ(expected, vec_parallel_transform(v, [](const int i) { return std::to_string(i * 2); }));
+        ASSERT_EQ(expected, vec_parallel_transform(v, [](const int i) { return std::to_string(i * 2); }, 1u));
+    }
+}